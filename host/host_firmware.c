@@ -0,0 +1,809 @@
+/******************************************************************************
+* File Name: host_firmware.c
+*
+* Description: This file contains the host stand-in for the CapSense
+*              middleware, which fills the CapSense data structure with
+*              simulated scan results, and the main loop of main.c that runs
+*              the firmware modules on the host.
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <string.h>
+#include "host_firmware.h"
+#include "host_stack.h"
+#include "cycfg_capsense.h"
+#include "tuner_ble_server.h"
+#include "tuner_transport.h"
+#include "tuner_touch_events.h"
+#include "tuner_sample_log.h"
+#include "tuner_summary.h"
+#include "tuner_snr.h"
+#include "tuner_profiler.h"
+#include "tuner_time.h"
+
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Sensors of the two buttons; the slider takes the rest */
+#define BUTTON_SENSORS               (2u)
+#define SLIDER_SENSORS               (CY_CAPSENSE_SENSOR_COUNT - (2u * BUTTON_SENSORS))
+
+/* Simulated scan results */
+#define RAW_COUNT_BASE               (1000u)
+#define RAW_COUNT_STEP               (37u)
+#define TOUCH_SIGNAL                 (300u)
+#define NOISE_DEFAULT                (8u)
+#define BASELINE_SHIFT               (2u)
+#define SLIDER_RESOLUTION            (100u)
+#define WIDGET_STATUS_ACTIVE         (0x01u)
+#define SENSOR_STATUS_ACTIVE         (0x01u)
+
+/* Tuning of the widgets at start-up */
+#define INIT_RESOLUTION              (12u)
+#define INIT_MAX_RAW_COUNT           (4095u)
+#define INIT_FINGER_TH               (100u)
+#define INIT_NOISE_TH                (40u)
+#define INIT_HYSTERESIS              (10u)
+#define INIT_ON_DEBOUNCE             (3u)
+#define INIT_LOW_BSLN_RST            (30u)
+#define INIT_SNS_CLK                 (16u)
+#define INIT_IDAC_MOD                (32u)
+#define INIT_IDAC_GAIN               (4u)
+#define INIT_IDAC_COMP               (20u)
+#define INIT_MOD_CLK                 (2u)
+#define INIT_CONFIG_ID               (0x1234u)
+
+/* SmartSense stand-in: when a touch ends, the finger threshold is set to
+ * 3/4 of its peak signal, the noise thresholds to half and the hysteresis
+ * to 1/8 of the finger threshold. Every 64 scans the widgets are
+ * calibrated again, which picks new sense clocks and IDACs */
+#define AUTO_TUNE_FINGER_TH_NUM      (3u)
+#define AUTO_TUNE_FINGER_TH_DEN      (4u)
+#define AUTO_TUNE_NOISE_TH_SHIFT     (1u)
+#define AUTO_TUNE_HYSTERESIS_SHIFT   (3u)
+#define AUTO_TUNE_CALIBRATION_SCANS  (64u)
+#define AUTO_TUNE_CALIBRATION_MASK   (0x03u)
+
+/* Parameters of the linear congruential noise generator */
+#define LCG_MULTIPLIER               (1664525u)
+#define LCG_INCREMENT                (1013904223u)
+#define LCG_SHIFT                    (16u)
+
+/* Longest sleep of Cy_CapSense_RunTuner() while the tuner is suspended */
+#define SUSPEND_POLL_US              (1000u)
+
+
+/*******************************************************************************
+ * Global variables
+ ******************************************************************************/
+/* CapSense data structure and context, as generated by the configurator */
+cy_stc_capsense_tuner_t cy_capsense_tuner;
+
+static const cy_stc_capsense_widget_config_t widget_config[CY_CAPSENSE_WIDGET_COUNT] =
+{
+    {
+        .ptrWdContext = &cy_capsense_tuner.widgetContext[CY_CAPSENSE_LINEARSLIDER0_WDGT_ID],
+        .ptrSnsContext = &cy_capsense_tuner.sensorContext[0],
+        .numSns = SLIDER_SENSORS,
+    },
+    {
+        .ptrWdContext = &cy_capsense_tuner.widgetContext[CY_CAPSENSE_BUTTON0_WDGT_ID],
+        .ptrSnsContext = &cy_capsense_tuner.sensorContext[SLIDER_SENSORS],
+        .numSns = BUTTON_SENSORS,
+    },
+    {
+        .ptrWdContext = &cy_capsense_tuner.widgetContext[CY_CAPSENSE_BUTTON1_WDGT_ID],
+        .ptrSnsContext = &cy_capsense_tuner.sensorContext[SLIDER_SENSORS + BUTTON_SENSORS],
+        .numSns = BUTTON_SENSORS,
+    },
+};
+
+static const cy_stc_capsense_common_config_t common_config =
+{
+    .numWd = CY_CAPSENSE_WIDGET_COUNT,
+    .numSns = CY_CAPSENSE_SENSOR_COUNT,
+};
+
+cy_stc_capsense_context_t cy_capsense_context =
+{
+    .ptrCommonConfig = &common_config,
+    .ptrCommonContext = &cy_capsense_tuner.commonContext,
+    .ptrWdConfig = widget_config,
+};
+
+/* Simulated touches and noise */
+static bool sensor_touched[CY_CAPSENSE_SENSOR_COUNT];
+static uint16_t noise_amplitude = NOISE_DEFAULT;
+static uint32_t lcg_state = 0;
+
+/* SmartSense stand-in and the peak signal of the touch of each widget */
+static bool auto_tune = false;
+static uint16_t touch_peak[CY_CAPSENSE_WIDGET_COUNT];
+
+/* Main loop state of main.c */
+static uint32_t scan_widget = 0;
+static uint32_t scan_remaining = 0;
+static uint32_t widget_scan_time = HOST_WIDGET_SCAN_US;
+static uint32_t scan_frames = 0;
+static host_firmware_hook_t tuner_hook = NULL;
+
+/* Cy_CapSense_InitializeWidgetBaseline() calls of each widget */
+static uint32_t baseline_inits[CY_CAPSENSE_WIDGET_COUNT];
+
+/* As in main.c: widgets whose baseline waits for their next scan */
+static bool widget_reinit[CY_CAPSENSE_WIDGET_COUNT];
+
+
+/*******************************************************************************
+ * Function Prototypes
+*******************************************************************************/
+static void main_loop_pass(void);
+static void capsense_scan_start(uint32_t widget);
+static void capsense_scan_complete(uint32_t widget);
+static void capsense_process_widget(uint32_t widget);
+static void capsense_auto_tune(uint32_t widget, uint16_t peak);
+static void capsense_calibrate(uint32_t widget);
+static void capsense_run_tuner(void);
+static void tuner_writes_apply(void);
+static void widget_baseline_reinit(uint32_t widget);
+static void touch_events_update(uint32_t widget);
+static int32_t noise_next(void);
+
+
+/*******************************************************************************
+* Function Name: host_firmware_init
+********************************************************************************
+*
+* Summary:
+*   Sets up the CapSense data structure as the middleware leaves it after
+*   Cy_CapSense_Enable(), brings the BLE stack up and starts the first scan,
+*   in the order of main().
+*
+* Parameters:
+*  uint32_t seed : Seed of the simulated noise; the same seed gives the same
+*                  run
+*
+*******************************************************************************/
+void host_firmware_init(uint32_t seed)
+{
+    cy_stc_capsense_widget_context_t *wd = NULL;
+
+    memset(&cy_capsense_tuner, 0, sizeof(cy_capsense_tuner));
+    lcg_state = seed;
+
+    cy_capsense_tuner.commonContext.configId = INIT_CONFIG_ID;
+    cy_capsense_tuner.commonContext.initDone = 1u;
+    cy_capsense_tuner.commonContext.modCsdClk = INIT_MOD_CLK;
+    cy_capsense_tuner.commonContext.modCsxClk = INIT_MOD_CLK;
+
+    for(uint32_t widget = 0; widget < CY_CAPSENSE_WIDGET_COUNT; widget++)
+    {
+        wd = &cy_capsense_tuner.widgetContext[widget];
+        wd->resolution = INIT_RESOLUTION;
+        wd->maxRawCount = INIT_MAX_RAW_COUNT;
+        wd->fingerTh = INIT_FINGER_TH;
+        wd->noiseTh = INIT_NOISE_TH;
+        wd->nNoiseTh = INIT_NOISE_TH;
+        wd->hysteresis = INIT_HYSTERESIS;
+        wd->onDebounce = INIT_ON_DEBOUNCE;
+        wd->lowBslnRst = INIT_LOW_BSLN_RST;
+        wd->snsClk = INIT_SNS_CLK;
+        wd->idacMod[0] = INIT_IDAC_MOD;
+        wd->idacGainIndex = INIT_IDAC_GAIN;
+        wd->bslnCoeff = 1u;
+    }
+    cy_capsense_tuner.widgetContext[CY_CAPSENSE_LINEARSLIDER0_WDGT_ID].wdTouch.ptrPosition =\
+            cy_capsense_tuner.position_LinearSlider0;
+
+    for(uint32_t sensor = 0; sensor < CY_CAPSENSE_SENSOR_COUNT; sensor++)
+    {
+        cy_capsense_tuner.sensorContext[sensor].idacComp = (uint8_t)(INIT_IDAC_COMP + sensor);
+        cy_capsense_tuner.sensorContext[sensor].raw =\
+                (uint16_t)(RAW_COUNT_BASE + (RAW_COUNT_STEP * sensor));
+        cy_capsense_tuner.sensorContext[sensor].bsln = cy_capsense_tuner.sensorContext[sensor].raw;
+    }
+
+    tuner_time_init();
+
+    /* Register tuner communication callback */
+    cy_capsense_context.ptrCommonContext->ptrTunerSendCallback = tuner_send_callback;
+
+    ble_capsense_tuner_init();
+    profiler_init();
+
+    capsense_scan_start(0u);
+}
+
+
+/*******************************************************************************
+* Function Name: host_firmware_run
+********************************************************************************
+*
+* Summary:
+*   Runs the main loop until the given number of complete scans of all
+*   widgets is done.
+*
+*******************************************************************************/
+void host_firmware_run(uint32_t scans)
+{
+    uint32_t target = scan_frames + scans;
+
+    while(scan_frames != target)
+    {
+        main_loop_pass();
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: host_firmware_run_until
+********************************************************************************
+*
+* Summary:
+*   Runs the main loop until the simulated time reaches time_us.
+*
+*******************************************************************************/
+void host_firmware_run_until(uint32_t time_us)
+{
+    while((int32_t)(time_us - host_stack_time()) > 0)
+    {
+        main_loop_pass();
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: main_loop_pass
+********************************************************************************
+*
+* Summary:
+*   One pass of the main loop of main.c; the sleep at its end lasts until
+*   the scan is complete or the BLE stack wakes the CPU.
+*
+*******************************************************************************/
+static void main_loop_pass(void)
+{
+    uint32_t done_widget = 0;
+
+    /* Process the BLE stack events and send pending tuner packets */
+    ble_process_events();
+
+    if(scan_remaining == 0u)
+    {
+        done_widget = scan_widget;
+        scan_widget++;
+
+        capsense_scan_complete(done_widget);
+
+        if(scan_widget < CY_CAPSENSE_WIDGET_COUNT)
+        {
+            capsense_scan_start(scan_widget);
+            widget_baseline_reinit(done_widget);
+            capsense_process_widget(done_widget);
+            touch_events_update(done_widget);
+        }
+        else
+        {
+            /* Last widget of the frame; the first widget is scanned only
+             * once the frame is handed over, as in main.c. The model
+             * writes the raw counts at the end of a scan and the tail
+             * takes no time, so it cannot show the overlap */
+            widget_baseline_reinit(done_widget);
+            capsense_process_widget(done_widget);
+            touch_events_update(done_widget);
+
+            tuner_sample_log_record();
+
+            /* The summary is only streamed; skip it without a client */
+            if(tuner_transport_client_connected() == true)
+            {
+                tuner_summary_update();
+            }
+            else
+            {
+                tuner_summary_restart();
+            }
+
+            tuner_snr_update();
+
+            capsense_run_tuner();
+            if(tuner_hook != NULL)
+            {
+                tuner_hook();
+            }
+
+            tuner_writes_apply();
+
+            scan_widget = 0;
+            capsense_scan_start(scan_widget);
+            scan_frames++;
+        }
+    }
+
+    profiler_update();
+
+    /* Sleep until the scan completes or the BLE stack has work */
+    scan_remaining -= host_stack_advance(scan_remaining);
+}
+
+
+/*******************************************************************************
+* Function Name: host_firmware_set_scan_time
+********************************************************************************
+*
+* Summary:
+*   Sets the scan time of one widget from the next scan on.
+*
+*******************************************************************************/
+void host_firmware_set_scan_time(uint32_t widget_scan_us)
+{
+    widget_scan_time = widget_scan_us;
+}
+
+
+/*******************************************************************************
+* Function Name: host_firmware_set_noise
+********************************************************************************
+*
+* Summary:
+*   Sets the peak noise added to the raw counts; 0 leaves the raw counts
+*   steady.
+*
+*******************************************************************************/
+void host_firmware_set_noise(uint16_t amplitude)
+{
+    noise_amplitude = amplitude;
+}
+
+
+/*******************************************************************************
+* Function Name: host_firmware_set_auto_tune
+********************************************************************************
+*
+* Summary:
+*   Lets the middleware stand-in tune the thresholds and calibrate the
+*   widgets by itself, as SmartSense does, without any tuner write.
+*
+*******************************************************************************/
+void host_firmware_set_auto_tune(bool enable)
+{
+    auto_tune = enable;
+}
+
+
+/*******************************************************************************
+* Function Name: host_firmware_set_hook
+********************************************************************************
+*
+* Summary:
+*   Sets the function called after each Cy_CapSense_RunTuner().
+*
+*******************************************************************************/
+void host_firmware_set_hook(host_firmware_hook_t hook)
+{
+    tuner_hook = hook;
+}
+
+
+/*******************************************************************************
+* Function Name: host_firmware_touch
+********************************************************************************
+*
+* Summary:
+*   Puts a finger on a sensor or takes it away.
+*
+*******************************************************************************/
+void host_firmware_touch(uint32_t sensor, bool touched)
+{
+    sensor_touched[sensor] = touched;
+}
+
+
+/*******************************************************************************
+* Function Name: host_firmware_scans
+********************************************************************************
+*
+* Summary:
+*   Returns the number of complete scans of all widgets.
+*
+*******************************************************************************/
+uint32_t host_firmware_scans(void)
+{
+    return scan_frames;
+}
+
+
+/*******************************************************************************
+* Function Name: host_firmware_baseline_inits
+********************************************************************************
+*
+* Summary:
+*   Returns how often the baseline of a widget was initialized.
+*
+*******************************************************************************/
+uint32_t host_firmware_baseline_inits(uint32_t widget)
+{
+    return baseline_inits[widget];
+}
+
+
+/*******************************************************************************
+* Function Name: capsense_scan_start
+********************************************************************************
+*
+* Summary:
+*   Stands in for Cy_CapSense_SetupWidget() and Cy_CapSense_Scan().
+*
+*******************************************************************************/
+static void capsense_scan_start(uint32_t widget)
+{
+    scan_widget = widget;
+    scan_remaining = widget_scan_time;
+}
+
+
+/*******************************************************************************
+* Function Name: capsense_scan_complete
+********************************************************************************
+*
+* Summary:
+*   Stands in for the end of a scan: the new raw counts of a widget.
+*
+*******************************************************************************/
+static void capsense_scan_complete(uint32_t widget)
+{
+    const cy_stc_capsense_widget_config_t *wd_config = &widget_config[widget];
+    uint32_t first = (uint32_t)(wd_config->ptrSnsContext - cy_capsense_tuner.sensorContext);
+    int32_t raw = 0;
+
+    for(uint32_t i = 0; i < wd_config->numSns; i++)
+    {
+        raw = (int32_t)(RAW_COUNT_BASE + (RAW_COUNT_STEP * (first + i))) + noise_next();
+        if(sensor_touched[first + i] == true)
+        {
+            raw += (int32_t)TOUCH_SIGNAL;
+        }
+        wd_config->ptrSnsContext[i].raw = (uint16_t)raw;
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: capsense_process_widget
+********************************************************************************
+*
+* Summary:
+*   Stands in for Cy_CapSense_ProcessWidget(): baseline, difference counts,
+*   sensor and widget status and the slider position.
+*
+*******************************************************************************/
+static void capsense_process_widget(uint32_t widget)
+{
+    const cy_stc_capsense_widget_config_t *wd_config = &widget_config[widget];
+    cy_stc_capsense_widget_context_t *wd = wd_config->ptrWdContext;
+    cy_stc_capsense_sensor_context_t *sns = NULL;
+    uint32_t sum = 0;
+    uint32_t weighted = 0;
+    uint16_t peak = 0;
+    int32_t raw = 0;
+
+    wd->status = 0u;
+
+    for(uint32_t i = 0; i < wd_config->numSns; i++)
+    {
+        sns = &wd_config->ptrSnsContext[i];
+        raw = (int32_t)sns->raw;
+
+        /* The baseline follows the raw counts below the noise threshold */
+        if((raw - (int32_t)sns->bsln) < (int32_t)wd->noiseTh)
+        {
+            sns->bsln = (uint16_t)((int32_t)sns->bsln +\
+                                   ((raw - (int32_t)sns->bsln) >> BASELINE_SHIFT));
+        }
+
+        sns->diff = (raw > (int32_t)sns->bsln) ? (uint16_t)(raw - (int32_t)sns->bsln) : 0u;
+
+        if(sns->diff >= (wd->fingerTh + wd->hysteresis))
+        {
+            sns->status = SENSOR_STATUS_ACTIVE;
+        }
+        else if(sns->diff < (wd->fingerTh - wd->hysteresis))
+        {
+            sns->status = 0u;
+        }
+
+        if(sns->status != 0u)
+        {
+            wd->status = WIDGET_STATUS_ACTIVE;
+            sum += sns->diff;
+            weighted += sns->diff * i;
+            if(sns->diff > peak)
+            {
+                peak = sns->diff;
+            }
+        }
+    }
+
+    if(widget == CY_CAPSENSE_LINEARSLIDER0_WDGT_ID)
+    {
+        wd->wdTouch.numPosition = (sum != 0u) ? 1u : 0u;
+        wd->wdTouch.ptrPosition[0].x = (sum != 0u) ?\
+                (uint16_t)((weighted * SLIDER_RESOLUTION) / (sum * (wd_config->numSns - 1u))) :\
+                0u;
+    }
+
+    if(auto_tune == true)
+    {
+        capsense_auto_tune(widget, peak);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: capsense_auto_tune
+********************************************************************************
+*
+* Summary:
+*   Stands in for SmartSense: sets the thresholds of a widget from the peak
+*   signal of its last touch, and calibrates it again periodically.
+*
+* Parameters:
+*  uint32_t widget : Widget processed
+*  uint16_t peak   : Largest difference count of its active sensors
+*
+*******************************************************************************/
+static void capsense_auto_tune(uint32_t widget, uint16_t peak)
+{
+    cy_stc_capsense_widget_context_t *wd = &cy_capsense_tuner.widgetContext[widget];
+
+    if(peak > touch_peak[widget])
+    {
+        touch_peak[widget] = peak;
+    }
+
+    if((wd->status == 0u) && (touch_peak[widget] != 0u))
+    {
+        wd->fingerTh = (uint16_t)((touch_peak[widget] * AUTO_TUNE_FINGER_TH_NUM) /\
+                                  AUTO_TUNE_FINGER_TH_DEN);
+        wd->noiseTh = wd->fingerTh >> AUTO_TUNE_NOISE_TH_SHIFT;
+        wd->nNoiseTh = wd->noiseTh;
+        wd->hysteresis = wd->fingerTh >> AUTO_TUNE_HYSTERESIS_SHIFT;
+        touch_peak[widget] = 0u;
+    }
+
+    if((scan_frames % AUTO_TUNE_CALIBRATION_SCANS) == 0u)
+    {
+        capsense_calibrate(widget);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: capsense_calibrate
+********************************************************************************
+*
+* Summary:
+*   Stands in for Cy_CapSense_CalibrateWidget() with the sense clock chosen
+*   by SmartSense: new sense clock, modulator and compensation IDACs, and a
+*   new baseline.
+*
+*******************************************************************************/
+static void capsense_calibrate(uint32_t widget)
+{
+    const cy_stc_capsense_widget_config_t *wd_config = &widget_config[widget];
+    cy_stc_capsense_widget_context_t *wd = wd_config->ptrWdContext;
+    uint32_t first = (uint32_t)(wd_config->ptrSnsContext - cy_capsense_tuner.sensorContext);
+
+    lcg_state = (lcg_state * LCG_MULTIPLIER) + LCG_INCREMENT;
+    wd->snsClk = (uint16_t)(INIT_SNS_CLK + ((lcg_state >> LCG_SHIFT) & AUTO_TUNE_CALIBRATION_MASK));
+    wd->idacMod[0] = (uint8_t)(INIT_IDAC_MOD + ((lcg_state >> (LCG_SHIFT + 2u)) &\
+                                                AUTO_TUNE_CALIBRATION_MASK));
+
+    for(uint32_t i = 0; i < wd_config->numSns; i++)
+    {
+        lcg_state = (lcg_state * LCG_MULTIPLIER) + LCG_INCREMENT;
+        wd_config->ptrSnsContext[i].idacComp =\
+                (uint8_t)(INIT_IDAC_COMP + first + i +\
+                          ((lcg_state >> LCG_SHIFT) & AUTO_TUNE_CALIBRATION_MASK));
+        wd_config->ptrSnsContext[i].bsln = wd_config->ptrSnsContext[i].raw;
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: capsense_run_tuner
+********************************************************************************
+*
+* Summary:
+*   Stands in for Cy_CapSense_RunTuner(), which calls the tuner send
+*   callback once per scan. After a suspend command, it keeps calling the
+*   callback, which processes the BLE stack events, until the tuner writes
+*   the resume or restart command; no scan runs meanwhile.
+*
+*******************************************************************************/
+static void capsense_run_tuner(void)
+{
+    cy_stc_capsense_common_context_t *common = &cy_capsense_tuner.commonContext;
+    bool suspended = false;
+
+    common->scanCounter++;
+    common->tunerCnt++;
+
+    do
+    {
+        if(common->ptrTunerSendCallback != NULL)
+        {
+            common->ptrTunerSendCallback(&cy_capsense_context);
+        }
+
+        switch(common->tunerCmd)
+        {
+            case CY_CAPSENSE_TU_CMD_SUSPEND_E:
+                suspended = true;
+                common->tunerCmd = CY_CAPSENSE_TU_CMD_NONE_E;
+                break;
+
+            case CY_CAPSENSE_TU_CMD_RESUME_E:
+            case CY_CAPSENSE_TU_CMD_RESTART_E:
+                suspended = false;
+                common->tunerCmd = CY_CAPSENSE_TU_CMD_NONE_E;
+                break;
+
+            default:
+                break;
+        }
+
+        if(suspended == true)
+        {
+            /* Sleep until the BLE stack has work */
+            (void)host_stack_advance(SUSPEND_POLL_US);
+        }
+    } while(suspended == true);
+}
+
+
+/*******************************************************************************
+* Function Name: Cy_CapSense_InitializeWidgetBaseline
+********************************************************************************
+*
+* Summary:
+*   Sets the baseline of every sensor of a widget to its raw counts.
+*
+*******************************************************************************/
+void Cy_CapSense_InitializeWidgetBaseline(uint32_t widgetId,
+                                          cy_stc_capsense_context_t *context)
+{
+    const cy_stc_capsense_widget_config_t *wd_config = &context->ptrWdConfig[widgetId];
+
+    for(uint32_t i = 0; i < wd_config->numSns; i++)
+    {
+        wd_config->ptrSnsContext[i].bsln = wd_config->ptrSnsContext[i].raw;
+    }
+
+    baseline_inits[widgetId]++;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_writes_apply
+********************************************************************************
+*
+* Summary:
+*   As in main.c: applies the tuner writes and marks the widgets they
+*   change.
+*
+*******************************************************************************/
+static void tuner_writes_apply(void)
+{
+    bool changed[CY_CAPSENSE_WIDGET_COUNT];
+
+    if(tuner_transport_writes_apply(changed) == true)
+    {
+        for(uint32_t widget = 0; widget < CY_CAPSENSE_WIDGET_COUNT; widget++)
+        {
+            if(changed[widget] == true)
+            {
+                widget_reinit[widget] = true;
+            }
+        }
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: widget_baseline_reinit
+********************************************************************************
+*
+* Summary:
+*   As in main.c: initializes the baseline of a marked widget from its first
+*   scan with the new settings.
+*
+*******************************************************************************/
+static void widget_baseline_reinit(uint32_t widget)
+{
+    if(widget_reinit[widget] == true)
+    {
+        widget_reinit[widget] = false;
+        Cy_CapSense_InitializeWidgetBaseline(widget, &cy_capsense_context);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: touch_events_update
+********************************************************************************
+*
+* Summary:
+*   As in main.c: queues a touch event and hands it to the BLE stack.
+*
+*******************************************************************************/
+static void touch_events_update(uint32_t widget)
+{
+    if(tuner_touch_events_update(widget) == true)
+    {
+        ble_touch_events_send();
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: noise_next
+********************************************************************************
+*
+* Summary:
+*   Returns the next noise sample, -noise_amplitude to +noise_amplitude.
+*
+*******************************************************************************/
+static int32_t noise_next(void)
+{
+    lcg_state = (lcg_state * LCG_MULTIPLIER) + LCG_INCREMENT;
+
+    if(noise_amplitude == 0u)
+    {
+        return 0;
+    }
+
+    return (int32_t)((lcg_state >> LCG_SHIFT) % ((2u * noise_amplitude) + 1u)) -\
+           (int32_t)noise_amplitude;
+}
+
+
+/* [] END OF FILE */
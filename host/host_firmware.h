@@ -0,0 +1,87 @@
+/******************************************************************************
+* File Name: host_firmware.h
+*
+* Description: This file contains the interface of the host stand-in for the
+*              CapSense middleware and of the main loop that runs the firmware
+*              modules on the host.
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include guard
+ *****************************************************************************/
+#ifndef HOST_FIRMWARE_H_
+#define HOST_FIRMWARE_H_
+
+/******************************************************************************
+ * Include header files
+ *****************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+/* Scan time of one widget unless set otherwise */
+#define HOST_WIDGET_SCAN_US          (2000u)
+
+
+/******************************************************************************
+ * Data Types
+ *****************************************************************************/
+/* Called after Cy_CapSense_RunTuner(), when the tuner has taken its
+ * snapshot and before the queued tuner writes take effect */
+typedef void (*host_firmware_hook_t)(void);
+
+
+/******************************************************************************
+ * Function Prototypes
+ *****************************************************************************/
+void host_firmware_init(uint32_t seed);
+void host_firmware_run(uint32_t scans);
+void host_firmware_run_until(uint32_t time_us);
+void host_firmware_set_scan_time(uint32_t widget_scan_us);
+void host_firmware_set_noise(uint16_t amplitude);
+void host_firmware_set_auto_tune(bool enable);
+void host_firmware_set_hook(host_firmware_hook_t hook);
+void host_firmware_touch(uint32_t sensor, bool touched);
+uint32_t host_firmware_scans(void);
+uint32_t host_firmware_baseline_inits(uint32_t widget);
+
+
+#endif /* HOST_FIRMWARE_H_ */
@@ -0,0 +1,1395 @@
+/******************************************************************************
+* File Name: host_stack.c
+*
+* Description: This file contains the host stand-in for the BLE stack, the HAL
+*              and the CPU core: a simulated clock, links to the GATT clients
+*              that carry the notifications once per connection event, and the
+*              event injector that drives the stack event handler of
+*              tuner_ble_server.c.
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <string.h>
+#include "host_stack.h"
+#include "cyhal.h"
+#include "cybsp.h"
+#include "cy_retarget_io.h"
+#include "cycfg_ble.h"
+
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define CONN_INTERVAL_UNIT_US        (1250u)
+#define CORE_CLOCK_HZ                (100000000u)
+#define US_PER_S                     (1000000u)
+
+/* Values of the GATT database, one per attribute handle */
+#define HOST_STACK_VALUE_SIZE        (1024u)
+
+/* Link defaults before the MTU exchange and the data length update */
+#define DEFAULT_ATT_MTU              (23u)
+#define DEFAULT_LL_TX_OCTETS         (27u)
+
+/* ATT opcode and handle, L2CAP length and channel ID in front of a
+ * notification value */
+#define ATT_NTF_HEADER_SIZE          (3u)
+#define L2CAP_HEADER_SIZE            (4u)
+
+/* Air time of an LL data PDU: preamble, access address, header and MIC-less
+ * CRC are 10 bytes on 1M; the empty acknowledgement of the peer and the two
+ * inter frame spaces follow it */
+#define LL_PDU_OVERHEAD_BYTES        (10u)
+#define LL_EMPTY_PDU_BYTES           (10u)
+#define LL_IFS_US                    (150u)
+#define BITS_PER_BYTE                (8u)
+
+/* Peer answers to the link requests arrive this many connection intervals
+ * after the request */
+#define PEER_RESPONSE_INTERVALS      (2u)
+#define CONN_PARAM_ACCEPTED          (0u)
+#define CONN_PARAM_REJECTED          (1u)
+
+#define DEFERRED_EVENT_COUNT         (16u)
+#define NO_LINK                      (0xFFu)
+
+
+/*******************************************************************************
+ * Data Types
+ ******************************************************************************/
+/* Notification handed to the stack and not yet acknowledged by the peer */
+typedef struct
+{
+    uint16_t attr_handle;
+    uint16_t len;
+    uint8_t value[CY_BLE_GATT_MTU];
+} host_ntf_t;
+
+
+/* Simulated connection */
+typedef struct
+{
+    bool connected;
+    host_peer_t peer;
+    uint16_t mtu;
+    uint16_t tx_octets;
+    uint8_t phy;                /* CY_BLE_PHY_MASK_LE_* */
+    uint16_t interval;
+
+    /* Time of the next connection event */
+    uint32_t next_event;
+
+    /* Notifications queued in the stack; LL PDUs of the oldest one already
+     * acknowledged */
+    host_ntf_t queue[HOST_STACK_TX_BUFFERS];
+    uint8_t queue_head;
+    uint8_t queue_count;
+    uint16_t head_pdus_sent;
+
+    /* CCCD values of the client */
+    uint8_t cccd[CY_BLE_GATT_DB_MAX_HANDLE];
+
+    host_link_stats_t stats;
+} host_link_t;
+
+
+/* Stack event waiting for Cy_BLE_ProcessEvents() */
+typedef struct
+{
+    bool used;
+    bool signalled;             /* The firmware was told it is pending */
+    uint8_t bd_handle;
+    uint32_t due;
+    uint32_t event;
+    union
+    {
+        cy_stc_ble_data_length_param_t dle;
+        struct
+        {
+            cy_stc_ble_events_param_generic_t generic;
+            cy_stc_ble_phy_param_t phy;
+        } phy;
+        cy_stc_ble_l2cap_conn_update_rsp_param_t conn_rsp;
+        cy_stc_ble_gap_conn_param_updated_in_controller_t conn_upd;
+    } param;
+} host_event_t;
+
+
+/*******************************************************************************
+ * Global variables
+ ******************************************************************************/
+/* CPU core and BLE configuration the firmware expects */
+uint32_t SystemCoreClock = CORE_CLOCK_HZ;
+static DWT_Type host_dwt;
+static CoreDebug_Type host_core_debug;
+DWT_Type *DWT = &host_dwt;
+CoreDebug_Type *CoreDebug = &host_core_debug;
+static cy_stc_ble_hw_config_t host_ble_hw_config;
+cy_stc_ble_config_t cy_ble_config = { .hw = &host_ble_hw_config };
+
+/* Simulated time */
+static uint32_t host_time_us = 0;
+
+/* Callbacks registered by the firmware and the test */
+static cy_ble_callback_t event_handler = NULL;
+static void (*app_host_callback)(void) = NULL;
+static host_stack_rx_t receiver = NULL;
+
+static host_link_t links[CY_BLE_CONN_COUNT];
+static host_event_t deferred_events[DEFERRED_EVENT_COUNT];
+static cy_en_ble_adv_state_t adv_state = CY_BLE_ADV_STATE_STOPPED;
+static bool stack_enabled = false;
+static bool stack_held_busy = false;
+
+/* GATT database values written by the server */
+static uint8_t db_value[CY_BLE_GATT_DB_MAX_HANDLE][HOST_STACK_VALUE_SIZE];
+static uint16_t db_len[CY_BLE_GATT_DB_MAX_HANDLE];
+
+/* Answer of the server to the write request being injected */
+static bool write_rsp_received = false;
+static cy_en_ble_gatt_err_code_t write_rsp_error = CY_BLE_GATT_ERR_NONE;
+
+/* Event script */
+static const host_step_t *script_steps = NULL;
+static uint16_t script_count = 0;
+static uint16_t script_next = 0;
+
+
+/*******************************************************************************
+ * Function Prototypes
+*******************************************************************************/
+static void stack_dispatch(uint32_t event, void *param);
+static host_event_t *event_defer(uint32_t event, uint8_t bd_handle);
+static bool link_event(uint8_t bd_handle);
+static uint32_t pdu_air_us(const host_link_t *link, uint16_t octets);
+static uint16_t ntf_pdus(const host_link_t *link, uint16_t len);
+static bool script_step_run(const host_step_t *step);
+static bool is_cccd(uint16_t attr_handle);
+
+
+/*******************************************************************************
+* Function Name: host_stack_reset
+********************************************************************************
+*
+* Summary:
+*   Drops every connection, queued notification and pending event without
+*   telling the firmware. The simulated time keeps running so that the time
+*   base of the firmware never steps back.
+*
+*******************************************************************************/
+void host_stack_reset(void)
+{
+    memset(links, 0, sizeof(links));
+    memset(deferred_events, 0, sizeof(deferred_events));
+    stack_held_busy = false;
+    script_steps = NULL;
+    script_count = 0;
+    script_next = 0;
+}
+
+
+/*******************************************************************************
+* Function Name: host_stack_set_receiver
+********************************************************************************
+*
+* Summary:
+*   Sets the function that gets every notification when the peer receives it.
+*
+*******************************************************************************/
+void host_stack_set_receiver(host_stack_rx_t rx)
+{
+    receiver = rx;
+}
+
+
+/*******************************************************************************
+* Function Name: host_stack_time
+********************************************************************************
+*
+* Summary:
+*   Returns the simulated time in microseconds.
+*
+*******************************************************************************/
+uint32_t host_stack_time(void)
+{
+    return host_time_us;
+}
+
+
+/*******************************************************************************
+* Function Name: host_stack_advance
+********************************************************************************
+*
+* Summary:
+*   Moves the simulated time on and runs the connection events and script
+*   steps that fall due. Returns early, as the BLESS interrupt would wake the
+*   CPU, once a connection event carried packets, a stack event became
+*   pending or a script step ran.
+*
+* Parameters:
+*  uint32_t us : Time to move on by
+*
+* Return:
+*   Time moved on by
+*
+*******************************************************************************/
+uint32_t host_stack_advance(uint32_t us)
+{
+    uint32_t start = host_time_us;
+    uint32_t end = host_time_us + us;
+    uint32_t next = 0;
+    bool wake = false;
+
+    while(wake == false)
+    {
+        /* Earliest of the connection events, pending events and steps */
+        next = end;
+        for(uint8_t i = 0; i < CY_BLE_CONN_COUNT; i++)
+        {
+            if((links[i].connected == true) &&\
+               ((int32_t)(links[i].next_event - next) < 0))
+            {
+                next = links[i].next_event;
+            }
+        }
+        for(uint8_t i = 0; i < DEFERRED_EVENT_COUNT; i++)
+        {
+            if((deferred_events[i].used == true) &&\
+               (deferred_events[i].signalled == false) &&\
+               ((int32_t)(deferred_events[i].due - next) < 0))
+            {
+                next = deferred_events[i].due;
+            }
+        }
+        if((script_next < script_count) &&\
+           ((int32_t)(script_steps[script_next].time_us - next) < 0))
+        {
+            next = script_steps[script_next].time_us;
+        }
+
+        if((int32_t)(next - host_time_us) > 0)
+        {
+            host_time_us = next;
+        }
+        DWT->CYCCNT = host_time_us * (SystemCoreClock / US_PER_S);
+
+        for(uint8_t i = 0; i < CY_BLE_CONN_COUNT; i++)
+        {
+            if((links[i].connected == true) &&\
+               ((int32_t)(links[i].next_event - host_time_us) <= 0))
+            {
+                wake |= link_event(i);
+            }
+        }
+
+        for(uint8_t i = 0; i < DEFERRED_EVENT_COUNT; i++)
+        {
+            if((deferred_events[i].used == true) &&\
+               (deferred_events[i].signalled == false) &&\
+               ((int32_t)(deferred_events[i].due - host_time_us) <= 0))
+            {
+                deferred_events[i].signalled = true;
+                wake = true;
+                if(app_host_callback != NULL)
+                {
+                    app_host_callback();
+                }
+            }
+        }
+
+        while((script_next < script_count) &&\
+              ((int32_t)(script_steps[script_next].time_us - host_time_us) <= 0))
+        {
+            wake |= script_step_run(&script_steps[script_next]);
+            script_next++;
+        }
+
+        if(host_time_us == end)
+        {
+            break;
+        }
+    }
+
+    return host_time_us - start;
+}
+
+
+/*******************************************************************************
+* Function Name: link_event
+********************************************************************************
+*
+* Summary:
+*   Runs one connection event: sends the LL PDUs of the queued notifications
+*   while the peer takes more PDUs and the event fits in the interval, and
+*   hands each complete notification to the receiver.
+*
+* Return:
+*   true if a notification was delivered
+*
+*******************************************************************************/
+static bool link_event(uint8_t bd_handle)
+{
+    host_link_t *link = &links[bd_handle];
+    uint32_t interval_us = (uint32_t)link->interval * CONN_INTERVAL_UNIT_US;
+    uint32_t air_us = 0;
+    uint16_t pdus = 0;
+    bool delivered = false;
+    host_ntf_t *ntf = NULL;
+    uint16_t pdus_needed = 0;
+
+    link->next_event += interval_us;
+    link->stats.conn_events++;
+
+    while((link->queue_count > 0u) && (pdus < link->peer.pdus_per_event) &&\
+          ((air_us + pdu_air_us(link, link->tx_octets)) <= interval_us))
+    {
+        ntf = &link->queue[link->queue_head];
+        pdus_needed = ntf_pdus(link, ntf->len);
+
+        air_us += pdu_air_us(link, link->tx_octets);
+        pdus++;
+        link->head_pdus_sent++;
+
+        /* The data length may have grown since the first PDU */
+        if(link->head_pdus_sent >= pdus_needed)
+        {
+            link->head_pdus_sent = 0;
+            link->queue_head = (uint8_t)((link->queue_head + 1u) % HOST_STACK_TX_BUFFERS);
+            link->queue_count--;
+            link->stats.notifications++;
+            link->stats.bytes += ntf->len;
+            delivered = true;
+
+            if(receiver != NULL)
+            {
+                receiver(bd_handle, ntf->attr_handle, ntf->value, ntf->len);
+            }
+        }
+    }
+
+    return delivered;
+}
+
+
+/*******************************************************************************
+* Function Name: pdu_air_us
+********************************************************************************
+*
+* Summary:
+*   Returns the air time of an LL data PDU and its acknowledgement.
+*
+*******************************************************************************/
+static uint32_t pdu_air_us(const host_link_t *link, uint16_t octets)
+{
+    uint32_t bits_per_us = (link->phy == CY_BLE_PHY_MASK_LE_2M) ? 2u : 1u;
+
+    return ((((uint32_t)octets + LL_PDU_OVERHEAD_BYTES + LL_EMPTY_PDU_BYTES) *\
+             BITS_PER_BYTE) / bits_per_us) + (2u * LL_IFS_US);
+}
+
+
+/*******************************************************************************
+* Function Name: ntf_pdus
+********************************************************************************
+*
+* Summary:
+*   Returns the number of LL data PDUs a notification value takes.
+*
+*******************************************************************************/
+static uint16_t ntf_pdus(const host_link_t *link, uint16_t len)
+{
+    uint16_t l2cap_len = len + ATT_NTF_HEADER_SIZE + L2CAP_HEADER_SIZE;
+
+    return (uint16_t)((l2cap_len + link->tx_octets - 1u) / link->tx_octets);
+}
+
+
+/*******************************************************************************
+* Function Name: stack_dispatch
+********************************************************************************
+*
+* Summary:
+*   Hands an event to the handler registered by the firmware, as
+*   Cy_BLE_ProcessEvents() does.
+*
+*******************************************************************************/
+static void stack_dispatch(uint32_t event, void *param)
+{
+    if(event_handler != NULL)
+    {
+        event_handler(event, param);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: event_defer
+********************************************************************************
+*
+* Summary:
+*   Takes a free entry for a stack event that the peer answers after
+*   PEER_RESPONSE_INTERVALS connection intervals.
+*
+* Return:
+*   The entry, NULL if none is free
+*
+*******************************************************************************/
+static host_event_t *event_defer(uint32_t event, uint8_t bd_handle)
+{
+    for(uint8_t i = 0; i < DEFERRED_EVENT_COUNT; i++)
+    {
+        if(deferred_events[i].used == false)
+        {
+            memset(&deferred_events[i], 0, sizeof(host_event_t));
+            deferred_events[i].used = true;
+            deferred_events[i].event = event;
+            deferred_events[i].bd_handle = bd_handle;
+            deferred_events[i].due = host_time_us + (PEER_RESPONSE_INTERVALS *\
+                    (uint32_t)links[bd_handle].interval * CONN_INTERVAL_UNIT_US);
+            return &deferred_events[i];
+        }
+    }
+
+    return NULL;
+}
+
+
+/*******************************************************************************
+* Function Name: is_cccd
+********************************************************************************
+*
+* Summary:
+*   Returns true for the handles of the Client Characteristic Configuration
+*   descriptors.
+*
+*******************************************************************************/
+static bool is_cccd(uint16_t attr_handle)
+{
+    switch(attr_handle)
+    {
+    case CY_BLE_CAPSENSE_TUNER_CAPSENSE_DS_CLIENT_CHARACTERISTIC_CONFIGURATION_DESC_HANDLE:
+    case CY_BLE_CAPSENSE_TUNER_LINK_STATS_CLIENT_CHARACTERISTIC_CONFIGURATION_DESC_HANDLE:
+    case CY_BLE_CAPSENSE_TUNER_TUNER_CONTROL_CLIENT_CHARACTERISTIC_CONFIGURATION_DESC_HANDLE:
+    case CY_BLE_CAPSENSE_TUNER_TUNER_SAMPLES_CLIENT_CHARACTERISTIC_CONFIGURATION_DESC_HANDLE:
+    case CY_BLE_CAPSENSE_TUNER_SENSOR_STATS_CLIENT_CHARACTERISTIC_CONFIGURATION_DESC_HANDLE:
+    case CY_BLE_CAPSENSE_TUNER_TOUCH_EVENTS_CLIENT_CHARACTERISTIC_CONFIGURATION_DESC_HANDLE:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+
+/*******************************************************************************
+ *                       GATT client side: event injector
+ ******************************************************************************/
+
+/*******************************************************************************
+* Function Name: host_stack_connect
+********************************************************************************
+*
+* Summary:
+*   Connects a GATT client and, if it asks for a larger ATT MTU, exchanges
+*   the MTU. The link then runs at the connection interval of the peer until
+*   the firmware negotiates another.
+*
+* Parameters:
+*  uint8_t bd_handle        : BD handle of the connection, also its ATT ID
+*  const host_peer_t *peer  : Capabilities of the GATT client
+*
+*******************************************************************************/
+void host_stack_connect(uint8_t bd_handle, const host_peer_t *peer)
+{
+    host_link_t *link = &links[bd_handle];
+    cy_stc_ble_gap_enhance_conn_complete_param_t conn_param;
+    cy_stc_ble_conn_handle_t conn_handle;
+
+    memset(link, 0, sizeof(host_link_t));
+    link->connected = true;
+    link->peer = *peer;
+    link->mtu = DEFAULT_ATT_MTU;
+    link->tx_octets = DEFAULT_LL_TX_OCTETS;
+    link->phy = CY_BLE_PHY_MASK_LE_1M;
+    link->interval = peer->interval;
+    link->next_event = host_time_us + ((uint32_t)link->interval * CONN_INTERVAL_UNIT_US);
+    adv_state = CY_BLE_ADV_STATE_STOPPED;
+
+    memset(&conn_param, 0, sizeof(conn_param));
+    conn_param.bdHandle = bd_handle;
+    conn_param.peerBdAddr[0] = bd_handle;
+    conn_param.connIntv = link->interval;
+    stack_dispatch(CY_BLE_EVT_GAP_DEVICE_CONNECTED, &conn_param);
+
+    conn_handle.bdHandle = bd_handle;
+    conn_handle.attId = bd_handle;
+    stack_dispatch(CY_BLE_EVT_GATT_CONNECT_IND, &conn_handle);
+
+    if(peer->mtu > DEFAULT_ATT_MTU)
+    {
+        host_stack_mtu(bd_handle, peer->mtu);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: host_stack_disconnect
+********************************************************************************
+*
+* Summary:
+*   Drops a connection; the notifications still queued are lost.
+*
+*******************************************************************************/
+void host_stack_disconnect(uint8_t bd_handle, uint8_t reason)
+{
+    cy_stc_ble_conn_handle_t conn_handle;
+    cy_stc_ble_gap_disconnect_param_t disc_param;
+
+    if(links[bd_handle].connected == false)
+    {
+        return;
+    }
+
+    links[bd_handle].connected = false;
+    for(uint8_t i = 0; i < DEFERRED_EVENT_COUNT; i++)
+    {
+        if(deferred_events[i].bd_handle == bd_handle)
+        {
+            deferred_events[i].used = false;
+        }
+    }
+
+    conn_handle.bdHandle = bd_handle;
+    conn_handle.attId = bd_handle;
+    stack_dispatch(CY_BLE_EVT_GATT_DISCONNECT_IND, &conn_handle);
+
+    disc_param.bdHandle = bd_handle;
+    disc_param.reason = reason;
+    stack_dispatch(CY_BLE_EVT_GAP_DEVICE_DISCONNECTED, &disc_param);
+}
+
+
+/*******************************************************************************
+* Function Name: host_stack_mtu
+********************************************************************************
+*
+* Summary:
+*   Exchanges the ATT MTU; the smaller of both sides is used.
+*
+*******************************************************************************/
+void host_stack_mtu(uint8_t bd_handle, uint16_t mtu)
+{
+    cy_stc_ble_gatt_xchg_mtu_param_t mtu_param;
+
+    links[bd_handle].mtu = (mtu < CY_BLE_GATT_MTU) ? mtu : CY_BLE_GATT_MTU;
+
+    mtu_param.connHandle.bdHandle = bd_handle;
+    mtu_param.connHandle.attId = bd_handle;
+    mtu_param.mtu = mtu;
+    stack_dispatch(CY_BLE_EVT_GATTS_XCNHG_MTU_REQ, &mtu_param);
+}
+
+
+/*******************************************************************************
+* Function Name: host_stack_write_req
+********************************************************************************
+*
+* Summary:
+*   Sends a write request and returns the answer of the server.
+*
+* Return:
+*   CY_BLE_GATT_ERR_NONE for a write response, else the error code of the
+*   error response; CY_BLE_GATT_ERR_UNLIKELY_ERROR if the server did not
+*   answer
+*
+*******************************************************************************/
+cy_en_ble_gatt_err_code_t host_stack_write_req(uint8_t bd_handle,
+                                               uint16_t attr_handle,
+                                               const uint8_t *data,
+                                               uint16_t len)
+{
+    cy_stc_ble_gatt_write_param_t write_param;
+    uint8_t value[HOST_STACK_VALUE_SIZE];
+
+    memcpy(value, data, len);
+    write_param.connHandle.bdHandle = bd_handle;
+    write_param.connHandle.attId = bd_handle;
+    write_param.handleValPair.attrHandle = attr_handle;
+    write_param.handleValPair.value.val = value;
+    write_param.handleValPair.value.len = len;
+    write_param.handleValPair.value.actualLen = len;
+
+    write_rsp_received = false;
+    write_rsp_error = CY_BLE_GATT_ERR_UNLIKELY_ERROR;
+    stack_dispatch(CY_BLE_EVT_GATTS_WRITE_REQ, &write_param);
+
+    return (write_rsp_received == true) ? write_rsp_error :\
+                                          CY_BLE_GATT_ERR_UNLIKELY_ERROR;
+}
+
+
+/*******************************************************************************
+* Function Name: host_stack_write_cmd
+********************************************************************************
+*
+* Summary:
+*   Sends a write command; the server does not answer.
+*
+*******************************************************************************/
+void host_stack_write_cmd(uint8_t bd_handle, uint16_t attr_handle,
+                          const uint8_t *data, uint16_t len)
+{
+    cy_stc_ble_gatts_write_cmd_req_param_t write_param;
+    uint8_t value[HOST_STACK_VALUE_SIZE];
+
+    memcpy(value, data, len);
+    write_param.connHandle.bdHandle = bd_handle;
+    write_param.connHandle.attId = bd_handle;
+    write_param.handleValPair.attrHandle = attr_handle;
+    write_param.handleValPair.value.val = value;
+    write_param.handleValPair.value.len = len;
+    write_param.handleValPair.value.actualLen = len;
+
+    stack_dispatch(CY_BLE_EVT_GATTS_WRITE_CMD_REQ, &write_param);
+}
+
+
+/*******************************************************************************
+* Function Name: host_stack_cccd
+********************************************************************************
+*
+* Summary:
+*   Enables or disables the notifications of a characteristic.
+*
+*******************************************************************************/
+cy_en_ble_gatt_err_code_t host_stack_cccd(uint8_t bd_handle,
+                                          uint16_t cccd_handle, bool enable)
+{
+    uint8_t value[2] = { (enable == true) ? CY_BLE_CCCD_NOTIFICATION : 0u, 0u };
+
+    return host_stack_write_req(bd_handle, cccd_handle, value, sizeof(value));
+}
+
+
+/*******************************************************************************
+* Function Name: host_stack_read
+********************************************************************************
+*
+* Summary:
+*   Reads a characteristic value with a read request followed by read blob
+*   requests until a response is shorter than the ATT MTU allows.
+*
+* Parameters:
+*  uint8_t bd_handle    : BD handle of the connection
+*  uint16_t attr_handle : Handle of the characteristic value
+*  uint8_t *buffer      : Receives the value
+*  uint16_t capacity    : Size of the buffer
+*
+* Return:
+*   Length of the value read, 0 on an error response
+*
+*******************************************************************************/
+uint16_t host_stack_read(uint8_t bd_handle, uint16_t attr_handle,
+                         uint8_t *buffer, uint16_t capacity)
+{
+    cy_stc_ble_gatts_char_val_read_req_t read_param;
+    uint16_t max_rsp = links[bd_handle].mtu - 1u;
+    uint16_t offset = 0;
+    uint16_t len = 0;
+
+    for(;;)
+    {
+        read_param.connHandle.bdHandle = bd_handle;
+        read_param.connHandle.attId = bd_handle;
+        read_param.attrHandle = attr_handle;
+        read_param.gattErrorCode = CY_BLE_GATT_ERR_NONE;
+        stack_dispatch(CY_BLE_EVT_GATTS_READ_CHAR_VAL_ACCESS_REQ, &read_param);
+
+        if((read_param.gattErrorCode != CY_BLE_GATT_ERR_NONE) ||\
+           (offset > db_len[attr_handle]))
+        {
+            return 0u;
+        }
+
+        len = db_len[attr_handle] - offset;
+        len = (len > max_rsp) ? max_rsp : len;
+        len = ((offset + len) > capacity) ? (capacity - offset) : len;
+        memcpy(&buffer[offset], &db_value[attr_handle][offset], len);
+        offset += len;
+
+        if((len < max_rsp) || (offset >= capacity))
+        {
+            return offset;
+        }
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: host_stack_set_busy
+********************************************************************************
+*
+* Summary:
+*   Holds the stack busy, e.g. while it serves another layer, so that every
+*   notification is refused.
+*
+*******************************************************************************/
+void host_stack_set_busy(bool busy)
+{
+    stack_held_busy = busy;
+}
+
+
+/*******************************************************************************
+* Function Name: host_stack_script
+********************************************************************************
+*
+* Summary:
+*   Sets the steps run by host_stack_advance() when their time is reached.
+*   The steps are in time order and stay valid until the script is done.
+*
+*******************************************************************************/
+void host_stack_script(const host_step_t *steps, uint16_t count)
+{
+    script_steps = steps;
+    script_count = count;
+    script_next = 0;
+}
+
+
+/*******************************************************************************
+* Function Name: script_step_run
+********************************************************************************
+*
+* Summary:
+*   Runs one step of the script.
+*
+* Return:
+*   true, the step woke the firmware
+*
+*******************************************************************************/
+static bool script_step_run(const host_step_t *step)
+{
+    switch(step->op)
+    {
+    case HOST_STEP_CONNECT:
+        host_stack_connect(step->bd_handle, step->peer);
+        break;
+
+    case HOST_STEP_DISCONNECT:
+        host_stack_disconnect(step->bd_handle, (uint8_t)step->value);
+        break;
+
+    case HOST_STEP_MTU:
+        host_stack_mtu(step->bd_handle, step->value);
+        break;
+
+    case HOST_STEP_CCCD:
+        (void)host_stack_cccd(step->bd_handle, step->attr_handle, (step->value != 0u));
+        break;
+
+    case HOST_STEP_WRITE_REQ:
+        (void)host_stack_write_req(step->bd_handle, step->attr_handle,\
+                                   step->data, step->len);
+        break;
+
+    case HOST_STEP_WRITE_CMD:
+        host_stack_write_cmd(step->bd_handle, step->attr_handle,\
+                             step->data, step->len);
+        break;
+
+    case HOST_STEP_BUSY:
+        host_stack_set_busy(step->value != 0u);
+        break;
+
+    default:
+        break;
+    }
+
+    return true;
+}
+
+
+/*******************************************************************************
+* Function Name: host_stack_interval
+********************************************************************************
+*
+* Summary:
+*   Returns the connection interval in use, 1.25 ms units.
+*
+*******************************************************************************/
+uint16_t host_stack_interval(uint8_t bd_handle)
+{
+    return links[bd_handle].interval;
+}
+
+
+/*******************************************************************************
+* Function Name: host_stack_link_stats
+********************************************************************************
+*
+* Summary:
+*   Returns the counters of a connection.
+*
+*******************************************************************************/
+const host_link_stats_t *host_stack_link_stats(uint8_t bd_handle)
+{
+    return &links[bd_handle].stats;
+}
+
+
+/*******************************************************************************
+ *                       BLE stack API
+ ******************************************************************************/
+
+void Cy_BLE_BlessIsrHandler(void)
+{
+}
+
+cy_en_ble_api_result_t Cy_BLE_RegisterEventCallback(cy_ble_callback_t callbackFunc)
+{
+    event_handler = callbackFunc;
+    return CY_BLE_SUCCESS;
+}
+
+cy_en_ble_api_result_t Cy_BLE_RegisterAppHostCallback(void (*callbackFunc)(void))
+{
+    app_host_callback = callbackFunc;
+    return CY_BLE_SUCCESS;
+}
+
+cy_en_ble_api_result_t Cy_BLE_Init(cy_stc_ble_config_t *config)
+{
+    return (config == NULL) ? CY_BLE_ERROR_INVALID_PARAMETER : CY_BLE_SUCCESS;
+}
+
+cy_en_ble_api_result_t Cy_BLE_Enable(void)
+{
+    stack_enabled = true;
+    return CY_BLE_SUCCESS;
+}
+
+
+/*******************************************************************************
+* Function Name: Cy_BLE_ProcessEvents
+********************************************************************************
+*
+* Summary:
+*   Reports the stack on once, then hands the peer answers that are due to
+*   the event handler.
+*
+*******************************************************************************/
+void Cy_BLE_ProcessEvents(void)
+{
+    host_event_t event;
+
+    if(stack_enabled == true)
+    {
+        stack_enabled = false;
+        stack_dispatch(CY_BLE_EVT_STACK_ON, NULL);
+    }
+
+    for(uint8_t i = 0; i < DEFERRED_EVENT_COUNT; i++)
+    {
+        if((deferred_events[i].used == false) ||\
+           ((int32_t)(deferred_events[i].due - host_time_us) > 0))
+        {
+            continue;
+        }
+
+        /* The handler may defer further events */
+        event = deferred_events[i];
+        deferred_events[i].used = false;
+
+        switch(event.event)
+        {
+        case CY_BLE_EVT_DATA_LENGTH_CHANGE:
+            links[event.param.dle.bdHandle].tx_octets = event.param.dle.connMaxTxOctets;
+            stack_dispatch(event.event, &event.param.dle);
+            break;
+
+        case CY_BLE_EVT_PHY_UPDATE_COMPLETE:
+        case CY_BLE_EVT_GET_PHY_COMPLETE:
+            links[event.param.phy.phy.bdHandle].phy = event.param.phy.phy.txPhyMask;
+            event.param.phy.generic.eventParams = &event.param.phy.phy;
+            stack_dispatch(event.event, &event.param.phy.generic);
+            break;
+
+        case CY_BLE_EVT_L2CAP_CONN_PARAM_UPDATE_RSP:
+            stack_dispatch(event.event, &event.param.conn_rsp);
+            break;
+
+        case CY_BLE_EVT_GAP_CONNECTION_UPDATE_COMPLETE:
+            links[event.param.conn_upd.bdHandle].interval = event.param.conn_upd.connIntv;
+            stack_dispatch(event.event, &event.param.conn_upd);
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
+cy_en_ble_api_result_t Cy_BLE_GAPP_StartAdvertisement(uint8_t advertisingIntervalType,
+                                                      uint8_t advIndex)
+{
+    adv_state = CY_BLE_ADV_STATE_ADVERTISING;
+    return CY_BLE_SUCCESS;
+}
+
+cy_en_ble_adv_state_t Cy_BLE_GetAdvertisementState(void)
+{
+    return adv_state;
+}
+
+cy_en_ble_api_result_t Cy_BLE_GetLocalName(char *name)
+{
+    strcpy(name, "Host Tuner");
+    return CY_BLE_SUCCESS;
+}
+
+cy_en_ble_conn_state_t Cy_BLE_GetConnectionState(cy_stc_ble_conn_handle_t connHandle)
+{
+    return ((connHandle.bdHandle < CY_BLE_CONN_COUNT) &&\
+            (links[connHandle.bdHandle].connected == true)) ?\
+           CY_BLE_CONN_STATE_CONNECTED : CY_BLE_CONN_STATE_DISCONNECTED;
+}
+
+uint8_t Cy_BLE_GetNumOfActiveConn(void)
+{
+    uint8_t count = 0;
+
+    for(uint8_t i = 0; i < CY_BLE_CONN_COUNT; i++)
+    {
+        count += (links[i].connected == true) ? 1u : 0u;
+    }
+
+    return count;
+}
+
+
+/*******************************************************************************
+* Function Name: Cy_BLE_SetPhy
+********************************************************************************
+*
+* Summary:
+*   The peer takes 2M if it supports it, else the link stays on 1M.
+*
+*******************************************************************************/
+cy_en_ble_api_result_t Cy_BLE_SetPhy(cy_stc_ble_set_phy_info_t *param)
+{
+    host_event_t *event = NULL;
+    uint8_t phy = CY_BLE_PHY_MASK_LE_1M;
+
+    if((param->bdHandle >= CY_BLE_CONN_COUNT) || (links[param->bdHandle].connected == false))
+    {
+        return CY_BLE_ERROR_NO_DEVICE_ENTITY;
+    }
+
+    event = event_defer(CY_BLE_EVT_PHY_UPDATE_COMPLETE, param->bdHandle);
+    if(event == NULL)
+    {
+        return CY_BLE_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+
+    if(((param->txPhyMask & CY_BLE_PHY_MASK_LE_2M) != 0u) &&\
+       (links[param->bdHandle].peer.phy_2m == true))
+    {
+        phy = CY_BLE_PHY_MASK_LE_2M;
+    }
+
+    event->param.phy.phy.bdHandle = param->bdHandle;
+    event->param.phy.phy.txPhyMask = phy;
+    event->param.phy.phy.rxPhyMask = phy;
+    return CY_BLE_SUCCESS;
+}
+
+cy_en_ble_api_result_t Cy_BLE_GetPhy(uint8_t bdHandle)
+{
+    host_event_t *event = NULL;
+
+    if((bdHandle >= CY_BLE_CONN_COUNT) || (links[bdHandle].connected == false))
+    {
+        return CY_BLE_ERROR_NO_DEVICE_ENTITY;
+    }
+
+    event = event_defer(CY_BLE_EVT_GET_PHY_COMPLETE, bdHandle);
+    if(event == NULL)
+    {
+        return CY_BLE_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+
+    event->param.phy.phy.bdHandle = bdHandle;
+    event->param.phy.phy.txPhyMask = links[bdHandle].phy;
+    event->param.phy.phy.rxPhyMask = links[bdHandle].phy;
+    return CY_BLE_SUCCESS;
+}
+
+
+/*******************************************************************************
+* Function Name: Cy_BLE_SetDataLength
+********************************************************************************
+*
+* Summary:
+*   The link uses the smaller of the requested and the peer data length.
+*
+*******************************************************************************/
+cy_en_ble_api_result_t Cy_BLE_SetDataLength(cy_stc_ble_set_data_length_info_t *param)
+{
+    host_event_t *event = NULL;
+    uint16_t octets = param->connMaxTxOctets;
+
+    if((param->bdHandle >= CY_BLE_CONN_COUNT) || (links[param->bdHandle].connected == false))
+    {
+        return CY_BLE_ERROR_NO_DEVICE_ENTITY;
+    }
+
+    event = event_defer(CY_BLE_EVT_DATA_LENGTH_CHANGE, param->bdHandle);
+    if(event == NULL)
+    {
+        return CY_BLE_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+
+    if(octets > links[param->bdHandle].peer.max_tx_octets)
+    {
+        octets = links[param->bdHandle].peer.max_tx_octets;
+    }
+
+    event->param.dle.bdHandle = param->bdHandle;
+    event->param.dle.connMaxTxOctets = octets;
+    event->param.dle.connMaxRxOctets = octets;
+    event->param.dle.connMaxTxTime = param->connMaxTxTime;
+    event->param.dle.connMaxRxTime = param->connMaxTxTime;
+    return CY_BLE_SUCCESS;
+}
+
+
+/*******************************************************************************
+* Function Name: Cy_BLE_L2CAP_LeConnectionParamUpdateRequest
+********************************************************************************
+*
+* Summary:
+*   The peer accepts an interval no shorter than its minimum and then
+*   updates the connection.
+*
+*******************************************************************************/
+cy_en_ble_api_result_t Cy_BLE_L2CAP_LeConnectionParamUpdateRequest(
+        cy_stc_ble_gap_conn_update_param_info_t *param)
+{
+    host_event_t *event = NULL;
+    bool accepted = false;
+
+    if((param->bdHandle >= CY_BLE_CONN_COUNT) || (links[param->bdHandle].connected == false))
+    {
+        return CY_BLE_ERROR_NO_DEVICE_ENTITY;
+    }
+
+    accepted = (param->connIntvMax >= links[param->bdHandle].peer.min_interval);
+
+    event = event_defer(CY_BLE_EVT_L2CAP_CONN_PARAM_UPDATE_RSP, param->bdHandle);
+    if(event == NULL)
+    {
+        return CY_BLE_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    event->param.conn_rsp.bdHandle = param->bdHandle;
+    event->param.conn_rsp.result = (accepted == true) ? CONN_PARAM_ACCEPTED :\
+                                                        CONN_PARAM_REJECTED;
+
+    if(accepted == true)
+    {
+        event = event_defer(CY_BLE_EVT_GAP_CONNECTION_UPDATE_COMPLETE, param->bdHandle);
+        if(event != NULL)
+        {
+            /* The update takes effect after the response */
+            event->due += (uint32_t)links[param->bdHandle].interval * CONN_INTERVAL_UNIT_US;
+            event->param.conn_upd.bdHandle = param->bdHandle;
+            event->param.conn_upd.connIntv = param->connIntvMax;
+            event->param.conn_upd.connLatency = param->connLatency;
+            event->param.conn_upd.supervisionTO = param->supervisionTO;
+        }
+    }
+
+    return CY_BLE_SUCCESS;
+}
+
+cy_en_ble_api_result_t Cy_BLE_GATTS_WriteRsp(cy_stc_ble_conn_handle_t connHandle)
+{
+    write_rsp_received = true;
+    write_rsp_error = CY_BLE_GATT_ERR_NONE;
+    return CY_BLE_SUCCESS;
+}
+
+cy_en_ble_api_result_t Cy_BLE_GATTS_ErrorRsp(cy_stc_ble_gatt_err_param_t *param)
+{
+    write_rsp_received = true;
+    write_rsp_error = param->errInfo.errorCode;
+    return CY_BLE_SUCCESS;
+}
+
+
+/*******************************************************************************
+* Function Name: Cy_BLE_GATTS_WriteAttributeValuePeer
+********************************************************************************
+*
+* Summary:
+*   A CCCD value is kept per connection, any other value in the database.
+*
+*******************************************************************************/
+cy_en_ble_gatt_err_code_t Cy_BLE_GATTS_WriteAttributeValuePeer(
+        cy_stc_ble_conn_handle_t *connHandle,
+        cy_stc_ble_gatt_handle_value_pair_t *handleValuePair)
+{
+    uint16_t handle = handleValuePair->attrHandle;
+
+    if((handle >= CY_BLE_GATT_DB_MAX_HANDLE) || (connHandle->bdHandle >= CY_BLE_CONN_COUNT))
+    {
+        return CY_BLE_GATT_ERR_UNLIKELY_ERROR;
+    }
+
+    if(is_cccd(handle) == true)
+    {
+        links[connHandle->bdHandle].cccd[handle] = handleValuePair->value.val[0];
+        return CY_BLE_GATT_ERR_NONE;
+    }
+
+    return Cy_BLE_GATTS_WriteAttributeValueLocal(handleValuePair);
+}
+
+cy_en_ble_gatt_err_code_t Cy_BLE_GATTS_WriteAttributeValueLocal(
+        cy_stc_ble_gatt_handle_value_pair_t *handleValuePair)
+{
+    uint16_t handle = handleValuePair->attrHandle;
+
+    if((handle >= CY_BLE_GATT_DB_MAX_HANDLE) ||\
+       (handleValuePair->value.len > HOST_STACK_VALUE_SIZE))
+    {
+        return CY_BLE_GATT_ERR_INVALID_ATTRIBUTE_LEN;
+    }
+
+    memcpy(db_value[handle], handleValuePair->value.val, handleValuePair->value.len);
+    db_len[handle] = handleValuePair->value.len;
+    return CY_BLE_GATT_ERR_NONE;
+}
+
+cy_en_ble_gatt_err_code_t Cy_BLE_GATTS_WriteAttributeValueCCCD(
+        cy_stc_ble_gatts_db_attr_val_info_t *param)
+{
+    return Cy_BLE_GATTS_WriteAttributeValuePeer(&param->connHandle,\
+                                                &param->handleValuePair);
+}
+
+
+/*******************************************************************************
+* Function Name: Cy_BLE_GATTS_Notification
+********************************************************************************
+*
+* Summary:
+*   Queues a notification until the peer acknowledges it. It is refused if
+*   the client did not enable it, if it does not fit the ATT MTU or if the
+*   stack has no buffer left.
+*
+*******************************************************************************/
+cy_en_ble_api_result_t Cy_BLE_GATTS_Notification(
+        cy_stc_ble_gatts_handle_value_ntf_t *param)
+{
+    uint8_t bd_handle = param->connHandle.bdHandle;
+    host_link_t *link = NULL;
+    host_ntf_t *ntf = NULL;
+    uint16_t handle = param->handleValPair.attrHandle;
+
+    if((bd_handle >= CY_BLE_CONN_COUNT) || (links[bd_handle].connected == false))
+    {
+        return CY_BLE_ERROR_NO_DEVICE_ENTITY;
+    }
+
+    link = &links[bd_handle];
+    if((handle + 1u >= CY_BLE_GATT_DB_MAX_HANDLE) ||\
+       ((link->cccd[handle + 1u] & CY_BLE_CCCD_NOTIFICATION) == 0u))
+    {
+        return CY_BLE_ERROR_NTF_DISABLED;
+    }
+
+    if(param->handleValPair.value.len > (link->mtu - ATT_NTF_HEADER_SIZE))
+    {
+        return CY_BLE_ERROR_INVALID_PARAMETER;
+    }
+
+    if((stack_held_busy == true) || (link->queue_count == HOST_STACK_TX_BUFFERS))
+    {
+        link->stats.refused++;
+        return CY_BLE_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+
+    ntf = &link->queue[(link->queue_head + link->queue_count) % HOST_STACK_TX_BUFFERS];
+    ntf->attr_handle = handle;
+    ntf->len = param->handleValPair.value.len;
+    memcpy(ntf->value, param->handleValPair.value.val, ntf->len);
+    link->queue_count++;
+
+    /* The notified value is the characteristic value */
+    (void)Cy_BLE_GATTS_WriteAttributeValueLocal(&param->handleValPair);
+
+    return CY_BLE_SUCCESS;
+}
+
+uint32_t Cy_BLE_GATT_GetBusyStatus(uint8_t attId)
+{
+    if((attId >= CY_BLE_CONN_COUNT) || (links[attId].connected == false))
+    {
+        return CY_BLE_STACK_STATE_FREE;
+    }
+
+    return ((stack_held_busy == true) ||\
+            (links[attId].queue_count == HOST_STACK_TX_BUFFERS)) ?\
+           CY_BLE_STACK_STATE_BUSY : CY_BLE_STACK_STATE_FREE;
+}
+
+
+/*******************************************************************************
+ *                       HAL, PDL and CPU core
+ ******************************************************************************/
+
+cy_rslt_t cybsp_init(void)
+{
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cy_retarget_io_init(int tx, int rx, int baudrate)
+{
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cyhal_system_set_isr(int irq_num, int irq_src, uint8_t priority,
+                               void (*handler)(void))
+{
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cyhal_gpio_init(cyhal_gpio_t pin, int direction, int drive_mode,
+                          bool init_val)
+{
+    return CY_RSLT_SUCCESS;
+}
+
+void cyhal_gpio_write(cyhal_gpio_t pin, bool value)
+{
+}
+
+cy_rslt_t cyhal_timer_init(cyhal_timer_t *obj, int pin, const void *clk)
+{
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cyhal_timer_configure(cyhal_timer_t *obj, const cyhal_timer_cfg_t *cfg)
+{
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cyhal_timer_set_frequency(cyhal_timer_t *obj, uint32_t hz)
+{
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cyhal_timer_start(cyhal_timer_t *obj)
+{
+    return CY_RSLT_SUCCESS;
+}
+
+/* The time base of the firmware runs at 1 MHz */
+uint32_t cyhal_timer_read(const cyhal_timer_t *obj)
+{
+    return host_time_us;
+}
+
+uint32_t Cy_SysLib_EnterCriticalSection(void)
+{
+    return 0u;
+}
+
+void Cy_SysLib_ExitCriticalSection(uint32_t saved_intr_status)
+{
+}
+
+cy_en_syspm_status_t Cy_SysPm_CpuEnterSleep(cy_en_syspm_waitfor_t wait_for)
+{
+    return CY_SYSPM_SUCCESS;
+}
+
+void __enable_irq(void)
+{
+}
+
+void __disable_irq(void)
+{
+}
+
+uint32_t __get_PRIMASK(void)
+{
+    return 0u;
+}
+
+void __set_PRIMASK(uint32_t primask)
+{
+}
+
+void __DMB(void)
+{
+    __sync_synchronize();
+}
+
+void __WFI(void)
+{
+}
+
+uint32_t __CLZ(uint32_t value)
+{
+    return (value == 0u) ? 32u : (uint32_t)__builtin_clz(value);
+}
+
+void NVIC_ClearPendingIRQ(IRQn_Type irq)
+{
+}
+
+void NVIC_EnableIRQ(IRQn_Type irq)
+{
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,149 @@
+/******************************************************************************
+* File Name: host_stack.h
+*
+* Description: This file contains the interface of the host stand-in for the
+*              BLE stack: the simulated links to the GATT clients and the event
+*              injector that drives the stack event handler of
+*              tuner_ble_server.c.
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include guard
+ *****************************************************************************/
+#ifndef HOST_STACK_H_
+#define HOST_STACK_H_
+
+/******************************************************************************
+ * Include header files
+ *****************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "cycfg_ble.h"
+
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+/* Notification packets the stack holds per connection before it reports
+ * busy */
+#define HOST_STACK_TX_BUFFERS        (8u)
+
+/* Script steps, see host_step_t */
+#define HOST_STEP_CONNECT            (0u)   /* peer */
+#define HOST_STEP_DISCONNECT         (1u)   /* value: HCI reason */
+#define HOST_STEP_MTU                (2u)   /* value: ATT MTU */
+#define HOST_STEP_CCCD               (3u)   /* value: CCCD value */
+#define HOST_STEP_WRITE_REQ          (4u)   /* data, len */
+#define HOST_STEP_WRITE_CMD          (5u)   /* data, len */
+#define HOST_STEP_BUSY               (6u)   /* value: 1 holds the stack busy */
+
+
+/******************************************************************************
+ * Data Types
+ *****************************************************************************/
+/* GATT client side of a simulated connection: what it accepts during the
+ * link negotiation and how much the link carries */
+typedef struct
+{
+    uint16_t mtu;               /* ATT MTU the client requests */
+    uint16_t max_tx_octets;     /* Largest LL payload the client accepts */
+    bool phy_2m;                /* The client takes the 2M PHY */
+    uint16_t interval;          /* Interval at connection, 1.25 ms units */
+    uint16_t min_interval;      /* Shortest interval accepted, 1.25 ms units */
+    uint8_t pdus_per_event;     /* LL data PDUs per connection event */
+} host_peer_t;
+
+
+/* Step of an event script, run when the simulated time reaches time_us */
+typedef struct
+{
+    uint32_t time_us;
+    uint8_t op;                 /* HOST_STEP_* */
+    uint8_t bd_handle;
+    uint16_t attr_handle;
+    uint16_t value;
+    const host_peer_t *peer;
+    const uint8_t *data;
+    uint16_t len;
+} host_step_t;
+
+
+/* Counters of one simulated connection */
+typedef struct
+{
+    uint32_t notifications;     /* Notification packets delivered */
+    uint32_t bytes;             /* Notification values delivered */
+    uint32_t refused;           /* Notifications refused, stack busy */
+    uint32_t conn_events;       /* Connection events */
+} host_link_stats_t;
+
+
+/* Receives every notification when it goes over the air */
+typedef void (*host_stack_rx_t)(uint8_t bd_handle, uint16_t attr_handle,
+                                const uint8_t *value, uint16_t len);
+
+
+/******************************************************************************
+ * Function Prototypes
+ *****************************************************************************/
+void host_stack_reset(void);
+void host_stack_set_receiver(host_stack_rx_t receiver);
+uint32_t host_stack_time(void);
+uint32_t host_stack_advance(uint32_t us);
+
+void host_stack_connect(uint8_t bd_handle, const host_peer_t *peer);
+void host_stack_disconnect(uint8_t bd_handle, uint8_t reason);
+void host_stack_mtu(uint8_t bd_handle, uint16_t mtu);
+cy_en_ble_gatt_err_code_t host_stack_write_req(uint8_t bd_handle,
+                                               uint16_t attr_handle,
+                                               const uint8_t *data,
+                                               uint16_t len);
+void host_stack_write_cmd(uint8_t bd_handle, uint16_t attr_handle,
+                          const uint8_t *data, uint16_t len);
+cy_en_ble_gatt_err_code_t host_stack_cccd(uint8_t bd_handle,
+                                          uint16_t cccd_handle, bool enable);
+uint16_t host_stack_read(uint8_t bd_handle, uint16_t attr_handle,
+                         uint8_t *buffer, uint16_t capacity);
+void host_stack_set_busy(bool busy);
+void host_stack_script(const host_step_t *steps, uint16_t count);
+
+uint16_t host_stack_interval(uint8_t bd_handle);
+const host_link_stats_t *host_stack_link_stats(uint8_t bd_handle);
+
+
+#endif /* HOST_STACK_H_ */
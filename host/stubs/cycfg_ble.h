@@ -0,0 +1,364 @@
+/******************************************************************************
+* File Name: cycfg_ble.h
+*
+* Description: Host stand-in for the BLE stack headers and the generated GATT
+*              database header. Declares the subset of the stack API the
+*              firmware uses and the handles of the CapSense_Tuner service;
+*              host_stack.c implements the API.
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include guard
+ *****************************************************************************/
+#ifndef HOST_CYCFG_BLE_H_
+#define HOST_CYCFG_BLE_H_
+
+/******************************************************************************
+ * Include header files
+ *****************************************************************************/
+#include "cyhal.h"
+
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+/* GATT database configuration */
+#define CY_BLE_GATT_MTU                   (512u)
+#define CY_BLE_CONN_COUNT                 (2u)
+#define CY_BLE_BD_ADDR_SIZE               (6u)
+#define CY_BLE_INVALID_CONN_HANDLE_VALUE  (0xFFu)
+
+/* Attribute handles of the CapSense_Tuner service */
+#define CY_BLE_CAPSENSE_TUNER_CAPSENSE_DS_CHAR_HANDLE (0x0010u)
+#define CY_BLE_CAPSENSE_TUNER_CAPSENSE_DS_CLIENT_CHARACTERISTIC_CONFIGURATION_DESC_HANDLE (0x0011u)
+#define CY_BLE_CAPSENSE_TUNER_TUNER_COMMAND_CHAR_HANDLE (0x0013u)
+#define CY_BLE_CAPSENSE_TUNER_TUNER_REGIONS_CHAR_HANDLE (0x0015u)
+#define CY_BLE_CAPSENSE_TUNER_LINK_STATS_CHAR_HANDLE (0x0017u)
+#define CY_BLE_CAPSENSE_TUNER_LINK_STATS_CLIENT_CHARACTERISTIC_CONFIGURATION_DESC_HANDLE (0x0018u)
+#define CY_BLE_CAPSENSE_TUNER_TUNER_CONTROL_CHAR_HANDLE (0x001Au)
+#define CY_BLE_CAPSENSE_TUNER_TUNER_CONTROL_CLIENT_CHARACTERISTIC_CONFIGURATION_DESC_HANDLE (0x001Bu)
+#define CY_BLE_CAPSENSE_TUNER_TUNER_SAMPLES_CHAR_HANDLE (0x001Du)
+#define CY_BLE_CAPSENSE_TUNER_TUNER_SAMPLES_CLIENT_CHARACTERISTIC_CONFIGURATION_DESC_HANDLE (0x001Eu)
+#define CY_BLE_CAPSENSE_TUNER_TUNER_RANGE_CHAR_HANDLE (0x0020u)
+#define CY_BLE_CAPSENSE_TUNER_SENSOR_STATS_CHAR_HANDLE (0x0022u)
+#define CY_BLE_CAPSENSE_TUNER_SENSOR_STATS_CLIENT_CHARACTERISTIC_CONFIGURATION_DESC_HANDLE (0x0023u)
+#define CY_BLE_CAPSENSE_TUNER_TOUCH_EVENTS_CHAR_HANDLE (0x0025u)
+#define CY_BLE_CAPSENSE_TUNER_TOUCH_EVENTS_CLIENT_CHARACTERISTIC_CONFIGURATION_DESC_HANDLE (0x0026u)
+#define CY_BLE_GATT_DB_MAX_HANDLE         (0x0027u)
+
+#define CY_BLE_STACK_STATE_FREE           (0u)
+#define CY_BLE_STACK_STATE_BUSY           (1u)
+#define CY_BLE_ADVERTISING_FAST           (0u)
+#define CY_BLE_PERIPHERAL_CONFIGURATION_0_INDEX (0u)
+#define CY_BLE_PHY_NO_PREF_MASK_NONE      (0u)
+#define CY_BLE_PHY_MASK_LE_1M             (0x01u)
+#define CY_BLE_PHY_MASK_LE_2M             (0x02u)
+#define CY_BLE_GATT_DB_PEER_INITIATED     (0x40u)
+#define CY_BLE_GATT_DB_LOCALLY_INITIATED  (0x00u)
+#define CY_BLE_CCCD_NOTIFICATION          (0x01u)
+
+
+/******************************************************************************
+ * Data Types
+ *****************************************************************************/
+typedef enum
+{
+    CY_BLE_SUCCESS = 0,
+    CY_BLE_ERROR_INVALID_PARAMETER,
+    CY_BLE_ERROR_NO_DEVICE_ENTITY,
+    CY_BLE_ERROR_NTF_DISABLED,
+    CY_BLE_ERROR_INVALID_STATE,
+    CY_BLE_ERROR_MEMORY_ALLOCATION_FAILED,
+    CY_BLE_ERROR_GATT_DB_INVALID_ATTR_HANDLE
+} cy_en_ble_api_result_t;
+
+typedef enum
+{
+    CY_BLE_GATT_ERR_NONE = 0x00,
+    CY_BLE_GATT_ERR_READ_NOT_PERMITTED = 0x02,
+    CY_BLE_GATT_ERR_INVALID_OFFSET = 0x07,
+    CY_BLE_GATT_ERR_INVALID_ATTRIBUTE_LEN = 0x0D,
+    CY_BLE_GATT_ERR_UNLIKELY_ERROR = 0x0E
+} cy_en_ble_gatt_err_code_t;
+
+typedef enum
+{
+    CY_BLE_GATT_READ_REQ = 0x0A,
+    CY_BLE_GATT_WRITE_REQ = 0x12
+} cy_en_ble_gatt_pdu_t;
+
+typedef enum
+{
+    CY_BLE_ADV_STATE_STOPPED,
+    CY_BLE_ADV_STATE_ADVERTISING
+} cy_en_ble_adv_state_t;
+
+typedef enum
+{
+    CY_BLE_CONN_STATE_DISCONNECTED,
+    CY_BLE_CONN_STATE_CONNECTED
+} cy_en_ble_conn_state_t;
+
+/* Stack events */
+enum
+{
+    CY_BLE_EVT_STACK_ON = 1,
+    CY_BLE_EVT_TIMEOUT,
+    CY_BLE_EVT_STACK_BUSY_STATUS,
+    CY_BLE_EVT_GAPP_ADVERTISEMENT_START_STOP,
+    CY_BLE_EVT_GAP_DEVICE_CONNECTED,
+    CY_BLE_EVT_GAP_ENHANCE_CONN_COMPLETE,
+    CY_BLE_EVT_DATA_LENGTH_CHANGE,
+    CY_BLE_EVT_SET_DATA_LENGTH_COMPLETE,
+    CY_BLE_EVT_GAP_DEVICE_DISCONNECTED,
+    CY_BLE_EVT_PHY_UPDATE_COMPLETE,
+    CY_BLE_EVT_SET_PHY_COMPLETE,
+    CY_BLE_EVT_GET_PHY_COMPLETE,
+    CY_BLE_EVT_GAP_CONNECTION_UPDATE_COMPLETE,
+    CY_BLE_EVT_L2CAP_CONN_PARAM_UPDATE_RSP,
+    CY_BLE_EVT_GATT_CONNECT_IND,
+    CY_BLE_EVT_GATT_DISCONNECT_IND,
+    CY_BLE_EVT_GATTS_XCNHG_MTU_REQ,
+    CY_BLE_EVT_GATTS_WRITE_REQ,
+    CY_BLE_EVT_GATTS_WRITE_CMD_REQ,
+    CY_BLE_EVT_GATTS_READ_CHAR_VAL_ACCESS_REQ
+};
+
+typedef void (*cy_ble_callback_t)(uint32_t event, void *eventParam);
+
+typedef struct
+{
+    uint8_t bdHandle;
+    uint8_t attId;
+} cy_stc_ble_conn_handle_t;
+
+typedef struct
+{
+    uint8_t *val;
+    uint16_t len;
+    uint16_t actualLen;
+} cy_stc_ble_gatt_value_t;
+
+typedef struct
+{
+    cy_stc_ble_gatt_value_t value;
+    uint16_t attrHandle;
+} cy_stc_ble_gatt_handle_value_pair_t;
+
+typedef struct
+{
+    cy_stc_ble_conn_handle_t connHandle;
+    cy_stc_ble_gatt_handle_value_pair_t handleValPair;
+} cy_stc_ble_gatts_handle_value_ntf_t;
+
+typedef struct
+{
+    cy_stc_ble_conn_handle_t connHandle;
+    cy_stc_ble_gatt_handle_value_pair_t handleValPair;
+} cy_stc_ble_gatt_write_param_t;
+
+typedef struct
+{
+    cy_stc_ble_conn_handle_t connHandle;
+    cy_stc_ble_gatt_handle_value_pair_t handleValPair;
+} cy_stc_ble_gatts_write_cmd_req_param_t;
+
+typedef struct
+{
+    cy_stc_ble_conn_handle_t connHandle;
+    cy_stc_ble_gatt_handle_value_pair_t handleValuePair;
+    uint16_t offset;
+    uint8_t flags;
+} cy_stc_ble_gatts_db_attr_val_info_t;
+
+typedef struct
+{
+    cy_stc_ble_conn_handle_t connHandle;
+    uint16_t mtu;
+} cy_stc_ble_gatt_xchg_mtu_param_t;
+
+typedef struct
+{
+    cy_stc_ble_conn_handle_t connHandle;
+    uint16_t attrHandle;
+    cy_en_ble_gatt_err_code_t gattErrorCode;
+} cy_stc_ble_gatts_char_val_read_req_t;
+
+typedef struct
+{
+    cy_en_ble_gatt_pdu_t opCode;
+    uint16_t attrHandle;
+    cy_en_ble_gatt_err_code_t errorCode;
+} cy_stc_ble_gatt_err_info_t;
+
+typedef struct
+{
+    cy_stc_ble_gatt_err_info_t errInfo;
+    cy_stc_ble_conn_handle_t connHandle;
+} cy_stc_ble_gatt_err_param_t;
+
+typedef struct
+{
+    uint8_t status;
+    uint8_t bdHandle;
+    uint8_t peerBdAddr[CY_BLE_BD_ADDR_SIZE];
+    uint16_t connIntv;
+    uint16_t connLatency;
+    uint16_t supervisionTo;
+} cy_stc_ble_gap_enhance_conn_complete_param_t;
+
+typedef struct
+{
+    uint8_t bdHandle;
+    uint8_t reason;
+} cy_stc_ble_gap_disconnect_param_t;
+
+typedef struct
+{
+    uint8_t status;
+    void *eventParams;
+} cy_stc_ble_events_param_generic_t;
+
+typedef struct
+{
+    uint8_t bdHandle;
+    uint8_t txPhyMask;
+    uint8_t rxPhyMask;
+} cy_stc_ble_phy_param_t;
+
+typedef struct
+{
+    uint8_t bdHandle;
+    uint8_t allPhyMask;
+    uint8_t txPhyMask;
+    uint8_t rxPhyMask;
+    uint16_t phyOption;
+} cy_stc_ble_set_phy_info_t;
+
+typedef struct
+{
+    uint8_t bdHandle;
+    uint16_t connMaxTxOctets;
+    uint16_t connMaxTxTime;
+    uint16_t connMaxRxOctets;
+    uint16_t connMaxRxTime;
+} cy_stc_ble_data_length_param_t;
+
+typedef struct
+{
+    uint8_t bdHandle;
+    uint16_t connMaxTxOctets;
+    uint16_t connMaxTxTime;
+} cy_stc_ble_set_data_length_info_t;
+
+typedef struct
+{
+    uint16_t connIntvMin;
+    uint16_t connIntvMax;
+    uint16_t connLatency;
+    uint16_t supervisionTO;
+    uint8_t bdHandle;
+} cy_stc_ble_gap_conn_update_param_info_t;
+
+typedef struct
+{
+    uint8_t status;
+    uint8_t bdHandle;
+    uint16_t connIntv;
+    uint16_t connLatency;
+    uint16_t supervisionTO;
+} cy_stc_ble_gap_conn_param_updated_in_controller_t;
+
+typedef struct
+{
+    uint8_t bdHandle;
+    uint16_t result;
+} cy_stc_ble_l2cap_conn_update_rsp_param_t;
+
+typedef struct
+{
+    const cy_stc_sysint_t *blessIsrConfig;
+} cy_stc_ble_hw_config_t;
+
+typedef struct
+{
+    cy_stc_ble_hw_config_t *hw;
+} cy_stc_ble_config_t;
+
+
+/******************************************************************************
+ * Global variables
+ *****************************************************************************/
+extern cy_stc_ble_config_t cy_ble_config;
+
+
+/******************************************************************************
+ * Function Prototypes
+ *****************************************************************************/
+void Cy_BLE_BlessIsrHandler(void);
+cy_en_ble_api_result_t Cy_BLE_RegisterEventCallback(cy_ble_callback_t callbackFunc);
+cy_en_ble_api_result_t Cy_BLE_RegisterAppHostCallback(void (*callbackFunc)(void));
+cy_en_ble_api_result_t Cy_BLE_Init(cy_stc_ble_config_t *config);
+cy_en_ble_api_result_t Cy_BLE_Enable(void);
+void Cy_BLE_ProcessEvents(void);
+cy_en_ble_api_result_t Cy_BLE_GAPP_StartAdvertisement(uint8_t advertisingIntervalType,
+                                                      uint8_t advIndex);
+cy_en_ble_adv_state_t Cy_BLE_GetAdvertisementState(void);
+cy_en_ble_api_result_t Cy_BLE_GetLocalName(char *name);
+cy_en_ble_conn_state_t Cy_BLE_GetConnectionState(cy_stc_ble_conn_handle_t connHandle);
+uint8_t Cy_BLE_GetNumOfActiveConn(void);
+cy_en_ble_api_result_t Cy_BLE_SetPhy(cy_stc_ble_set_phy_info_t *param);
+cy_en_ble_api_result_t Cy_BLE_GetPhy(uint8_t bdHandle);
+cy_en_ble_api_result_t Cy_BLE_SetDataLength(cy_stc_ble_set_data_length_info_t *param);
+cy_en_ble_api_result_t Cy_BLE_L2CAP_LeConnectionParamUpdateRequest(
+        cy_stc_ble_gap_conn_update_param_info_t *param);
+cy_en_ble_api_result_t Cy_BLE_GATTS_WriteRsp(cy_stc_ble_conn_handle_t connHandle);
+cy_en_ble_api_result_t Cy_BLE_GATTS_ErrorRsp(cy_stc_ble_gatt_err_param_t *param);
+cy_en_ble_gatt_err_code_t Cy_BLE_GATTS_WriteAttributeValuePeer(
+        cy_stc_ble_conn_handle_t *connHandle,
+        cy_stc_ble_gatt_handle_value_pair_t *handleValuePair);
+cy_en_ble_gatt_err_code_t Cy_BLE_GATTS_WriteAttributeValueLocal(
+        cy_stc_ble_gatt_handle_value_pair_t *handleValuePair);
+cy_en_ble_gatt_err_code_t Cy_BLE_GATTS_WriteAttributeValueCCCD(
+        cy_stc_ble_gatts_db_attr_val_info_t *param);
+cy_en_ble_api_result_t Cy_BLE_GATTS_Notification(
+        cy_stc_ble_gatts_handle_value_ntf_t *param);
+uint32_t Cy_BLE_GATT_GetBusyStatus(uint8_t attId);
+
+
+#endif /* HOST_CYCFG_BLE_H_ */
@@ -0,0 +1,213 @@
+/******************************************************************************
+* File Name: cycfg_capsense.h
+*
+* Description: Host stand-in for the generated CapSense configuration header.
+*              The context types follow the CapSense middleware 2.x layout and
+*              the widgets follow the design of this example: a 5-segment CSD
+*              slider and two CSX buttons of two sensors each. host_capsense.c
+*              defines cy_capsense_tuner and simulates the scans.
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include guard
+ *****************************************************************************/
+#ifndef HOST_CYCFG_CAPSENSE_H_
+#define HOST_CYCFG_CAPSENSE_H_
+
+/******************************************************************************
+ * Include header files
+ *****************************************************************************/
+#include "cyhal.h"
+
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+/* The slider takes every sensor but the four of the buttons; the benchmark
+ * builds larger structures with more slider segments, see host/Makefile */
+#ifndef HOST_SENSOR_COUNT
+#define HOST_SENSOR_COUNT                 (9u)
+#endif
+
+#define CY_CAPSENSE_WIDGET_COUNT          (3u)
+#define CY_CAPSENSE_SENSOR_COUNT          (HOST_SENSOR_COUNT)
+#define CY_CAPSENSE_FREQ_CHANNELS_NUM     (1u)
+#define CY_CAPSENSE_POSITION_COUNT        (1u)
+
+#define CY_CAPSENSE_LINEARSLIDER0_WDGT_ID (0u)
+#define CY_CAPSENSE_BUTTON0_WDGT_ID       (1u)
+#define CY_CAPSENSE_BUTTON1_WDGT_ID       (2u)
+
+#define CY_CAPSENSE_NOT_BUSY              (0u)
+
+/* Tuner commands written to tunerCmd, see cy_en_capsense_tuner_cmd_t */
+#define CY_CAPSENSE_TU_CMD_NONE_E         (0u)
+#define CY_CAPSENSE_TU_CMD_SUSPEND_E      (1u)
+#define CY_CAPSENSE_TU_CMD_RESUME_E       (2u)
+#define CY_CAPSENSE_TU_CMD_RESTART_E      (3u)
+
+
+/******************************************************************************
+ * Data Types
+ *****************************************************************************/
+typedef struct
+{
+    uint16_t x;
+    uint16_t y;
+    uint16_t z;
+    uint16_t id;
+} cy_stc_capsense_position_t;
+
+typedef struct
+{
+    cy_stc_capsense_position_t *ptrPosition;
+    uint8_t numPosition;
+} cy_stc_capsense_touch_t;
+
+typedef struct
+{
+    uint16_t raw;
+    uint16_t bsln;
+    uint16_t diff;
+    uint8_t status;
+    uint8_t negBslnRstCnt;
+    uint8_t idacComp;
+    uint8_t bslnExt;
+} cy_stc_capsense_sensor_context_t;
+
+typedef struct
+{
+    uint16_t fingerCap;
+    uint16_t sigPFC;
+    uint16_t resolution;
+    uint16_t maxRawCount;
+    uint16_t fingerTh;
+    uint16_t proxTh;
+    uint16_t lowBslnRst;
+    uint16_t snsClk;
+    uint16_t rowSnsClk;
+    uint16_t gestureDetected;
+    uint16_t gestureDirection;
+    int16_t xDelta;
+    int16_t yDelta;
+    uint16_t noiseTh;
+    uint16_t nNoiseTh;
+    uint16_t hysteresis;
+    uint8_t onDebounce;
+    uint8_t snsClkSource;
+    uint8_t idacMod[CY_CAPSENSE_FREQ_CHANNELS_NUM];
+    uint8_t idacGainIndex;
+    uint8_t rowIdacMod[CY_CAPSENSE_FREQ_CHANNELS_NUM];
+    uint8_t bslnCoeff;
+    uint8_t status;
+    cy_stc_capsense_touch_t wdTouch;
+} cy_stc_capsense_widget_context_t;
+
+struct cy_stc_active_scan_sns;
+typedef struct cy_stc_active_scan_sns cy_stc_active_scan_sns_t;
+typedef void (*cy_capsense_callback_t)(cy_stc_active_scan_sns_t *ptrActiveScan);
+typedef void (*cy_capsense_tuner_send_callback_t)(void *context);
+typedef void (*cy_capsense_tuner_receive_callback_t)(uint8_t **commandPacket,
+                                                     uint8_t **tunerPacket,
+                                                     void *context);
+
+typedef struct
+{
+    uint16_t configId;
+    uint16_t tunerCmd;
+    uint16_t scanCounter;
+    uint8_t tunerSt;
+    uint8_t initDone;
+    cy_capsense_callback_t ptrSSCallback;
+    cy_capsense_callback_t ptrEOSCallback;
+    cy_capsense_tuner_send_callback_t ptrTunerSendCallback;
+    cy_capsense_tuner_receive_callback_t ptrTunerReceiveCallback;
+    volatile uint32_t status;
+    uint32_t timestampInterval;
+    uint32_t timestamp;
+    uint8_t modCsdClk;
+    uint8_t modCsxClk;
+    uint8_t tunerCnt;
+} cy_stc_capsense_common_context_t;
+
+typedef struct
+{
+    cy_stc_capsense_widget_context_t *ptrWdContext;
+    cy_stc_capsense_sensor_context_t *ptrSnsContext;
+    uint16_t numSns;
+    uint8_t wdType;
+    uint8_t senseMethod;
+} cy_stc_capsense_widget_config_t;
+
+typedef struct
+{
+    uint16_t numWd;
+    uint16_t numSns;
+} cy_stc_capsense_common_config_t;
+
+typedef struct
+{
+    const cy_stc_capsense_common_config_t *ptrCommonConfig;
+    cy_stc_capsense_common_context_t *ptrCommonContext;
+    const cy_stc_capsense_widget_config_t *ptrWdConfig;
+} cy_stc_capsense_context_t;
+
+typedef struct
+{
+    cy_stc_capsense_common_context_t commonContext;
+    cy_stc_capsense_widget_context_t widgetContext[CY_CAPSENSE_WIDGET_COUNT];
+    cy_stc_capsense_sensor_context_t sensorContext[CY_CAPSENSE_SENSOR_COUNT];
+    cy_stc_capsense_position_t position_LinearSlider0[CY_CAPSENSE_POSITION_COUNT];
+} cy_stc_capsense_tuner_t;
+
+
+/******************************************************************************
+ * Global variables
+ *****************************************************************************/
+extern cy_stc_capsense_tuner_t cy_capsense_tuner;
+extern cy_stc_capsense_context_t cy_capsense_context;
+
+
+/******************************************************************************
+ * Function Prototypes
+ *****************************************************************************/
+void Cy_CapSense_InitializeWidgetBaseline(uint32_t widgetId,
+                                          cy_stc_capsense_context_t *context);
+
+
+#endif /* HOST_CYCFG_CAPSENSE_H_ */
@@ -0,0 +1,172 @@
+/******************************************************************************
+* File Name: cyhal.h
+*
+* Description: Host stand-in for the HAL and CMSIS headers used by the tuner
+*              firmware. Declares the subset of types and functions the
+*              firmware sources use; host_stack.c implements them on a
+*              simulated clock.
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include guard
+ *****************************************************************************/
+#ifndef HOST_CYHAL_H_
+#define HOST_CYHAL_H_
+
+/******************************************************************************
+ * Include header files
+ *****************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+#define CY_RSLT_SUCCESS              (0u)
+#define CYRET_SUCCESS                (0u)
+#define CY_ASSERT(x)                 ((void)(x))
+
+#define CYHAL_GPIO_DIR_OUTPUT        (0)
+#define CYHAL_GPIO_DRIVE_STRONG      (0)
+#define NC                           (-1)
+
+#define DWT_CTRL_CYCCNTENA_Msk       (1u)
+#define CoreDebug_DEMCR_TRCENA_Msk   (1u << 24)
+
+
+/******************************************************************************
+ * Data Types
+ *****************************************************************************/
+typedef uint32_t cy_rslt_t;
+typedef uint32_t cy_status;
+typedef int cyhal_gpio_t;
+typedef int IRQn_Type;
+
+typedef struct
+{
+    IRQn_Type intrSrc;
+    uint32_t intrPriority;
+} cy_stc_sysint_t;
+
+typedef enum
+{
+    CY_SYSPM_SUCCESS
+} cy_en_syspm_status_t;
+
+typedef enum
+{
+    CY_SYSPM_WAIT_FOR_INTERRUPT,
+    CY_SYSPM_WAIT_FOR_EVENT
+} cy_en_syspm_waitfor_t;
+
+typedef struct
+{
+    int channel;
+} cyhal_timer_t;
+
+typedef enum
+{
+    CYHAL_TIMER_DIR_UP,
+    CYHAL_TIMER_DIR_DOWN
+} cyhal_timer_direction_t;
+
+typedef struct
+{
+    bool is_continuous;
+    cyhal_timer_direction_t direction;
+    bool is_compare;
+    uint32_t period;
+    uint32_t compare_value;
+    uint32_t value;
+} cyhal_timer_cfg_t;
+
+typedef struct
+{
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct
+{
+    volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+
+/******************************************************************************
+ * Global variables
+ *****************************************************************************/
+extern uint32_t SystemCoreClock;
+extern DWT_Type *DWT;
+extern CoreDebug_Type *CoreDebug;
+
+
+/******************************************************************************
+ * Function Prototypes
+ *****************************************************************************/
+cy_rslt_t cyhal_system_set_isr(int irq_num, int irq_src, uint8_t priority,
+                               void (*handler)(void));
+cy_rslt_t cyhal_gpio_init(cyhal_gpio_t pin, int direction, int drive_mode,
+                          bool init_val);
+void cyhal_gpio_write(cyhal_gpio_t pin, bool value);
+cy_rslt_t cyhal_timer_init(cyhal_timer_t *obj, int pin, const void *clk);
+cy_rslt_t cyhal_timer_configure(cyhal_timer_t *obj,
+                                const cyhal_timer_cfg_t *cfg);
+cy_rslt_t cyhal_timer_set_frequency(cyhal_timer_t *obj, uint32_t hz);
+cy_rslt_t cyhal_timer_start(cyhal_timer_t *obj);
+uint32_t cyhal_timer_read(const cyhal_timer_t *obj);
+
+uint32_t Cy_SysLib_EnterCriticalSection(void);
+void Cy_SysLib_ExitCriticalSection(uint32_t saved_intr_status);
+cy_en_syspm_status_t Cy_SysPm_CpuEnterSleep(cy_en_syspm_waitfor_t wait_for);
+
+void __enable_irq(void);
+void __disable_irq(void);
+uint32_t __get_PRIMASK(void);
+void __set_PRIMASK(uint32_t primask);
+void __DMB(void);
+void __WFI(void);
+uint32_t __CLZ(uint32_t value);
+void NVIC_ClearPendingIRQ(IRQn_Type irq);
+void NVIC_EnableIRQ(IRQn_Type irq);
+
+
+#endif /* HOST_CYHAL_H_ */
@@ -0,0 +1,86 @@
+/******************************************************************************
+* File Name: host_test.h
+*
+* Description: This file contains the checks shared by the host tests. Each
+*              test is one program that counts its failed checks and exits with
+*              a non-zero status if any failed.
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include guard
+ *****************************************************************************/
+#ifndef HOST_TEST_H_
+#define HOST_TEST_H_
+
+/******************************************************************************
+ * Include header files
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdint.h>
+
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+/* Counts a failed check and reports where it is */
+#define TEST_CHECK(cond)                                                     \
+    do                                                                       \
+    {                                                                        \
+        test_checks++;                                                       \
+        if(!(cond))                                                          \
+        {                                                                    \
+            test_failures++;                                                 \
+            fprintf(stderr, "FAIL %s:%d: %s\r\n", __FILE__, __LINE__, #cond);\
+        }                                                                    \
+    } while(0)
+
+/* Reports the checks of the program; its exit status */
+#define TEST_RESULT(name)                                                    \
+    ((fprintf(stderr, "%s: %u checks, %u failed\r\n", (name),                \
+              (unsigned)test_checks, (unsigned)test_failures),               \
+      (test_failures == 0u)) ? 0 : 1)
+
+
+/******************************************************************************
+ * Global variables
+ *****************************************************************************/
+static uint32_t test_checks = 0;
+static uint32_t test_failures = 0;
+
+
+#endif /* HOST_TEST_H_ */
@@ -0,0 +1,299 @@
+/******************************************************************************
+* File Name: host_test_image.c
+*
+* Description: This file contains the snapshot helpers shared by the host tests
+*              that stream the CapSense data structure. A test registers
+*              host_test_snapshot() as the firmware hook and checks each image
+*              its client rebuilds with host_test_image_match().
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <string.h>
+#include "host_test_image.h"
+#include "host_firmware.h"
+
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* A finger moves to the next sensor every 23 scans */
+#define TOUCH_PERIOD_SCANS           (23u)
+
+
+/*******************************************************************************
+ * Global variables
+ ******************************************************************************/
+static uint8_t history[HOST_TEST_HISTORY_LENGTH][HOST_TEST_IMAGE_SIZE];
+static uint32_t history_count = 0;
+
+/* Windows the clients subscribe to, as written to Tuner_Regions */
+static uint16_t region_offset[HOST_TEST_REGIONS_MAX];
+static uint16_t region_length[HOST_TEST_REGIONS_MAX];
+static uint8_t region_count = 0;
+
+
+/*******************************************************************************
+* Function Name: host_test_snapshot
+********************************************************************************
+*
+* Summary:
+*   Keeps the structure as the tuner saw it after each scan. Set as the hook
+*   of host_firmware.c.
+*
+*******************************************************************************/
+void host_test_snapshot(void)
+{
+    memcpy(history[history_count % HOST_TEST_HISTORY_LENGTH], &cy_capsense_tuner,\
+           HOST_TEST_IMAGE_SIZE);
+    history_count++;
+}
+
+
+/*******************************************************************************
+* Function Name: host_test_scans
+********************************************************************************
+*
+* Summary:
+*   Returns the number of snapshots taken.
+*
+*******************************************************************************/
+uint32_t host_test_scans(void)
+{
+    return history_count;
+}
+
+
+/*******************************************************************************
+* Function Name: host_test_history
+********************************************************************************
+*
+* Summary:
+*   Returns the snapshot of a scan. Only the last HOST_TEST_HISTORY_LENGTH
+*   snapshots are kept.
+*
+* Parameters:
+*  uint32_t scan : Number of the snapshot, from 0
+*
+*******************************************************************************/
+const uint8_t *host_test_history(uint32_t scan)
+{
+    return history[scan % HOST_TEST_HISTORY_LENGTH];
+}
+
+
+/*******************************************************************************
+* Function Name: host_test_region_add
+********************************************************************************
+*
+* Summary:
+*   Adds a window of the structure to the list written to Tuner_Regions.
+*
+*******************************************************************************/
+void host_test_region_add(uint16_t offset, uint16_t length)
+{
+    if(region_count < HOST_TEST_REGIONS_MAX)
+    {
+        region_offset[region_count] = offset;
+        region_length[region_count] = length;
+        region_count++;
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: host_test_regions_pack
+********************************************************************************
+*
+* Summary:
+*   Writes the windows as the value of a Tuner_Regions write.
+*
+* Parameters:
+*  uint8_t *buffer : Buffer of HOST_TEST_REGIONS_MAX records
+*
+* Return:
+*   Length of the value
+*
+*******************************************************************************/
+uint16_t host_test_regions_pack(uint8_t *buffer)
+{
+    for(uint8_t i = 0; i < region_count; i++)
+    {
+        buffer[(i * HOST_TEST_REGION_RECORD_SIZE) + 0u] = (uint8_t)region_offset[i];
+        buffer[(i * HOST_TEST_REGION_RECORD_SIZE) + 1u] = (uint8_t)(region_offset[i] >> 8);
+        buffer[(i * HOST_TEST_REGION_RECORD_SIZE) + 2u] = (uint8_t)region_length[i];
+        buffer[(i * HOST_TEST_REGION_RECORD_SIZE) + 3u] = (uint8_t)(region_length[i] >> 8);
+    }
+
+    return (uint16_t)(region_count * HOST_TEST_REGION_RECORD_SIZE);
+}
+
+
+/*******************************************************************************
+* Function Name: host_test_regions_size
+********************************************************************************
+*
+* Summary:
+*   Returns the size of the image the windows stream.
+*
+*******************************************************************************/
+uint16_t host_test_regions_size(void)
+{
+    uint16_t size = 0;
+
+    for(uint8_t i = 0; i < region_count; i++)
+    {
+        size += region_length[i];
+    }
+
+    return size;
+}
+
+
+/*******************************************************************************
+* Function Name: host_test_image_extract
+********************************************************************************
+*
+* Summary:
+*   Builds a streamed image from a snapshot: the whole structure, or the
+*   windows back to back.
+*
+* Parameters:
+*  const uint8_t *src : Snapshot of the structure
+*  uint8_t *dst       : Buffer of HOST_TEST_IMAGE_SIZE bytes
+*  uint16_t image_size: Size of the streamed image; HOST_TEST_IMAGE_SIZE
+*                       stands for the whole structure
+*
+* Return:
+*   Size of the image
+*
+*******************************************************************************/
+uint16_t host_test_image_extract(const uint8_t *src, uint8_t *dst,
+                                 uint16_t image_size)
+{
+    uint16_t len = 0;
+
+    if(image_size == HOST_TEST_IMAGE_SIZE)
+    {
+        memcpy(dst, src, HOST_TEST_IMAGE_SIZE);
+        return HOST_TEST_IMAGE_SIZE;
+    }
+
+    for(uint8_t i = 0; i < region_count; i++)
+    {
+        memcpy(&dst[len], &src[region_offset[i]], region_length[i]);
+        len += region_length[i];
+    }
+
+    return len;
+}
+
+
+/*******************************************************************************
+* Function Name: host_test_image_match
+********************************************************************************
+*
+* Summary:
+*   Looks for a rebuilt image among the snapshots, from the newest back to
+*   the one the previous image of the client matched. Frames arrive in
+*   order, so an image older than that is a mismatch too.
+*
+* Parameters:
+*  const uint8_t *image  : Image rebuilt by the client
+*  uint16_t image_size   : Size of the image
+*  uint32_t *matched_scan: Snapshot the previous image matched; updated
+*
+* Return:
+*   true if the image is one of the snapshots
+*
+*******************************************************************************/
+bool host_test_image_match(const uint8_t *image, uint16_t image_size,
+                           uint32_t *matched_scan)
+{
+    uint8_t expected[HOST_TEST_IMAGE_SIZE];
+    uint32_t first = (history_count > HOST_TEST_HISTORY_LENGTH) ?\
+                     (history_count - HOST_TEST_HISTORY_LENGTH) : 0u;
+
+    if(*matched_scan > first)
+    {
+        first = *matched_scan;
+    }
+
+    for(uint32_t scan = history_count; scan > first; scan--)
+    {
+        if((host_test_image_extract(host_test_history(scan - 1u), expected,\
+                                    image_size) == image_size) &&\
+           (memcmp(expected, image, image_size) == 0))
+        {
+            *matched_scan = scan - 1u;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+/*******************************************************************************
+* Function Name: host_test_touch_pattern
+********************************************************************************
+*
+* Summary:
+*   Runs the firmware while fingers move over the slider and the buttons.
+*
+* Parameters:
+*  uint32_t scans : Scans of every widget to run
+*
+*******************************************************************************/
+void host_test_touch_pattern(uint32_t scans)
+{
+    uint32_t sensor = 0;
+
+    for(uint32_t i = 0; i < scans; i += TOUCH_PERIOD_SCANS)
+    {
+        sensor = (i / TOUCH_PERIOD_SCANS) % CY_CAPSENSE_SENSOR_COUNT;
+        host_firmware_touch(sensor, true);
+        host_firmware_run(TOUCH_PERIOD_SCANS / 2u);
+        host_firmware_touch(sensor, false);
+        host_firmware_run(TOUCH_PERIOD_SCANS - (TOUCH_PERIOD_SCANS / 2u));
+    }
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,92 @@
+/******************************************************************************
+* File Name: host_test_image.h
+*
+* Description: This file contains the interface of the snapshot helpers shared
+*              by the host tests that stream the CapSense data structure: the
+*              history of the structure after each scan, the windows a client
+*              subscribes to, and the touch pattern the tests run.
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include guard
+ *****************************************************************************/
+#ifndef HOST_TEST_IMAGE_H_
+#define HOST_TEST_IMAGE_H_
+
+/******************************************************************************
+ * Include header files
+ *****************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "cycfg_capsense.h"
+
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+#define HOST_TEST_IMAGE_SIZE         (sizeof(cy_capsense_tuner))
+
+/* Snapshots of the structure taken after each Cy_CapSense_RunTuner() */
+#define HOST_TEST_HISTORY_LENGTH     (256u)
+
+/* Windows of a Tuner_Regions write; each record is a 2-byte offset and a
+ * 2-byte length, LSB first */
+#define HOST_TEST_REGIONS_MAX        (16u)
+#define HOST_TEST_REGION_RECORD_SIZE (4u)
+
+
+/******************************************************************************
+ * Function Prototypes
+ *****************************************************************************/
+void host_test_snapshot(void);
+uint32_t host_test_scans(void);
+const uint8_t *host_test_history(uint32_t scan);
+
+void host_test_region_add(uint16_t offset, uint16_t length);
+uint16_t host_test_regions_pack(uint8_t *buffer);
+uint16_t host_test_regions_size(void);
+
+uint16_t host_test_image_extract(const uint8_t *src, uint8_t *dst,
+                                 uint16_t image_size);
+bool host_test_image_match(const uint8_t *image, uint16_t image_size,
+                           uint32_t *matched_scan);
+
+void host_test_touch_pattern(uint32_t scans);
+
+
+#endif /* HOST_TEST_IMAGE_H_ */
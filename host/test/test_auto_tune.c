@@ -0,0 +1,282 @@
+/******************************************************************************
+* File Name: test_auto_tune.c
+*
+* Description: This file contains the test of the fields the CapSense
+*              middleware changes by itself. With SmartSense, the middleware
+*              sets the thresholds of a widget from its signal and calibrates
+*              the widgets again, which picks new sense clocks and IDACs. A
+*              GATT Client that streams only these fields has to see each
+*              change without any tuner write.
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <string.h>
+#include <stddef.h>
+#include "host_test.h"
+#include "host_test_image.h"
+#include "host_stack.h"
+#include "host_firmware.h"
+#include "tuner_client.h"
+#include "tuner_layout.h"
+#include "cycfg_capsense.h"
+#include "cycfg_ble.h"
+
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define IMAGE_SIZE                   (HOST_TEST_IMAGE_SIZE)
+
+#define FEATURE_COMMAND_ID           (0xF0u)
+#define FEATURE_COMPRESSION          (0x01u)
+
+/* Windows of each widget: fingerTh to snsClk, noiseTh to hysteresis, and
+ * idacMod; and the idacComp of each button sensor */
+#define WIDGET_REGIONS               (3u)
+#define BUTTON_SENSORS               (4u)
+
+/* A scan of every widget is 6 ms; 500 scans are 3 seconds */
+#define PHASE_SCANS                  (500u)
+#define SEED                         (4242u)
+#define HCI_REMOTE_USER_TERMINATED   (0x13u)
+
+#define WIDGET_OFFSET(widget, member)\
+    ((uint16_t)(offsetof(cy_stc_capsense_tuner_t, widgetContext) +\
+                ((widget) * sizeof(cy_stc_capsense_widget_context_t)) +\
+                offsetof(cy_stc_capsense_widget_context_t, member)))
+#define SENSOR_OFFSET(sensor, member)\
+    ((uint16_t)(offsetof(cy_stc_capsense_tuner_t, sensorContext) +\
+                ((sensor) * sizeof(cy_stc_capsense_sensor_context_t)) +\
+                offsetof(cy_stc_capsense_sensor_context_t, member)))
+
+
+/*******************************************************************************
+ * Global variables
+ ******************************************************************************/
+static tuner_client_t client;
+static uint8_t client_image[IMAGE_SIZE];
+static uint8_t client_payload[IMAGE_SIZE + IMAGE_SIZE];
+static uint32_t frames = 0;
+static uint32_t mismatches = 0;
+static uint32_t matched_scan = 0;
+
+/* Scans that changed a tuned field, with no tuner write */
+static uint32_t tuned_changes = 0;
+
+static const host_peer_t peer =
+{
+    .mtu = 247u, .max_tx_octets = 251u, .phy_2m = true,
+    .interval = 24u, .min_interval = 6u, .pdus_per_event = 6u
+};
+
+static const uint8_t feature_command[] = { FEATURE_COMMAND_ID, FEATURE_COMPRESSION };
+
+
+/*******************************************************************************
+ * Function Prototypes
+*******************************************************************************/
+static void snapshot_hook(void);
+static void receive(uint8_t bd_handle, uint16_t attr_handle,
+                    const uint8_t *value, uint16_t len);
+
+
+/*******************************************************************************
+* Function Name: snapshot_hook
+********************************************************************************
+*
+* Summary:
+*   Counts the scans that changed a tuned field, and keeps the structure as
+*   the tuner saw it after each scan.
+*
+*******************************************************************************/
+static void snapshot_hook(void)
+{
+    uint8_t previous[IMAGE_SIZE];
+    uint8_t current[IMAGE_SIZE];
+    uint16_t size = host_test_regions_size();
+
+    if(host_test_scans() != 0u)
+    {
+        (void)host_test_image_extract(host_test_history(host_test_scans() - 1u),\
+                                      previous, size);
+        (void)host_test_image_extract((const uint8_t *)&cy_capsense_tuner, current, size);
+        if(memcmp(previous, current, size) != 0)
+        {
+            tuned_changes++;
+        }
+    }
+
+    host_test_snapshot();
+}
+
+
+/*******************************************************************************
+* Function Name: receive
+********************************************************************************
+*
+* Summary:
+*   Feeds the CapSense_DS notifications to the client; each rebuilt image
+*   has to be one of the snapshots, no older than the previous match.
+*
+*******************************************************************************/
+static void receive(uint8_t bd_handle, uint16_t attr_handle,
+                    const uint8_t *value, uint16_t len)
+{
+    if((attr_handle != CY_BLE_CAPSENSE_TUNER_CAPSENSE_DS_CHAR_HANDLE) ||\
+       (tuner_client_receive(&client, value, len) != TUNER_CLIENT_FRAME))
+    {
+        return;
+    }
+
+    frames++;
+    if(host_test_image_match(client_image, client.image_size, &matched_scan) == false)
+    {
+        mismatches++;
+    }
+}
+
+
+int main(void)
+{
+    static const uint16_t tuned_widget_fields[] =
+    {
+        offsetof(cy_stc_capsense_widget_context_t, fingerTh),
+        offsetof(cy_stc_capsense_widget_context_t, resolution),
+        offsetof(cy_stc_capsense_widget_context_t, snsClk),
+        offsetof(cy_stc_capsense_widget_context_t, rowSnsClk),
+        offsetof(cy_stc_capsense_widget_context_t, noiseTh),
+        offsetof(cy_stc_capsense_widget_context_t, nNoiseTh),
+        offsetof(cy_stc_capsense_widget_context_t, hysteresis),
+        offsetof(cy_stc_capsense_widget_context_t, snsClkSource),
+        offsetof(cy_stc_capsense_widget_context_t, idacMod),
+        offsetof(cy_stc_capsense_widget_context_t, idacGainIndex),
+        offsetof(cy_stc_capsense_widget_context_t, rowIdacMod),
+    };
+    uint8_t regions[HOST_TEST_REGIONS_MAX * HOST_TEST_REGION_RECORD_SIZE];
+    uint16_t regions_len = 0;
+    uint16_t field_start = 0;
+    uint16_t field_size = 0;
+    uint16_t offset = 0;
+    uint8_t cls = 0;
+
+    /* The fields SmartSense and calibration change stay writable, but can
+     * change with any scan */
+    for(uint32_t widget = 0; widget < CY_CAPSENSE_WIDGET_COUNT; widget++)
+    {
+        for(uint8_t i = 0; i < (sizeof(tuned_widget_fields) / sizeof(tuned_widget_fields[0])); i++)
+        {
+            offset = (uint16_t)(WIDGET_OFFSET(widget, fingerCap) + tuned_widget_fields[i]);
+            cls = tuner_layout_class(offset, &field_start, &field_size);
+            TEST_CHECK((cls & TUNER_LAYOUT_VOLATILE) != 0u);
+            TEST_CHECK((cls & TUNER_LAYOUT_WRITABLE) != 0u);
+            TEST_CHECK(tuner_layout_is_static(offset, 1u) == false);
+        }
+    }
+    for(uint32_t sensor = 0; sensor < CY_CAPSENSE_SENSOR_COUNT; sensor++)
+    {
+        offset = SENSOR_OFFSET(sensor, idacComp);
+        cls = tuner_layout_class(offset, &field_start, &field_size);
+        TEST_CHECK(cls == (TUNER_LAYOUT_VOLATILE | TUNER_LAYOUT_WRITABLE | TUNER_LAYOUT_REINIT));
+    }
+
+    /* Stream only the tuned fields while the middleware tunes itself */
+    for(uint32_t widget = 0; widget < CY_CAPSENSE_WIDGET_COUNT; widget++)
+    {
+        host_test_region_add(WIDGET_OFFSET(widget, fingerTh),\
+                             (uint16_t)(WIDGET_OFFSET(widget, rowSnsClk) - WIDGET_OFFSET(widget, fingerTh)));
+        host_test_region_add(WIDGET_OFFSET(widget, noiseTh),\
+                             (uint16_t)(WIDGET_OFFSET(widget, onDebounce) - WIDGET_OFFSET(widget, noiseTh)));
+        host_test_region_add(WIDGET_OFFSET(widget, idacMod), 1u);
+    }
+    for(uint32_t sensor = CY_CAPSENSE_SENSOR_COUNT - BUTTON_SENSORS;
+        sensor < CY_CAPSENSE_SENSOR_COUNT; sensor++)
+    {
+        host_test_region_add(SENSOR_OFFSET(sensor, idacComp), 1u);
+    }
+    regions_len = host_test_regions_pack(regions);
+
+    host_stack_set_receiver(receive);
+    host_firmware_set_hook(snapshot_hook);
+    host_firmware_set_auto_tune(true);
+    host_firmware_init(SEED);
+    tuner_client_init(&client, client_image, sizeof(client_image),\
+                      client_payload, sizeof(client_payload));
+
+    host_stack_connect(0u, &peer);
+    TEST_CHECK(host_stack_write_req(0u, CY_BLE_CAPSENSE_TUNER_TUNER_REGIONS_CHAR_HANDLE,\
+               regions, regions_len) == CY_BLE_GATT_ERR_NONE);
+    TEST_CHECK(host_stack_cccd(0u,\
+               CY_BLE_CAPSENSE_TUNER_CAPSENSE_DS_CLIENT_CHARACTERISTIC_CONFIGURATION_DESC_HANDLE,\
+               true) == CY_BLE_GATT_ERR_NONE);
+    host_test_touch_pattern(PHASE_SCANS);
+
+    TEST_CHECK(client.initialized == true);
+    TEST_CHECK(client.image_size == host_test_regions_size());
+    TEST_CHECK(tuned_changes > 10u);
+    TEST_CHECK(frames > 10u);
+    TEST_CHECK(mismatches == 0u);
+    TEST_CHECK(host_firmware_baseline_inits(CY_CAPSENSE_LINEARSLIDER0_WDGT_ID) == 0u);
+
+    /* The last image must have caught up with the structure */
+    (void)host_test_image_extract((const uint8_t *)&cy_capsense_tuner, client_payload,\
+                                  client.image_size);
+    TEST_CHECK(memcmp(client_image, client_payload, client.image_size) == 0);
+
+    /* The same with delta and zero run-length encoded frames */
+    host_stack_write_cmd(0u, CY_BLE_CAPSENSE_TUNER_TUNER_COMMAND_CHAR_HANDLE,\
+                         feature_command, sizeof(feature_command));
+    frames = 0;
+    tuned_changes = 0;
+    host_test_touch_pattern(PHASE_SCANS);
+
+    TEST_CHECK(tuned_changes > 10u);
+    TEST_CHECK(frames > 10u);
+    TEST_CHECK(mismatches == 0u);
+    (void)host_test_image_extract((const uint8_t *)&cy_capsense_tuner, client_payload,\
+                                  client.image_size);
+    TEST_CHECK(memcmp(client_image, client_payload, client.image_size) == 0);
+
+    host_stack_disconnect(0u, HCI_REMOTE_USER_TERMINATED);
+
+    return TEST_RESULT("test_auto_tune");
+}
+
+
+/* [] END OF FILE */
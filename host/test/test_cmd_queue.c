@@ -0,0 +1,397 @@
+/******************************************************************************
+* File Name: test_cmd_queue.c
+*
+* Description: This file contains the test of the Tuner command queue. It fills
+*              the queue, wraps its indexes past the queue length, checks that
+*              the entries come out in the order they were published, and that
+*              a batch packet the queue cannot take is dropped as a whole. A
+*              suspend command must bypass the queue, and the resume command
+*              must end the suspension. Connection events must reach the main
+*              loop through the queue, in the entries the writes leave free.
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <string.h>
+#include <stddef.h>
+#include "host_test.h"
+#include "host_stack.h"
+#include "host_firmware.h"
+#include "tuner_cmd_queue.h"
+#include "tuner_transport.h"
+#include "cycfg_capsense.h"
+#include "cycfg_ble.h"
+
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Batch packet: command byte, then records of offset (MSB first), size and
+ * data; 101 records of a 2-byte field fill a 509-byte packet */
+#define BATCH_COMMAND_ID             (0xB0u)
+#define BATCH_RECORD_SIZE            (5u)
+#define BATCH_RECORDS                (101u)
+#define BATCH_SIZE                   (1u + (BATCH_RECORDS * BATCH_RECORD_SIZE))
+#define BATCH_RECORDS_SIZE(records)  (1u + ((records) * BATCH_RECORD_SIZE))
+
+/* Entries the writes leave for the connection events, see
+ * tuner_transport.c, and the records that fill the queue up to them after
+ * a full batch packet */
+#define EVENT_RESERVE                (2u * TUNER_MAX_SESSIONS)
+#define RESERVE_RECORDS              (TUNER_CMD_QUEUE_LENGTH - BATCH_RECORDS - EVENT_RESERVE)
+
+/* Entries published and popped per round; the rounds go round the queue
+ * more than twice */
+#define ROUND_ENTRIES                (50u)
+#define ROUNDS                       (7u)
+
+/* Tuner command packet: size, offset (MSB first) and up to four data bytes,
+ * last byte first */
+#define COMMAND_PACKET_SIZE          (7u)
+#define COMMAND_DATA_LAST_IDX        (6u)
+#define TUNER_CMD_OFFSET\
+    ((uint16_t)(offsetof(cy_stc_capsense_tuner_t, commonContext) +\
+                offsetof(cy_stc_capsense_common_context_t, tunerCmd)))
+
+/* The tuner stays suspended for 50 ms */
+#define SUSPEND_US                   (50000u)
+
+#define SEED                         (31337u)
+#define HCI_REMOTE_USER_TERMINATED   (0x13u)
+
+#define WIDGET_OFFSET(widget, member)\
+    ((uint16_t)(offsetof(cy_stc_capsense_tuner_t, widgetContext) +\
+                ((widget) * sizeof(cy_stc_capsense_widget_context_t)) +\
+                offsetof(cy_stc_capsense_widget_context_t, member)))
+
+
+/*******************************************************************************
+ * Global variables
+ ******************************************************************************/
+/* Entries published and popped so far; an entry carries its sequence
+ * number in its offset */
+static uint32_t published = 0;
+static uint32_t popped = 0;
+
+static const host_peer_t peer =
+{
+    .mtu = 512u, .max_tx_octets = 251u, .phy_2m = true,
+    .interval = 24u, .min_interval = 6u, .pdus_per_event = 6u
+};
+
+
+/*******************************************************************************
+ * Function Prototypes
+*******************************************************************************/
+static void queue_publish(uint32_t count);
+static void queue_pop(uint32_t count);
+static uint16_t batch_build(uint8_t *batch, uint16_t value);
+static uint16_t field_offset(uint32_t record);
+static void command_build(uint8_t *packet, uint16_t command);
+
+
+/*******************************************************************************
+* Function Name: queue_publish
+********************************************************************************
+*
+* Summary:
+*   Fills and publishes count entries, numbered in sequence. They must stay
+*   invisible to the consumer until they are published.
+*
+*******************************************************************************/
+static void queue_publish(uint32_t count)
+{
+    const tuner_cmd_t *oldest = tuner_cmd_queue_peek();
+    tuner_cmd_t *cmd = NULL;
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        cmd = tuner_cmd_queue_slot(i);
+        cmd->offset = (uint16_t)(published + i);
+        cmd->size = TUNER_CMD_DATA_SIZE;
+        memcpy(cmd->data, &cmd->offset, sizeof(cmd->offset));
+    }
+    TEST_CHECK(tuner_cmd_queue_peek() == oldest);
+
+    tuner_cmd_queue_publish(count);
+    published += count;
+}
+
+
+/*******************************************************************************
+* Function Name: queue_pop
+********************************************************************************
+*
+* Summary:
+*   Pops count entries; each must be the oldest one, and a peek must not
+*   remove it.
+*
+*******************************************************************************/
+static void queue_pop(uint32_t count)
+{
+    const tuner_cmd_t *cmd = NULL;
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        cmd = tuner_cmd_queue_peek();
+        TEST_CHECK(cmd != NULL);
+        if(cmd == NULL)
+        {
+            return;
+        }
+        TEST_CHECK(tuner_cmd_queue_peek() == cmd);
+        TEST_CHECK(cmd->offset == (uint16_t)popped);
+        TEST_CHECK(memcmp(cmd->data, &cmd->offset, sizeof(cmd->offset)) == 0);
+
+        tuner_cmd_queue_pop();
+        popped++;
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: field_offset
+********************************************************************************
+*
+* Summary:
+*   Returns the field a batch record writes: fingerCap, sigPFC and proxTh of
+*   each widget in turn.
+*
+*******************************************************************************/
+static uint16_t field_offset(uint32_t record)
+{
+    uint32_t widget = (record / 3u) % CY_CAPSENSE_WIDGET_COUNT;
+
+    switch(record % 3u)
+    {
+    case 0u:
+        return WIDGET_OFFSET(widget, fingerCap);
+    case 1u:
+        return WIDGET_OFFSET(widget, sigPFC);
+    default:
+        return WIDGET_OFFSET(widget, proxTh);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: batch_build
+********************************************************************************
+*
+* Summary:
+*   Builds a batch packet of BATCH_RECORDS writes; record i writes value + i.
+*   Every field is written several times, so its final value tells whether
+*   the records were applied in order.
+*
+* Return:
+*   Length of the packet
+*
+*******************************************************************************/
+static uint16_t batch_build(uint8_t *batch, uint16_t value)
+{
+    uint8_t *record = &batch[1];
+    uint16_t offset = 0;
+    uint16_t data = 0;
+
+    batch[0] = BATCH_COMMAND_ID;
+    for(uint32_t i = 0; i < BATCH_RECORDS; i++)
+    {
+        offset = field_offset(i);
+        data = (uint16_t)(value + i);
+        record[0] = (uint8_t)(offset >> 8);
+        record[1] = (uint8_t)offset;
+        record[2] = (uint8_t)sizeof(data);
+        memcpy(&record[3], &data, sizeof(data));
+        record += BATCH_RECORD_SIZE;
+    }
+
+    return BATCH_SIZE;
+}
+
+
+/*******************************************************************************
+* Function Name: command_build
+********************************************************************************
+*
+* Summary:
+*   Builds the command packet the CapSense Tuner writes to tunerCmd.
+*
+*******************************************************************************/
+static void command_build(uint8_t *packet, uint16_t command)
+{
+    memset(packet, 0, COMMAND_PACKET_SIZE);
+    packet[0] = (uint8_t)sizeof(command);
+    packet[1] = (uint8_t)(TUNER_CMD_OFFSET >> 8);
+    packet[2] = (uint8_t)TUNER_CMD_OFFSET;
+    packet[COMMAND_DATA_LAST_IDX] = (uint8_t)command;
+    packet[COMMAND_DATA_LAST_IDX - 1u] = (uint8_t)(command >> 8);
+}
+
+
+int main(void)
+{
+    uint8_t batch_a[BATCH_SIZE];
+    uint8_t batch_b[BATCH_SIZE];
+    uint8_t suspend[COMMAND_PACKET_SIZE];
+    uint8_t resume[COMMAND_PACKET_SIZE];
+    host_step_t script[1];
+    uint32_t scans = 0;
+    uint16_t value = 0;
+    const uint8_t *image = (const uint8_t *)&cy_capsense_tuner;
+
+    /* An empty queue */
+    TEST_CHECK(tuner_cmd_queue_peek() == NULL);
+    TEST_CHECK(tuner_cmd_queue_space() == TUNER_CMD_QUEUE_LENGTH);
+
+    /* A full queue has no space left, and gives its entries back in order */
+    queue_publish(TUNER_CMD_QUEUE_LENGTH);
+    TEST_CHECK(tuner_cmd_queue_space() == 0u);
+    queue_pop(1u);
+    TEST_CHECK(tuner_cmd_queue_space() == 1u);
+    queue_publish(1u);
+    TEST_CHECK(tuner_cmd_queue_space() == 0u);
+    queue_pop(TUNER_CMD_QUEUE_LENGTH);
+    TEST_CHECK(tuner_cmd_queue_peek() == NULL);
+    TEST_CHECK(tuner_cmd_queue_space() == TUNER_CMD_QUEUE_LENGTH);
+
+    /* The indexes wrap past the queue length, in the middle of a group of
+     * entries published together */
+    for(uint32_t round = 0; round < ROUNDS; round++)
+    {
+        queue_publish(ROUND_ENTRIES);
+        queue_publish(ROUND_ENTRIES);
+        TEST_CHECK(tuner_cmd_queue_space() == (TUNER_CMD_QUEUE_LENGTH - (2u * ROUND_ENTRIES)));
+        queue_pop(ROUND_ENTRIES);
+        queue_pop(ROUND_ENTRIES);
+        TEST_CHECK(tuner_cmd_queue_peek() == NULL);
+    }
+    TEST_CHECK(published > (2u * TUNER_CMD_QUEUE_LENGTH));
+    TEST_CHECK(popped == published);
+
+    /* Through the transport: a batch packet the queue cannot take as a
+     * whole is dropped, while the packet before it is kept */
+    host_firmware_init(SEED);
+    host_stack_connect(0u, &peer);
+
+    /* The connection reaches the main loop through the queue */
+    TEST_CHECK(tuner_cmd_queue_peek() != NULL);
+    TEST_CHECK(tuner_cmd_queue_peek()->type == TUNER_CMD_CONNECT);
+    TEST_CHECK(tuner_transport_client_connected() == false);
+    host_firmware_run(1u);
+    TEST_CHECK(tuner_cmd_queue_peek() == NULL);
+    TEST_CHECK(tuner_transport_client_connected() == true);
+
+    (void)batch_build(batch_a, 0x1000u);
+    (void)batch_build(batch_b, 0x2000u);
+    host_stack_write_cmd(0u, CY_BLE_CAPSENSE_TUNER_TUNER_COMMAND_CHAR_HANDLE,\
+                         batch_a, BATCH_SIZE);
+    TEST_CHECK(tuner_cmd_queue_space() == (TUNER_CMD_QUEUE_LENGTH - BATCH_RECORDS));
+    host_stack_write_cmd(0u, CY_BLE_CAPSENSE_TUNER_TUNER_COMMAND_CHAR_HANDLE,\
+                         batch_b, BATCH_SIZE);
+    TEST_CHECK(tuner_cmd_queue_space() == (TUNER_CMD_QUEUE_LENGTH - BATCH_RECORDS));
+    host_firmware_run(1u);
+
+    /* The last record of each field wins: the records were applied in the
+     * order they were sent */
+    TEST_CHECK(tuner_cmd_queue_peek() == NULL);
+    for(uint32_t i = BATCH_RECORDS - 9u; i < BATCH_RECORDS; i++)
+    {
+        memcpy(&value, &image[field_offset(i)], sizeof(value));
+        TEST_CHECK(value == (uint16_t)(0x1000u + i));
+    }
+
+    /* Sent again once the queue is drained, the packet is accepted */
+    host_stack_write_cmd(0u, CY_BLE_CAPSENSE_TUNER_TUNER_COMMAND_CHAR_HANDLE,\
+                         batch_b, BATCH_SIZE);
+    host_firmware_run(1u);
+    for(uint32_t i = BATCH_RECORDS - 9u; i < BATCH_RECORDS; i++)
+    {
+        memcpy(&value, &image[field_offset(i)], sizeof(value));
+        TEST_CHECK(value == (uint16_t)(0x2000u + i));
+    }
+    TEST_CHECK(tuner_cmd_queue_space() == TUNER_CMD_QUEUE_LENGTH);
+
+    /* A suspend command takes effect at once; the scans stop until the
+     * resume command arrives, which must not wait in the queue either */
+    command_build(suspend, CY_CAPSENSE_TU_CMD_SUSPEND_E);
+    command_build(resume, CY_CAPSENSE_TU_CMD_RESUME_E);
+    memset(script, 0, sizeof(script));
+    script[0].time_us = host_stack_time() + SUSPEND_US;
+    script[0].op = HOST_STEP_WRITE_CMD;
+    script[0].attr_handle = CY_BLE_CAPSENSE_TUNER_TUNER_COMMAND_CHAR_HANDLE;
+    script[0].data = resume;
+    script[0].len = COMMAND_PACKET_SIZE;
+    host_stack_script(script, 1u);
+
+    scans = host_firmware_scans();
+    host_stack_write_cmd(0u, CY_BLE_CAPSENSE_TUNER_TUNER_COMMAND_CHAR_HANDLE,\
+                         suspend, COMMAND_PACKET_SIZE);
+    TEST_CHECK(cy_capsense_tuner.commonContext.tunerCmd == CY_CAPSENSE_TU_CMD_SUSPEND_E);
+    TEST_CHECK(tuner_cmd_queue_peek() == NULL);
+    host_firmware_run(1u);
+    TEST_CHECK(host_firmware_scans() == (scans + 1u));
+    TEST_CHECK((int32_t)(host_stack_time() - script[0].time_us) >= 0);
+    TEST_CHECK(cy_capsense_tuner.commonContext.tunerCmd == CY_CAPSENSE_TU_CMD_NONE_E);
+    host_firmware_run(1u);
+    TEST_CHECK(host_firmware_scans() == (scans + 2u));
+
+    /* The writes leave room for the connection events: a batch packet that
+     * would take the reserved entries is dropped, and the disconnection
+     * still gets in behind the writes queued before it */
+    host_stack_write_cmd(0u, CY_BLE_CAPSENSE_TUNER_TUNER_COMMAND_CHAR_HANDLE,\
+                         batch_a, BATCH_SIZE);
+    host_stack_write_cmd(0u, CY_BLE_CAPSENSE_TUNER_TUNER_COMMAND_CHAR_HANDLE,\
+                         batch_b, BATCH_RECORDS_SIZE(RESERVE_RECORDS + 1u));
+    TEST_CHECK(tuner_cmd_queue_space() == (TUNER_CMD_QUEUE_LENGTH - BATCH_RECORDS));
+    host_stack_write_cmd(0u, CY_BLE_CAPSENSE_TUNER_TUNER_COMMAND_CHAR_HANDLE,\
+                         batch_b, BATCH_RECORDS_SIZE(RESERVE_RECORDS));
+    TEST_CHECK(tuner_cmd_queue_space() == EVENT_RESERVE);
+
+    host_stack_disconnect(0u, HCI_REMOTE_USER_TERMINATED);
+    TEST_CHECK(tuner_cmd_queue_space() == (EVENT_RESERVE - 1u));
+    TEST_CHECK(tuner_transport_client_connected() == true);
+    host_firmware_run(1u);
+    TEST_CHECK(tuner_cmd_queue_peek() == NULL);
+    TEST_CHECK(tuner_transport_client_connected() == false);
+
+    return TEST_RESULT("test_cmd_queue");
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,235 @@
+/******************************************************************************
+* File Name: test_layout.c
+*
+* Description: This file contains the test of the layout map of the CapSense
+*              data structure. It checks the class of the members of the common
+*              context and the widget contexts, and that a tuner write to a
+*              modulator clock initializes the baseline of every widget again.
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <string.h>
+#include <stddef.h>
+#include "host_test.h"
+#include "host_stack.h"
+#include "host_firmware.h"
+#include "tuner_layout.h"
+#include "cycfg_capsense.h"
+#include "cycfg_ble.h"
+
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define BATCH_COMMAND_ID             (0xB0u)
+#define BATCH_HDR_SIZE               (4u)
+#define SEED                         (777u)
+#define SCANS                        (20u)
+#define HCI_REMOTE_USER_TERMINATED   (0x13u)
+
+#define COMMON_OFFSET(member)\
+    ((uint16_t)(offsetof(cy_stc_capsense_tuner_t, commonContext) +\
+                offsetof(cy_stc_capsense_common_context_t, member)))
+#define COMMON_SIZE(member)\
+    ((uint16_t)sizeof(cy_capsense_tuner.commonContext.member))
+#define WIDGET_OFFSET(widget, member)\
+    ((uint16_t)(offsetof(cy_stc_capsense_tuner_t, widgetContext) +\
+                ((widget) * sizeof(cy_stc_capsense_widget_context_t)) +\
+                offsetof(cy_stc_capsense_widget_context_t, member)))
+#define WIDGET_SIZE(member)\
+    ((uint16_t)sizeof(cy_capsense_tuner.widgetContext[0].member))
+
+#define CLASS_STATIC                 (0u)
+
+
+/*******************************************************************************
+ * Data Types
+ ******************************************************************************/
+/* Expected class of a member */
+typedef struct
+{
+    uint16_t offset;
+    uint16_t size;
+    uint8_t cls;
+} expected_field_t;
+
+
+/*******************************************************************************
+ * Function Prototypes
+*******************************************************************************/
+static void field_check(const expected_field_t *field);
+
+
+/*******************************************************************************
+* Function Name: field_check
+********************************************************************************
+*
+* Summary:
+*   Every byte of the member must map to the member itself, with its class;
+*   a write is allowed only to a writable member and only inside it.
+*
+*******************************************************************************/
+static void field_check(const expected_field_t *field)
+{
+    uint16_t field_start = 0;
+    uint16_t field_size = 0;
+    bool writable = ((field->cls & TUNER_LAYOUT_WRITABLE) != 0u);
+
+    for(uint16_t i = 0; i < field->size; i++)
+    {
+        TEST_CHECK(tuner_layout_class(field->offset + i, &field_start, &field_size) ==\
+                   field->cls);
+        TEST_CHECK(field_start == field->offset);
+        TEST_CHECK(field_size == field->size);
+    }
+
+    TEST_CHECK(tuner_layout_write_allowed(field->offset, field->size) == writable);
+    TEST_CHECK(tuner_layout_write_allowed(field->offset, field->size + 1u) == false);
+    TEST_CHECK(tuner_layout_is_static(field->offset, field->size) ==\
+               ((field->cls & TUNER_LAYOUT_VOLATILE) == 0u));
+}
+
+
+int main(void)
+{
+    const expected_field_t fields[] =
+    {
+        { COMMON_OFFSET(ptrTunerSendCallback), COMMON_SIZE(ptrTunerSendCallback),
+          CLASS_STATIC },
+        { COMMON_OFFSET(ptrTunerReceiveCallback), COMMON_SIZE(ptrTunerReceiveCallback),
+          CLASS_STATIC },
+        { COMMON_OFFSET(status), COMMON_SIZE(status),
+          TUNER_LAYOUT_VOLATILE },
+        { COMMON_OFFSET(timestampInterval), COMMON_SIZE(timestampInterval),
+          TUNER_LAYOUT_WRITABLE },
+        { COMMON_OFFSET(timestamp), COMMON_SIZE(timestamp),
+          TUNER_LAYOUT_VOLATILE },
+        { COMMON_OFFSET(modCsdClk), COMMON_SIZE(modCsdClk),
+          TUNER_LAYOUT_WRITABLE | TUNER_LAYOUT_REINIT },
+        { COMMON_OFFSET(modCsxClk), COMMON_SIZE(modCsxClk),
+          TUNER_LAYOUT_WRITABLE | TUNER_LAYOUT_REINIT },
+        { COMMON_OFFSET(tunerCnt), COMMON_SIZE(tunerCnt),
+          TUNER_LAYOUT_VOLATILE },
+        { WIDGET_OFFSET(1u, gestureDetected), WIDGET_SIZE(gestureDetected),
+          TUNER_LAYOUT_VOLATILE },
+        { WIDGET_OFFSET(1u, gestureDirection), WIDGET_SIZE(gestureDirection),
+          TUNER_LAYOUT_VOLATILE },
+        { WIDGET_OFFSET(1u, xDelta), WIDGET_SIZE(xDelta),
+          TUNER_LAYOUT_VOLATILE },
+        { WIDGET_OFFSET(1u, yDelta), WIDGET_SIZE(yDelta),
+          TUNER_LAYOUT_VOLATILE },
+        { WIDGET_OFFSET(1u, onDebounce), WIDGET_SIZE(onDebounce),
+          TUNER_LAYOUT_WRITABLE },
+        { WIDGET_OFFSET(1u, wdTouch), WIDGET_SIZE(wdTouch),
+          TUNER_LAYOUT_VOLATILE },
+    };
+    uint32_t inits[CY_CAPSENSE_WIDGET_COUNT];
+    uint8_t batch[BATCH_HDR_SIZE + 1u];
+    uint16_t offset = COMMON_OFFSET(modCsdClk);
+    host_peer_t peer =
+    {
+        .mtu = 247u, .max_tx_octets = 251u, .phy_2m = true,
+        .interval = 24u, .min_interval = 6u, .pdus_per_event = 6u
+    };
+
+    for(uint8_t i = 0; i < (sizeof(fields) / sizeof(fields[0])); i++)
+    {
+        field_check(&fields[i]);
+    }
+
+    /* A modulator clock changes the raw counts of every widget */
+    host_firmware_init(SEED);
+    host_stack_connect(0u, &peer);
+    host_firmware_run(SCANS);
+    for(uint32_t widget = 0; widget < CY_CAPSENSE_WIDGET_COUNT; widget++)
+    {
+        inits[widget] = host_firmware_baseline_inits(widget);
+    }
+
+    batch[0] = BATCH_COMMAND_ID;
+    batch[1] = (uint8_t)(offset >> 8);
+    batch[2] = (uint8_t)offset;
+    batch[3] = (uint8_t)COMMON_SIZE(modCsdClk);
+    batch[4] = (uint8_t)(cy_capsense_tuner.commonContext.modCsdClk + 1u);
+    host_stack_write_cmd(0u, CY_BLE_CAPSENSE_TUNER_TUNER_COMMAND_CHAR_HANDLE,\
+                         batch, sizeof(batch));
+
+    /* The write is applied at the end of the frame; the baselines wait for
+     * the raw counts of the next scan, which uses the new clock */
+    host_firmware_run(1u);
+    TEST_CHECK(cy_capsense_tuner.commonContext.modCsdClk == batch[4]);
+    for(uint32_t widget = 0; widget < CY_CAPSENSE_WIDGET_COUNT; widget++)
+    {
+        TEST_CHECK(host_firmware_baseline_inits(widget) == inits[widget]);
+    }
+    host_firmware_run(1u);
+    for(uint32_t sensor = 0; sensor < CY_CAPSENSE_SENSOR_COUNT; sensor++)
+    {
+        TEST_CHECK(cy_capsense_tuner.sensorContext[sensor].bsln ==\
+                   cy_capsense_tuner.sensorContext[sensor].raw);
+    }
+    host_firmware_run(SCANS);
+
+    for(uint32_t widget = 0; widget < CY_CAPSENSE_WIDGET_COUNT; widget++)
+    {
+        TEST_CHECK(host_firmware_baseline_inits(widget) == (inits[widget] + 1u));
+    }
+
+    /* The callback pointers are never written */
+    offset = COMMON_OFFSET(ptrTunerReceiveCallback);
+    batch[1] = (uint8_t)(offset >> 8);
+    batch[2] = (uint8_t)offset;
+    batch[3] = 1u;
+    host_stack_write_cmd(0u, CY_BLE_CAPSENSE_TUNER_TUNER_COMMAND_CHAR_HANDLE,\
+                         batch, sizeof(batch));
+    host_firmware_run(SCANS);
+    TEST_CHECK(cy_capsense_tuner.commonContext.ptrTunerReceiveCallback == NULL);
+    for(uint32_t widget = 0; widget < CY_CAPSENSE_WIDGET_COUNT; widget++)
+    {
+        TEST_CHECK(host_firmware_baseline_inits(widget) == (inits[widget] + 1u));
+    }
+
+    host_stack_disconnect(0u, HCI_REMOTE_USER_TERMINATED);
+
+    return TEST_RESULT("test_layout");
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,181 @@
+/******************************************************************************
+* File Name: test_range.c
+*
+* Description: This file contains the test of the Tuner_Range characteristic.
+*              Each GATT Client reads its own range of the CapSense data
+*              structure, as long as one read response allows, and a range that
+*              does not fit is refused.
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <string.h>
+#include <stddef.h>
+#include "host_test.h"
+#include "host_stack.h"
+#include "host_firmware.h"
+#include "cycfg_capsense.h"
+#include "cycfg_ble.h"
+
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Tuner_Range write: offset and length, LSB first */
+#define RANGE_WRITE_SIZE             (4u)
+
+/* A read response carries the ATT MTU less the opcode */
+#define READ_RSP_SIZE(mtu)           ((uint16_t)((mtu) - 1u))
+
+/* The sensor contexts change with every scan */
+#define SENSORS_OFFSET               ((uint16_t)offsetof(cy_stc_capsense_tuner_t, sensorContext))
+#define SENSORS_SIZE                 ((uint16_t)sizeof(cy_capsense_tuner.sensorContext))
+#define WIDGETS_OFFSET               ((uint16_t)offsetof(cy_stc_capsense_tuner_t, widgetContext))
+
+#define SETTLE_US                    (2000000u)
+#define SEED                         (4242u)
+#define HCI_REMOTE_USER_TERMINATED   (0x13u)
+
+
+/*******************************************************************************
+ * Global variables
+ ******************************************************************************/
+static const host_peer_t fast_peer =
+{
+    .mtu = 247u, .max_tx_octets = 251u, .phy_2m = true,
+    .interval = 24u, .min_interval = 6u, .pdus_per_event = 6u
+};
+
+static const host_peer_t slow_peer =
+{
+    .mtu = 23u, .max_tx_octets = 27u, .phy_2m = false,
+    .interval = 40u, .min_interval = 40u, .pdus_per_event = 2u
+};
+
+
+/*******************************************************************************
+ * Function Prototypes
+*******************************************************************************/
+static cy_en_ble_gatt_err_code_t range_write(uint8_t bd_handle, uint16_t offset,
+                                             uint16_t len);
+static bool range_check(uint8_t bd_handle, uint16_t offset, uint16_t len);
+
+
+/*******************************************************************************
+* Function Name: range_write
+********************************************************************************
+*
+* Summary:
+*   Writes a range to Tuner_Range.
+*
+*******************************************************************************/
+static cy_en_ble_gatt_err_code_t range_write(uint8_t bd_handle, uint16_t offset,
+                                             uint16_t len)
+{
+    uint8_t value[RANGE_WRITE_SIZE] =
+    {
+        (uint8_t)offset, (uint8_t)(offset >> 8), (uint8_t)len, (uint8_t)(len >> 8)
+    };
+
+    return host_stack_write_req(bd_handle, CY_BLE_CAPSENSE_TUNER_TUNER_RANGE_CHAR_HANDLE,\
+                                value, RANGE_WRITE_SIZE);
+}
+
+
+/*******************************************************************************
+* Function Name: range_check
+********************************************************************************
+*
+* Summary:
+*   Reads Tuner_Range and compares it with the structure.
+*
+* Return:
+*   true if the value is the given range of cy_capsense_tuner
+*
+*******************************************************************************/
+static bool range_check(uint8_t bd_handle, uint16_t offset, uint16_t len)
+{
+    static uint8_t value[sizeof(cy_capsense_tuner)];
+
+    return (host_stack_read(bd_handle, CY_BLE_CAPSENSE_TUNER_TUNER_RANGE_CHAR_HANDLE,\
+                            value, sizeof(value)) == len) &&\
+           (memcmp(value, (const uint8_t *)&cy_capsense_tuner + offset, len) == 0);
+}
+
+
+int main(void)
+{
+    uint16_t fast_rsp = READ_RSP_SIZE(fast_peer.mtu);
+    uint16_t slow_rsp = READ_RSP_SIZE(slow_peer.mtu);
+
+    host_firmware_init(SEED);
+    host_stack_connect(0u, &fast_peer);
+    host_stack_connect(1u, &slow_peer);
+    host_firmware_run_until(host_stack_time() + SETTLE_US);
+
+    /* Until a range is written, the start of the structure */
+    TEST_CHECK(range_check(0u, 0u, fast_rsp));
+    TEST_CHECK(range_check(1u, 0u, slow_rsp));
+
+    /* Each client reads its own range, loaded when it reads */
+    TEST_CHECK(range_write(0u, SENSORS_OFFSET, SENSORS_SIZE) == CY_BLE_GATT_ERR_NONE);
+    TEST_CHECK(range_write(1u, WIDGETS_OFFSET, slow_rsp) == CY_BLE_GATT_ERR_NONE);
+    host_firmware_run(3u);
+    TEST_CHECK(range_check(0u, SENSORS_OFFSET, SENSORS_SIZE));
+    TEST_CHECK(range_check(1u, WIDGETS_OFFSET, slow_rsp));
+    host_firmware_run(3u);
+    TEST_CHECK(range_check(0u, SENSORS_OFFSET, SENSORS_SIZE));
+
+    /* A range longer than one read response or outside the structure is
+     * refused, and the range before it is kept */
+    TEST_CHECK(range_write(1u, 0u, slow_rsp + 1u) == CY_BLE_GATT_ERR_INVALID_ATTRIBUTE_LEN);
+    TEST_CHECK(range_write(0u, (uint16_t)(sizeof(cy_capsense_tuner) - 1u), 2u) ==\
+               CY_BLE_GATT_ERR_INVALID_ATTRIBUTE_LEN);
+    TEST_CHECK(range_write(0u, 0u, 0u) == CY_BLE_GATT_ERR_INVALID_ATTRIBUTE_LEN);
+    TEST_CHECK(range_check(1u, WIDGETS_OFFSET, slow_rsp));
+    TEST_CHECK(range_check(0u, SENSORS_OFFSET, SENSORS_SIZE));
+
+    host_stack_disconnect(1u, HCI_REMOTE_USER_TERMINATED);
+    host_stack_disconnect(0u, HCI_REMOTE_USER_TERMINATED);
+
+    return TEST_RESULT("test_range");
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,218 @@
+/******************************************************************************
+* File Name: test_snr.c
+*
+* Description: This file contains the test of the SNR measurement. The
+*              untouched and the touched phase are run one after the other;
+*              Sensor_Stats must report both, and a run must clear only the
+*              results of its own phase.
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <string.h>
+#include "host_test.h"
+#include "host_stack.h"
+#include "host_firmware.h"
+#include "tuner_snr.h"
+#include "cycfg_capsense.h"
+#include "cycfg_ble.h"
+
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Sensor_Stats value, see tuner_snr.h */
+#define HDR_PHASE_IDX                (0u)
+#define HDR_STATE_IDX                (1u)
+#define HDR_SCANS_LSB_IDX            (2u)
+#define HDR_DONE_IDX                 (4u)
+#define REC_COUNT_IDX                (0u)
+#define REC_MEAN_IDX                 (6u)
+#define UNTOUCHED_SIZE               (CY_CAPSENSE_SENSOR_COUNT * TUNER_SNR_RECORD_SIZE)
+
+/* Sensor_Stats write: phase, scans LSB first */
+#define START_SIZE                   (3u)
+#define RUN_SCANS                    (64u)
+
+#define SETTLE_US                    (2000000u)
+#define BUTTON0_SENSOR               (CY_CAPSENSE_SENSOR_COUNT - 4u)
+#define SEED                         (7u)
+#define HCI_REMOTE_USER_TERMINATED   (0x13u)
+
+
+/*******************************************************************************
+ * Global variables
+ ******************************************************************************/
+static const host_peer_t peer =
+{
+    .mtu = 247u, .max_tx_octets = 251u, .phy_2m = true,
+    .interval = 24u, .min_interval = 6u, .pdus_per_event = 6u
+};
+
+
+/*******************************************************************************
+ * Function Prototypes
+*******************************************************************************/
+static uint32_t get_u16(const uint8_t *buffer);
+static uint32_t get_u32(const uint8_t *buffer);
+static void snr_run(uint8_t phase, uint8_t *value);
+static const uint8_t *snr_record(const uint8_t *value, uint8_t phase,
+                                 uint32_t sensor);
+
+
+/*******************************************************************************
+* Function Name: get_u16
+********************************************************************************
+*
+* Summary:
+*   Returns a 2-byte value, LSB first.
+*
+*******************************************************************************/
+static uint32_t get_u16(const uint8_t *buffer)
+{
+    return (uint32_t)buffer[0] | ((uint32_t)buffer[1] << 8);
+}
+
+
+/*******************************************************************************
+* Function Name: get_u32
+********************************************************************************
+*
+* Summary:
+*   Returns a 4-byte value, LSB first.
+*
+*******************************************************************************/
+static uint32_t get_u32(const uint8_t *buffer)
+{
+    return (uint32_t)buffer[0] | ((uint32_t)buffer[1] << 8) |\
+           ((uint32_t)buffer[2] << 16) | ((uint32_t)buffer[3] << 24);
+}
+
+
+/*******************************************************************************
+* Function Name: snr_run
+********************************************************************************
+*
+* Summary:
+*   Starts a run of RUN_SCANS scans of a phase, lets it finish and reads
+*   Sensor_Stats.
+*
+*******************************************************************************/
+static void snr_run(uint8_t phase, uint8_t *value)
+{
+    uint8_t start[START_SIZE] = {phase, (uint8_t)RUN_SCANS, 0u};
+
+    TEST_CHECK(host_stack_write_req(0u, CY_BLE_CAPSENSE_TUNER_SENSOR_STATS_CHAR_HANDLE,\
+                                    start, START_SIZE) == CY_BLE_GATT_ERR_NONE);
+    host_firmware_run(RUN_SCANS + 2u);
+    TEST_CHECK(host_stack_read(0u, CY_BLE_CAPSENSE_TUNER_SENSOR_STATS_CHAR_HANDLE,\
+                               value, TUNER_SNR_VALUE_SIZE) == TUNER_SNR_VALUE_SIZE);
+    TEST_CHECK(value[HDR_PHASE_IDX] == phase);
+    TEST_CHECK(value[HDR_STATE_IDX] == TUNER_SNR_STATE_DONE);
+    TEST_CHECK(get_u16(&value[HDR_SCANS_LSB_IDX]) == RUN_SCANS);
+}
+
+
+/*******************************************************************************
+* Function Name: snr_record
+********************************************************************************
+*
+* Summary:
+*   Returns the record of a sensor in a phase.
+*
+*******************************************************************************/
+static const uint8_t *snr_record(const uint8_t *value, uint8_t phase,
+                                 uint32_t sensor)
+{
+    return &value[TUNER_SNR_HDR_SIZE + (phase * UNTOUCHED_SIZE) +\
+                  (sensor * TUNER_SNR_RECORD_SIZE)];
+}
+
+
+int main(void)
+{
+    static uint8_t untouched[TUNER_SNR_VALUE_SIZE];
+    static uint8_t value[TUNER_SNR_VALUE_SIZE];
+    const uint8_t *idle = NULL;
+    const uint8_t *touched = NULL;
+
+    TEST_CHECK(TUNER_SNR_VALUE_SIZE <= TUNER_SNR_VALUE_MAX_SIZE);
+
+    host_firmware_init(SEED);
+    host_stack_connect(0u, &peer);
+    host_firmware_run_until(host_stack_time() + SETTLE_US);
+
+    /* The untouched phase alone */
+    snr_run(TUNER_SNR_PHASE_UNTOUCHED, untouched);
+    TEST_CHECK(untouched[HDR_DONE_IDX] == TUNER_SNR_DONE_UNTOUCHED);
+    for(uint32_t i = 0; i < CY_CAPSENSE_SENSOR_COUNT; i++)
+    {
+        TEST_CHECK(get_u16(&snr_record(untouched, TUNER_SNR_PHASE_UNTOUCHED, i)[REC_COUNT_IDX]) == RUN_SCANS);
+        TEST_CHECK(get_u16(&snr_record(untouched, TUNER_SNR_PHASE_TOUCHED, i)[REC_COUNT_IDX]) == 0u);
+    }
+
+    /* The touched phase keeps the untouched results */
+    host_firmware_touch(BUTTON0_SENSOR, true);
+    snr_run(TUNER_SNR_PHASE_TOUCHED, value);
+    host_firmware_touch(BUTTON0_SENSOR, false);
+    TEST_CHECK(value[HDR_DONE_IDX] == (TUNER_SNR_DONE_UNTOUCHED | TUNER_SNR_DONE_TOUCHED));
+    TEST_CHECK(memcmp(&value[TUNER_SNR_HDR_SIZE], &untouched[TUNER_SNR_HDR_SIZE],\
+                      UNTOUCHED_SIZE) == 0);
+
+    idle = snr_record(value, TUNER_SNR_PHASE_UNTOUCHED, BUTTON0_SENSOR);
+    touched = snr_record(value, TUNER_SNR_PHASE_TOUCHED, BUTTON0_SENSOR);
+    TEST_CHECK(get_u16(&touched[REC_COUNT_IDX]) == RUN_SCANS);
+    TEST_CHECK(get_u32(&touched[REC_MEAN_IDX]) > get_u32(&idle[REC_MEAN_IDX]));
+
+    /* A new untouched run clears its own phase only */
+    memcpy(untouched, value, TUNER_SNR_VALUE_SIZE);
+    host_firmware_run_until(host_stack_time() + SETTLE_US);
+    snr_run(TUNER_SNR_PHASE_UNTOUCHED, value);
+    TEST_CHECK(value[HDR_DONE_IDX] == (TUNER_SNR_DONE_UNTOUCHED | TUNER_SNR_DONE_TOUCHED));
+    TEST_CHECK(memcmp(&value[TUNER_SNR_HDR_SIZE + UNTOUCHED_SIZE],\
+                      &untouched[TUNER_SNR_HDR_SIZE + UNTOUCHED_SIZE],\
+                      UNTOUCHED_SIZE) == 0);
+
+    host_stack_disconnect(0u, HCI_REMOTE_USER_TERMINATED);
+
+    return TEST_RESULT("test_snr");
+}
+
+
+/* [] END OF FILE */
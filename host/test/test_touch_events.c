@@ -0,0 +1,280 @@
+/******************************************************************************
+* File Name: test_touch_events.c
+*
+* Description: This file contains the test of the touch event latency. A touch
+*              that happens while the BLE stack is busy has to wait; the wait
+*              must show in the delay of the event, in the longest latency that
+*              Link_Stats reports for that second, and in the event busy polls,
+*              but not in the busy polls of the frames.
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <string.h>
+#include "host_test.h"
+#include "host_stack.h"
+#include "host_firmware.h"
+#include "cycfg_capsense.h"
+#include "cycfg_ble.h"
+
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Link_Stats value, see link_stats_pack() in tuner_ble_server.c */
+#define LINK_STATS_SIZE              (48u)
+#define LINK_STATS_BUSY_POLLS_IDX    (20u)
+#define LINK_STATS_EVENT_BUSY_IDX    (40u)
+#define LINK_STATS_EVENT_LATENCY_IDX (44u)
+
+/* Touch event record, see tuner_touch_events.c */
+#define EVENT_RECORD_SIZE            (6u)
+#define EVENT_DELAY_LSB_IDX          (4u)
+#define EVENT_DELAY_MSB_IDX          (5u)
+
+/* A scan of every widget */
+#define SCAN_US                      (HOST_WIDGET_SCAN_US * CY_CAPSENSE_WIDGET_COUNT)
+
+/* Link_Stats is refreshed once a second; it is read every 100 ms for 1.5 s
+ * so that no refresh is missed */
+#define POLL_US                      (100000u)
+#define POLLS                        (15u)
+
+/* The stack is held busy for 40 ms while a button is touched */
+#define STALL_US                     (40000u)
+#define SETTLE_US                    (2000000u)
+#define TOUCH_US                     (100000u)
+
+#define BUTTON0_SENSOR               (CY_CAPSENSE_SENSOR_COUNT - 4u)
+#define SEED                         (99u)
+#define HCI_REMOTE_USER_TERMINATED   (0x13u)
+
+
+/*******************************************************************************
+ * Global variables
+ ******************************************************************************/
+static uint32_t events = 0;
+static uint32_t event_delay_max = 0;
+
+static const host_peer_t peer =
+{
+    .mtu = 247u, .max_tx_octets = 251u, .phy_2m = true,
+    .interval = 24u, .min_interval = 6u, .pdus_per_event = 6u
+};
+
+
+/*******************************************************************************
+ * Function Prototypes
+*******************************************************************************/
+static void receive(uint8_t bd_handle, uint16_t attr_handle,
+                    const uint8_t *value, uint16_t len);
+static uint32_t get_u32(const uint8_t *buffer);
+static void stats_read(uint8_t *stats);
+static uint32_t latency_poll(uint8_t *stats);
+static void touch(uint32_t sensor);
+
+
+/*******************************************************************************
+* Function Name: receive
+********************************************************************************
+*
+* Summary:
+*   Counts the touch events and keeps their longest delay.
+*
+*******************************************************************************/
+static void receive(uint8_t bd_handle, uint16_t attr_handle,
+                    const uint8_t *value, uint16_t len)
+{
+    uint32_t delay = 0;
+
+    if(attr_handle != CY_BLE_CAPSENSE_TUNER_TOUCH_EVENTS_CHAR_HANDLE)
+    {
+        return;
+    }
+
+    for(uint16_t pos = 0; (pos + EVENT_RECORD_SIZE) <= len; pos += EVENT_RECORD_SIZE)
+    {
+        delay = (uint32_t)value[pos + EVENT_DELAY_LSB_IDX] |\
+                ((uint32_t)value[pos + EVENT_DELAY_MSB_IDX] << 8);
+        if(delay > event_delay_max)
+        {
+            event_delay_max = delay;
+        }
+        events++;
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: get_u32
+********************************************************************************
+*
+* Summary:
+*   Returns a 4-byte value, LSB first.
+*
+*******************************************************************************/
+static uint32_t get_u32(const uint8_t *buffer)
+{
+    return (uint32_t)buffer[0] | ((uint32_t)buffer[1] << 8) |\
+           ((uint32_t)buffer[2] << 16) | ((uint32_t)buffer[3] << 24);
+}
+
+
+/*******************************************************************************
+* Function Name: stats_read
+********************************************************************************
+*
+* Summary:
+*   Reads Link_Stats from the GATT database.
+*
+*******************************************************************************/
+static void stats_read(uint8_t *stats)
+{
+    TEST_CHECK(host_stack_read(0u, CY_BLE_CAPSENSE_TUNER_LINK_STATS_CHAR_HANDLE,\
+                               stats, LINK_STATS_SIZE) == LINK_STATS_SIZE);
+}
+
+
+/*******************************************************************************
+* Function Name: latency_poll
+********************************************************************************
+*
+* Summary:
+*   Runs the firmware for more than a second while reading Link_Stats.
+*
+* Return:
+*   Longest touch event latency Link_Stats reported
+*
+*******************************************************************************/
+static uint32_t latency_poll(uint8_t *stats)
+{
+    uint32_t latency = 0;
+
+    for(uint32_t i = 0; i < POLLS; i++)
+    {
+        host_firmware_run_until(host_stack_time() + POLL_US);
+        stats_read(stats);
+        if(get_u32(&stats[LINK_STATS_EVENT_LATENCY_IDX]) > latency)
+        {
+            latency = get_u32(&stats[LINK_STATS_EVENT_LATENCY_IDX]);
+        }
+    }
+
+    return latency;
+}
+
+
+/*******************************************************************************
+* Function Name: touch
+********************************************************************************
+*
+* Summary:
+*   Touches a sensor for TOUCH_US.
+*
+*******************************************************************************/
+static void touch(uint32_t sensor)
+{
+    host_firmware_touch(sensor, true);
+    host_firmware_run_until(host_stack_time() + TOUCH_US);
+    host_firmware_touch(sensor, false);
+}
+
+
+int main(void)
+{
+    uint8_t stats[LINK_STATS_SIZE];
+    uint32_t event_busy_polls = 0;
+    uint32_t busy_polls = 0;
+    uint32_t latency = 0;
+
+    host_stack_set_receiver(receive);
+    host_firmware_init(SEED);
+    host_stack_connect(0u, &peer);
+    TEST_CHECK(host_stack_cccd(0u,\
+               CY_BLE_CAPSENSE_TUNER_TOUCH_EVENTS_CLIENT_CHARACTERISTIC_CONFIGURATION_DESC_HANDLE,\
+               true) == CY_BLE_GATT_ERR_NONE);
+    host_firmware_run_until(host_stack_time() + SETTLE_US);
+
+    /* A free stack takes each event as soon as its widget is processed */
+    touch(BUTTON0_SENSOR);
+    latency = latency_poll(stats);
+    TEST_CHECK(events >= 2u);
+    TEST_CHECK(latency < SCAN_US);
+    TEST_CHECK(event_delay_max < SCAN_US);
+    TEST_CHECK(get_u32(&stats[LINK_STATS_EVENT_BUSY_IDX]) == 0u);
+
+    /* A busy stack with no event waiting counts no event busy poll */
+    host_stack_set_busy(true);
+    host_firmware_run_until(host_stack_time() + STALL_US);
+    host_stack_set_busy(false);
+    (void)latency_poll(stats);
+    TEST_CHECK(get_u32(&stats[LINK_STATS_EVENT_BUSY_IDX]) == 0u);
+    event_busy_polls = get_u32(&stats[LINK_STATS_EVENT_BUSY_IDX]);
+    busy_polls = get_u32(&stats[LINK_STATS_BUSY_POLLS_IDX]);
+
+    /* A touch while the stack is busy waits for it */
+    events = 0;
+    host_stack_set_busy(true);
+    host_firmware_touch(BUTTON0_SENSOR, true);
+    host_firmware_run_until(host_stack_time() + STALL_US);
+    host_stack_set_busy(false);
+    host_firmware_run_until(host_stack_time() + TOUCH_US);
+    host_firmware_touch(BUTTON0_SENSOR, false);
+    latency = latency_poll(stats);
+
+    TEST_CHECK(events >= 2u);
+    TEST_CHECK(latency >= (STALL_US - SCAN_US));
+    TEST_CHECK(latency <= (STALL_US + SCAN_US));
+    TEST_CHECK(event_delay_max >= (STALL_US - SCAN_US));
+    TEST_CHECK(event_delay_max <= latency);
+    TEST_CHECK(get_u32(&stats[LINK_STATS_EVENT_BUSY_IDX]) > event_busy_polls);
+    TEST_CHECK(get_u32(&stats[LINK_STATS_BUSY_POLLS_IDX]) == busy_polls);
+
+    /* The longest latency covers one second only */
+    touch(BUTTON0_SENSOR);
+    (void)latency_poll(stats);
+    TEST_CHECK(get_u32(&stats[LINK_STATS_EVENT_LATENCY_IDX]) < SCAN_US);
+
+    host_stack_disconnect(0u, HCI_REMOTE_USER_TERMINATED);
+
+    return TEST_RESULT("test_touch_events");
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,329 @@
+/******************************************************************************
+* File Name: test_transport.c
+*
+* Description: This file contains the end-to-end test of the tuner frame
+*              protocol on the host: the firmware streams the CapSense data
+*              structure through the stub BLE stack and the client rebuilds it
+*              from the notifications with tuner_client_receive() and
+*              tuner_decode_payload(). Every rebuilt image has to match a
+*              snapshot of the structure byte for byte.
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <string.h>
+#include <stddef.h>
+#include "host_test.h"
+#include "host_test_image.h"
+#include "host_stack.h"
+#include "host_firmware.h"
+#include "tuner_client.h"
+#include "cycfg_capsense.h"
+#include "cycfg_ble.h"
+
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define CLIENT_COUNT                 (2u)
+#define IMAGE_SIZE                   (HOST_TEST_IMAGE_SIZE)
+
+/* Frame header and payload header, see tuner_transport.c */
+#define FRAME_HDR_SIZE               (6u)
+#define CHUNK_IDX_LSB_IDX            (2u)
+#define CHUNK_IDX_MSB_IDX            (3u)
+#define CHUNK_IDX_MASK               (0x7FFFu)
+#define ENCODING_DELTA               (0x01u)
+#define ENCODING_ZERO_RLE            (0x02u)
+#define FEATURE_COMMAND_ID           (0xF0u)
+#define FEATURE_COMPRESSION          (0x01u)
+
+/* A scan of every widget is 6 ms; 500 scans are 3 seconds */
+#define PHASE_SCANS                  (500u)
+#define SEED                         (12345u)
+#define HCI_REMOTE_USER_TERMINATED   (0x13u)
+
+
+/*******************************************************************************
+ * Data Types
+ ******************************************************************************/
+/* GATT client under test */
+typedef struct
+{
+    tuner_client_t state;
+    uint8_t image[IMAGE_SIZE];
+    uint8_t payload[IMAGE_SIZE + IMAGE_SIZE];
+
+    uint32_t frames;            /* Frames rebuilt */
+    uint32_t mismatches;        /* Rebuilt images matching no snapshot */
+    uint32_t errors;            /* Packets refused by the client */
+    uint32_t bytes;             /* Frame packets received */
+    uint32_t encodings;         /* TUNER_ENCODING_* flags seen */
+    uint32_t matched_scan;      /* Scan of the snapshot last matched */
+    bool corrupt_next;          /* Flip a payload bit of the next packet */
+} test_client_t;
+
+
+/*******************************************************************************
+ * Global variables
+ ******************************************************************************/
+static test_client_t clients[CLIENT_COUNT];
+
+static const host_peer_t fast_peer =
+{
+    .mtu = 247u, .max_tx_octets = 251u, .phy_2m = true,
+    .interval = 24u, .min_interval = 6u, .pdus_per_event = 6u
+};
+
+static const host_peer_t slow_peer =
+{
+    .mtu = 23u, .max_tx_octets = 27u, .phy_2m = false,
+    .interval = 24u, .min_interval = 24u, .pdus_per_event = 4u
+};
+
+static const uint8_t feature_command[] = { FEATURE_COMMAND_ID, FEATURE_COMPRESSION };
+
+
+/*******************************************************************************
+ * Function Prototypes
+*******************************************************************************/
+static void receive(uint8_t bd_handle, uint16_t attr_handle,
+                    const uint8_t *value, uint16_t len);
+static void client_reset(uint8_t bd_handle);
+
+
+/*******************************************************************************
+* Function Name: receive
+********************************************************************************
+*
+* Summary:
+*   Feeds the CapSense_DS notifications of a connection to its client.
+*
+*******************************************************************************/
+static void receive(uint8_t bd_handle, uint16_t attr_handle,
+                    const uint8_t *value, uint16_t len)
+{
+    test_client_t *client = &clients[bd_handle];
+    uint8_t packet[CY_BLE_GATT_MTU];
+    uint16_t chunk = 0;
+    int result = 0;
+
+    if(attr_handle != CY_BLE_CAPSENSE_TUNER_CAPSENSE_DS_CHAR_HANDLE)
+    {
+        return;
+    }
+
+    memcpy(packet, value, len);
+    if((client->corrupt_next == true) && (len > FRAME_HDR_SIZE) &&\
+       (client->state.initialized == true))
+    {
+        client->corrupt_next = false;
+        packet[len - 1u] ^= 0x01u;
+    }
+
+    result = tuner_client_receive(&client->state, packet, len);
+    if(result < 0)
+    {
+        client->errors++;
+        return;
+    }
+
+    chunk = (uint16_t)(packet[CHUNK_IDX_LSB_IDX] |\
+                       ((uint16_t)packet[CHUNK_IDX_MSB_IDX] << 8)) & CHUNK_IDX_MASK;
+    if((result != TUNER_CLIENT_INIT) && (len > FRAME_HDR_SIZE))
+    {
+        client->bytes += len;
+        if(chunk == 0u)
+        {
+            client->encodings |= packet[FRAME_HDR_SIZE];
+        }
+    }
+
+    if(result == TUNER_CLIENT_FRAME)
+    {
+        client->frames++;
+
+        /* The rebuilt image has to be one of the snapshots, no older than
+         * the one the previous frame matched */
+        if(host_test_image_match(client->image, client->state.image_size,\
+                                 &client->matched_scan) == false)
+        {
+            client->mismatches++;
+        }
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: client_reset
+********************************************************************************
+*
+* Summary:
+*   Starts a client with no copy of the structure.
+*
+*******************************************************************************/
+static void client_reset(uint8_t bd_handle)
+{
+    test_client_t *client = &clients[bd_handle];
+
+    memset(client, 0, sizeof(test_client_t));
+    tuner_client_init(&client->state, client->image, sizeof(client->image),\
+                      client->payload, sizeof(client->payload));
+    client->matched_scan = host_test_scans();
+}
+
+
+int main(void)
+{
+    test_client_t *fast = &clients[0];
+    test_client_t *slow = &clients[1];
+    uint32_t raw_bytes_per_frame = 0;
+    uint8_t regions[HOST_TEST_REGIONS_MAX * HOST_TEST_REGION_RECORD_SIZE];
+    uint16_t regions_len = 0;
+    host_step_t script[2];
+
+    host_stack_set_receiver(receive);
+    host_firmware_set_hook(host_test_snapshot);
+    host_firmware_init(SEED);
+    client_reset(0u);
+    client_reset(1u);
+
+    /* Raw frames over a fast link */
+    host_stack_connect(0u, &fast_peer);
+    TEST_CHECK(host_stack_cccd(0u,\
+               CY_BLE_CAPSENSE_TUNER_CAPSENSE_DS_CLIENT_CHARACTERISTIC_CONFIGURATION_DESC_HANDLE,\
+               true) == CY_BLE_GATT_ERR_NONE);
+    host_test_touch_pattern(PHASE_SCANS);
+
+    TEST_CHECK(fast->state.initialized == true);
+    TEST_CHECK(fast->state.version == 3u);
+    TEST_CHECK(fast->state.image_size == IMAGE_SIZE);
+    TEST_CHECK(fast->frames > (PHASE_SCANS / 2u));
+    TEST_CHECK(fast->mismatches == 0u);
+    TEST_CHECK(fast->errors == 0u);
+    TEST_CHECK(fast->state.lost_frames == 0u);
+    TEST_CHECK(fast->encodings == 0u);
+    TEST_CHECK(host_stack_interval(0u) == 6u);
+    TEST_CHECK(memcmp(fast->image, host_test_history(fast->matched_scan),\
+                      IMAGE_SIZE) == 0);
+    raw_bytes_per_frame = fast->bytes / fast->frames;
+
+    /* Delta and zero run-length encoded frames */
+    host_stack_write_cmd(0u, CY_BLE_CAPSENSE_TUNER_TUNER_COMMAND_CHAR_HANDLE,\
+                         feature_command, sizeof(feature_command));
+    fast->frames = 0;
+    fast->bytes = 0;
+    host_test_touch_pattern(PHASE_SCANS);
+
+    TEST_CHECK(fast->frames > (PHASE_SCANS / 2u));
+    TEST_CHECK(fast->mismatches == 0u);
+    TEST_CHECK(fast->errors == 0u);
+    TEST_CHECK((fast->encodings & ENCODING_DELTA) != 0u);
+    TEST_CHECK((fast->encodings & ENCODING_ZERO_RLE) != 0u);
+    TEST_CHECK((fast->bytes / fast->frames) < raw_bytes_per_frame);
+
+    /* A corrupted packet fails its CRC; the client catches up with the
+     * next key frame */
+    fast->corrupt_next = true;
+    fast->frames = 0;
+    host_test_touch_pattern(PHASE_SCANS);
+
+    TEST_CHECK(fast->errors == 1u);
+    TEST_CHECK(fast->state.crc_errors == 1u);
+    TEST_CHECK(fast->state.synced == true);
+    TEST_CHECK(fast->frames > (PHASE_SCANS / 4u));
+    TEST_CHECK(fast->mismatches == 0u);
+
+    /* A second client on a default link joins from a script; both get
+     * every frame and the slow link paces them */
+    client_reset(1u);
+    memset(script, 0, sizeof(script));
+    script[0].time_us = host_stack_time() + 1000u;
+    script[0].op = HOST_STEP_CONNECT;
+    script[0].bd_handle = 1u;
+    script[0].peer = &slow_peer;
+    script[1].time_us = host_stack_time() + 50000u;
+    script[1].op = HOST_STEP_CCCD;
+    script[1].bd_handle = 1u;
+    script[1].attr_handle =\
+        CY_BLE_CAPSENSE_TUNER_CAPSENSE_DS_CLIENT_CHARACTERISTIC_CONFIGURATION_DESC_HANDLE;
+    script[1].value = 1u;
+    host_stack_script(script, 2u);
+    fast->frames = 0;
+    host_test_touch_pattern(PHASE_SCANS);
+
+    TEST_CHECK(slow->state.initialized == true);
+    TEST_CHECK(slow->state.chunk_size == 20u);
+    TEST_CHECK(host_stack_interval(1u) == 24u);
+    TEST_CHECK(slow->frames > 10u);
+    TEST_CHECK(slow->mismatches == 0u);
+    TEST_CHECK(slow->errors == 0u);
+    TEST_CHECK(slow->state.lost_frames == 0u);
+    TEST_CHECK(fast->mismatches == 0u);
+    TEST_CHECK((fast->frames + 1u) >= slow->frames);
+
+    /* Windows of the structure: the widget contexts and the sensor
+     * contexts of the buttons */
+    host_test_region_add((uint16_t)offsetof(cy_stc_capsense_tuner_t, widgetContext),\
+                         (uint16_t)sizeof(cy_capsense_tuner.widgetContext));
+    host_test_region_add((uint16_t)offsetof(cy_stc_capsense_tuner_t,\
+                                            sensorContext[CY_CAPSENSE_SENSOR_COUNT - 4u]),\
+                         (uint16_t)(4u * sizeof(cy_stc_capsense_sensor_context_t)));
+    regions_len = host_test_regions_pack(regions);
+    TEST_CHECK(host_stack_write_req(0u, CY_BLE_CAPSENSE_TUNER_TUNER_REGIONS_CHAR_HANDLE,\
+                                    regions, regions_len) == CY_BLE_GATT_ERR_NONE);
+    fast->frames = 0;
+    slow->frames = 0;
+    host_test_touch_pattern(PHASE_SCANS);
+
+    TEST_CHECK(fast->state.image_size == host_test_regions_size());
+    TEST_CHECK(slow->state.image_size == host_test_regions_size());
+    TEST_CHECK(fast->frames > 10u);
+    TEST_CHECK(slow->frames > 10u);
+    TEST_CHECK(fast->mismatches == 0u);
+    TEST_CHECK(slow->mismatches == 0u);
+
+    host_stack_disconnect(1u, HCI_REMOTE_USER_TERMINATED);
+    host_stack_disconnect(0u, HCI_REMOTE_USER_TERMINATED);
+
+    return TEST_RESULT("test_transport");
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,387 @@
+/******************************************************************************
+* File Name: tuner_bench.c
+*
+* Description: This file contains the benchmark of the tuner path on the host.
+*              It runs the firmware modules against the stub BLE stack for a
+*              sweep of ATT MTUs, connection intervals and compression
+*              settings, with simulated fingers on the widgets, and prints one
+*              comma-separated line per configuration. The structure size is
+*              set at build time, see Makefile. All times are simulated, so the
+*              output is the same on every run.
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "host_stack.h"
+#include "host_firmware.h"
+#include "tuner_client.h"
+#include "cycfg_capsense.h"
+#include "cycfg_ble.h"
+
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define IMAGE_SIZE                   (sizeof(cy_capsense_tuner))
+#define HISTORY_LENGTH               (256u)
+
+/* Link negotiation runs before the measurement starts */
+#define WARMUP_US                    (1500000u)
+#define MEASURE_US                   (5000000u)
+#define SETTLE_US                    (100000u)
+
+/* GATT client: 251-byte data length, 2M PHY, LL data PDUs it takes per
+ * connection event */
+#define PEER_TX_OCTETS               (251u)
+#define PEER_PDUS_PER_EVENT          (6u)
+
+/* Simulated fingers */
+#define TOUCH_PERIOD_US              (150000u)
+#define SEED                         (2021u)
+
+#define FEATURE_COMMAND_ID           (0xF0u)
+#define FEATURE_COMPRESSION          (0x01u)
+#define HCI_REMOTE_USER_TERMINATED   (0x13u)
+#define CONN_INTERVAL_UNIT_US        (1250u)
+#define US_PER_S                     (1000000u)
+#define BITS_PER_BYTE                (8u)
+
+/* Link_Stats value, see link_stats_pack() in tuner_ble_server.c */
+#define LINK_STATS_SIZE              (48u)
+#define LINK_STATS_BUSY_POLLS_IDX    (20u)
+#define LINK_STATS_TX_OCTETS_IDX     (28u)
+#define LINK_STATS_TX_PHY_IDX        (30u)
+
+
+/*******************************************************************************
+ * Data Types
+ ******************************************************************************/
+/* Results of one configuration */
+typedef struct
+{
+    uint32_t frames;
+    uint32_t mismatches;
+    uint64_t latency_sum;
+    uint32_t latency_max;
+} bench_result_t;
+
+
+/*******************************************************************************
+ * Global variables
+ ******************************************************************************/
+static const uint16_t bench_mtus[] = { 23u, 65u, 185u, 247u, 512u };
+
+/* 7.5 ms, 15 ms, 30 ms and 50 ms; the client refuses anything shorter */
+static const uint16_t bench_intervals[] = { 6u, 12u, 24u, 40u };
+
+static tuner_client_t client;
+static uint8_t client_image[IMAGE_SIZE];
+static uint8_t client_payload[IMAGE_SIZE + IMAGE_SIZE];
+
+/* Snapshots after each Cy_CapSense_RunTuner() and their times */
+static uint8_t history[HISTORY_LENGTH][IMAGE_SIZE];
+static uint32_t history_time[HISTORY_LENGTH];
+static uint32_t history_count = 0;
+static uint32_t matched_scan = 0;
+
+static bench_result_t result;
+static bool measuring = false;
+
+
+/*******************************************************************************
+ * Function Prototypes
+*******************************************************************************/
+static void snapshot_hook(void);
+static void receive(uint8_t bd_handle, uint16_t attr_handle,
+                    const uint8_t *value, uint16_t len);
+static void frame_received(void);
+static void run_touched(uint32_t us);
+static uint32_t get_u32(const uint8_t *buffer);
+static void bench_config(FILE *csv, uint16_t mtu, uint16_t interval, bool compression);
+
+
+/*******************************************************************************
+* Function Name: snapshot_hook
+********************************************************************************
+*
+* Summary:
+*   Keeps the structure as the tuner saw it after each scan, and when.
+*
+*******************************************************************************/
+static void snapshot_hook(void)
+{
+    memcpy(history[history_count % HISTORY_LENGTH], &cy_capsense_tuner, IMAGE_SIZE);
+    history_time[history_count % HISTORY_LENGTH] = host_stack_time();
+    history_count++;
+}
+
+
+/*******************************************************************************
+* Function Name: receive
+********************************************************************************
+*
+* Summary:
+*   Feeds the CapSense_DS notifications to the client.
+*
+*******************************************************************************/
+static void receive(uint8_t bd_handle, uint16_t attr_handle,
+                    const uint8_t *value, uint16_t len)
+{
+    if((attr_handle == CY_BLE_CAPSENSE_TUNER_CAPSENSE_DS_CHAR_HANDLE) &&\
+       (tuner_client_receive(&client, value, len) == TUNER_CLIENT_FRAME))
+    {
+        frame_received();
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: frame_received
+********************************************************************************
+*
+* Summary:
+*   Finds the snapshot a rebuilt frame holds; the latency of the frame runs
+*   from that snapshot to the arrival of its last packet.
+*
+*******************************************************************************/
+static void frame_received(void)
+{
+    uint32_t first = (history_count > HISTORY_LENGTH) ? (history_count - HISTORY_LENGTH) : 0u;
+    uint32_t latency = 0;
+
+    if(matched_scan > first)
+    {
+        first = matched_scan;
+    }
+
+    for(uint32_t scan = history_count; scan > first; scan--)
+    {
+        if(memcmp(history[(scan - 1u) % HISTORY_LENGTH], client_image, IMAGE_SIZE) == 0)
+        {
+            matched_scan = scan - 1u;
+            latency = host_stack_time() - history_time[matched_scan % HISTORY_LENGTH];
+
+            if(measuring == true)
+            {
+                result.frames++;
+                result.latency_sum += latency;
+                if(latency > result.latency_max)
+                {
+                    result.latency_max = latency;
+                }
+            }
+            return;
+        }
+    }
+
+    result.mismatches++;
+}
+
+
+/*******************************************************************************
+* Function Name: run_touched
+********************************************************************************
+*
+* Summary:
+*   Runs the firmware while a finger moves from sensor to sensor.
+*
+*******************************************************************************/
+static void run_touched(uint32_t us)
+{
+    uint32_t end = host_stack_time() + us;
+    uint32_t sensor = 0;
+
+    while((int32_t)(end - host_stack_time()) > 0)
+    {
+        sensor = (host_stack_time() / TOUCH_PERIOD_US) % CY_CAPSENSE_SENSOR_COUNT;
+        host_firmware_touch(sensor, true);
+        host_firmware_run_until(host_stack_time() + (TOUCH_PERIOD_US / 2u));
+        host_firmware_touch(sensor, false);
+        host_firmware_run_until(host_stack_time() + (TOUCH_PERIOD_US / 2u));
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: get_u32
+********************************************************************************
+*
+* Summary:
+*   Returns a 4-byte value, LSB first.
+*
+*******************************************************************************/
+static uint32_t get_u32(const uint8_t *buffer)
+{
+    return (uint32_t)buffer[0] | ((uint32_t)buffer[1] << 8) |\
+           ((uint32_t)buffer[2] << 16) | ((uint32_t)buffer[3] << 24);
+}
+
+
+/*******************************************************************************
+* Function Name: bench_config
+********************************************************************************
+*
+* Summary:
+*   Connects a client with the given ATT MTU and connection interval, lets
+*   the link negotiation finish, and measures the frames it rebuilds.
+*
+*******************************************************************************/
+static void bench_config(FILE *csv, uint16_t mtu, uint16_t interval, bool compression)
+{
+    const host_peer_t peer =
+    {
+        .mtu = mtu, .max_tx_octets = PEER_TX_OCTETS, .phy_2m = true,
+        .interval = interval, .min_interval = interval,
+        .pdus_per_event = PEER_PDUS_PER_EVENT
+    };
+    const uint8_t feature_command[] = { FEATURE_COMMAND_ID, FEATURE_COMPRESSION };
+    uint8_t stats_start[LINK_STATS_SIZE] = {0};
+    uint8_t stats_end[LINK_STATS_SIZE] = {0};
+    host_link_stats_t link_start;
+    const host_link_stats_t *link_end = NULL;
+    uint32_t bytes = 0;
+    uint32_t notifications = 0;
+
+    tuner_client_init(&client, client_image, sizeof(client_image),\
+                      client_payload, sizeof(client_payload));
+    matched_scan = history_count;
+    memset(&result, 0, sizeof(result));
+
+    host_stack_connect(0u, &peer);
+    (void)host_stack_cccd(0u,\
+            CY_BLE_CAPSENSE_TUNER_CAPSENSE_DS_CLIENT_CHARACTERISTIC_CONFIGURATION_DESC_HANDLE,\
+            true);
+    if(compression == true)
+    {
+        host_stack_write_cmd(0u, CY_BLE_CAPSENSE_TUNER_TUNER_COMMAND_CHAR_HANDLE,\
+                             feature_command, sizeof(feature_command));
+    }
+    run_touched(WARMUP_US);
+
+    /* Link_Stats is refreshed once a second; both reads follow a refresh */
+    (void)host_stack_read(0u, CY_BLE_CAPSENSE_TUNER_LINK_STATS_CHAR_HANDLE,\
+                          stats_start, sizeof(stats_start));
+    link_start = *host_stack_link_stats(0u);
+    measuring = true;
+    run_touched(MEASURE_US);
+    measuring = false;
+    (void)host_stack_read(0u, CY_BLE_CAPSENSE_TUNER_LINK_STATS_CHAR_HANDLE,\
+                          stats_end, sizeof(stats_end));
+    link_end = host_stack_link_stats(0u);
+
+    bytes = link_end->bytes - link_start.bytes;
+    notifications = link_end->notifications - link_start.notifications;
+
+    fprintf(csv, "%u,%u,%u.%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u\n",
+            (unsigned)IMAGE_SIZE, mtu,
+            (interval * CONN_INTERVAL_UNIT_US) / 1000u,
+            ((interval * CONN_INTERVAL_UNIT_US) % 1000u) / 100u,
+            (compression == true) ? 1u : 0u,
+            stats_end[LINK_STATS_TX_OCTETS_IDX] |\
+            ((unsigned)stats_end[LINK_STATS_TX_OCTETS_IDX + 1u] << 8),
+            (stats_end[LINK_STATS_TX_PHY_IDX] == CY_BLE_PHY_MASK_LE_2M) ? 2u : 1u,
+            (unsigned)((result.frames * US_PER_S) / MEASURE_US),
+            (unsigned)(((uint64_t)notifications * US_PER_S) / MEASURE_US),
+            (unsigned)(((uint64_t)bytes * BITS_PER_BYTE * 1000u) / MEASURE_US),
+            (result.frames != 0u) ? (unsigned)(bytes / result.frames) : 0u,
+            (result.frames != 0u) ? (unsigned)(result.latency_sum / result.frames) : 0u,
+            (unsigned)result.latency_max,
+            (unsigned)(get_u32(&stats_end[LINK_STATS_BUSY_POLLS_IDX]) -\
+                       get_u32(&stats_start[LINK_STATS_BUSY_POLLS_IDX])),
+            (unsigned)(link_end->refused - link_start.refused),
+            (unsigned)result.mismatches);
+
+    host_stack_disconnect(0u, HCI_REMOTE_USER_TERMINATED);
+    host_firmware_run_until(host_stack_time() + SETTLE_US);
+}
+
+
+/*******************************************************************************
+* Function Name: main
+********************************************************************************
+*
+* Summary:
+*   Prints the column names if the first argument is --header, then one line
+*   per configuration: structure size, ATT MTU, connection interval in ms,
+*   compression, LL data length, PHY, frames per second, notifications per
+*   second, kbit/s of notification values, bytes per frame, mean and maximum
+*   frame latency in us, busy polls, notifications the stack refused, and
+*   frames that matched no snapshot. The firmware output goes to /dev/null.
+*
+*******************************************************************************/
+int main(int argc, char *argv[])
+{
+    FILE *csv = fdopen(dup(STDOUT_FILENO), "w");
+
+    if(freopen("/dev/null", "w", stdout) == NULL)
+    {
+        return 1;
+    }
+
+    if((argc > 1) && (strcmp(argv[1], "--header") == 0))
+    {
+        fprintf(csv, "ds_size,mtu,interval_ms,compression,tx_octets,phy,"
+                     "frames_per_s,ntf_per_s,kbit_per_s,bytes_per_frame,"
+                     "latency_mean_us,latency_max_us,busy_polls,refused,"
+                     "mismatches\n");
+    }
+
+    host_stack_set_receiver(receive);
+    host_firmware_set_hook(snapshot_hook);
+    host_firmware_init(SEED);
+
+    for(uint8_t m = 0; m < (sizeof(bench_mtus) / sizeof(bench_mtus[0])); m++)
+    {
+        for(uint8_t i = 0; i < (sizeof(bench_intervals) / sizeof(bench_intervals[0])); i++)
+        {
+            bench_config(csv, bench_mtus[m], bench_intervals[i], false);
+            bench_config(csv, bench_mtus[m], bench_intervals[i], true);
+        }
+    }
+
+    fclose(csv);
+
+    return 0;
+}
+
+
+/* [] END OF FILE */
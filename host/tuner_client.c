@@ -0,0 +1,397 @@
+/******************************************************************************
+* File Name: tuner_client.c
+*
+* Description: This file contains a reference GATT client reassembler for the
+*              tuner frames sent over the CapSense_DS characteristic. It is not
+*              part of the firmware; it can be built on a host together with
+*              tuner_decoder.c.
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <string.h>
+#include "tuner_client.h"
+#include "tuner_decoder.h"
+
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Bridge-init packet, see tuner_transport.c */
+#define TUNER_BRIDGE_INIT_NTF_SIZE   (11u)
+#define CAPSENSE_DS_SIZE_LSB_IDX     (0u)
+#define CAPSENSE_DS_SIZE_MSB_IDX     (1u)
+#define TUNER_BLOCK_SIZE_IDX         (3u)
+#define NOTIFICATION_SIZE_LSB_IDX    (4u)
+#define NOTIFICATION_SIZE_MSB_IDX    (5u)
+#define TUNER_PROTOCOL_VERSION_IDX   (7u)
+#define TUNER_IMAGE_SIZE_LSB_IDX     (8u)
+#define TUNER_IMAGE_SIZE_MSB_IDX     (9u)
+#define TUNER_FEATURE_FLAGS_IDX      (10u)
+#define MIN_PROTOCOL_VERSION         (3u)
+
+/* Frame header in front of every frame notification packet */
+#define TUNER_FRAME_HDR_SIZE         (6u)
+#define TUNER_FRAME_NUM_LSB_IDX      (0u)
+#define TUNER_FRAME_NUM_MSB_IDX      (1u)
+#define TUNER_CHUNK_IDX_LSB_IDX      (2u)
+#define TUNER_CHUNK_IDX_MSB_IDX      (3u)
+#define TUNER_CRC_LSB_IDX            (4u)
+#define TUNER_CRC_MSB_IDX            (5u)
+#define TUNER_CRC_COVERED_HDR_SIZE   (4u)
+#define TUNER_LAST_CHUNK_FLAG        (0x8000u)
+#define TUNER_CHUNK_IDX_MASK         (0x7FFFu)
+
+/* Byte 3 holds the block size in the bridge-init packet; in the first
+ * packet of a frame it only holds the last-packet flag */
+#define TUNER_INIT_MARKER_MASK       (0x7Fu)
+
+#define CRC16_INIT                   (0xFFFFu)
+#define CRC16_POLY                   (0x1021u)
+#define CRC16_MSB                    (0x8000u)
+#define TUNER_PAYLOAD_HDR_SIZE       (1u)
+#define TUNER_ENCODING_DELTA         (0x01u)
+#define BITS_PER_BYTE                (8u)
+#define MSB_SHIFT                    (8u)
+
+
+/*******************************************************************************
+ * Function Prototypes
+*******************************************************************************/
+static int receive_init(tuner_client_t *client, const uint8_t *packet);
+static int frame_complete(tuner_client_t *client);
+static bool frame_is_full(const tuner_client_t *client);
+static uint16_t crc16(uint16_t crc, const uint8_t *data, uint16_t len);
+
+
+/*******************************************************************************
+* Function Name: tuner_client_init
+********************************************************************************
+*
+* Summary:
+*   Initializes the reassembly state. Frames are dropped until the first
+*   bridge-init packet is received.
+*
+* Parameters:
+*  tuner_client_t *client    : Reassembly state
+*  uint8_t *image            : Buffer for the client copy of the image
+*  uint16_t image_capacity   : Size of the image buffer
+*  uint8_t *payload          : Buffer for the frame payload
+*  uint16_t payload_capacity : Size of the payload buffer; a frame carrying
+*                              every block needs the image size plus the
+*                              bitmap and 1 byte
+*
+*******************************************************************************/
+void tuner_client_init(tuner_client_t *client, uint8_t *image,
+                       uint16_t image_capacity, uint8_t *payload,
+                       uint16_t payload_capacity)
+{
+    memset(client, 0, sizeof(*client));
+    client->image = image;
+    client->image_capacity = image_capacity;
+    client->payload = payload;
+    client->payload_capacity = payload_capacity;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_client_receive
+********************************************************************************
+*
+* Summary:
+*   Handles one notification packet of the CapSense_DS characteristic.
+*   Checks the frame header and the CRC, concatenates the payloads of a frame
+*   and applies the frame to the image once its last packet arrives. When a
+*   packet or a frame is lost, frames that depend on the previous frame are
+*   dropped until a frame carrying every block brings the image back in sync.
+*
+* Parameters:
+*  tuner_client_t *client : Reassembly state
+*  const uint8_t *packet  : Notification value
+*  uint16_t len           : Length of the notification value
+*
+* Return:
+*   TUNER_CLIENT_* status, or a TUNER_CLIENT_ERR_* / TUNER_DECODE_ERR_* code
+*
+*******************************************************************************/
+int tuner_client_receive(tuner_client_t *client, const uint8_t *packet,
+                         uint16_t len)
+{
+    uint16_t frame_number = 0;
+    uint16_t chunk_index = 0;
+    uint16_t crc = CRC16_INIT;
+    uint16_t payload_len = 0;
+
+    /* The bridge-init packet is only sent between frames */
+    if((client->in_frame == false) && (len == TUNER_BRIDGE_INIT_NTF_SIZE) &&
+       ((packet[TUNER_CHUNK_IDX_MSB_IDX] & TUNER_INIT_MARKER_MASK) != 0u))
+    {
+        return receive_init(client, packet);
+    }
+
+    if(client->initialized == false)
+    {
+        return TUNER_CLIENT_ERR_NOT_INIT;
+    }
+
+    if((len <= TUNER_FRAME_HDR_SIZE) || (len > client->chunk_size))
+    {
+        client->in_frame = false;
+        client->synced = false;
+        return TUNER_CLIENT_ERR_LENGTH;
+    }
+
+    client->packets++;
+    payload_len = (uint16_t)(len - TUNER_FRAME_HDR_SIZE);
+    frame_number = (uint16_t)((uint16_t)packet[TUNER_FRAME_NUM_LSB_IDX] |
+                   ((uint16_t)packet[TUNER_FRAME_NUM_MSB_IDX] << MSB_SHIFT));
+    chunk_index = (uint16_t)((uint16_t)packet[TUNER_CHUNK_IDX_LSB_IDX] |
+                  ((uint16_t)packet[TUNER_CHUNK_IDX_MSB_IDX] << MSB_SHIFT));
+
+    crc = crc16(crc, packet, TUNER_CRC_COVERED_HDR_SIZE);
+    crc = crc16(crc, &packet[TUNER_FRAME_HDR_SIZE], payload_len);
+    if(crc != (uint16_t)((uint16_t)packet[TUNER_CRC_LSB_IDX] |
+                         ((uint16_t)packet[TUNER_CRC_MSB_IDX] << MSB_SHIFT)))
+    {
+        client->crc_errors++;
+        client->in_frame = false;
+        client->synced = false;
+        return TUNER_CLIENT_ERR_CRC;
+    }
+
+    if((chunk_index & TUNER_CHUNK_IDX_MASK) == 0u)
+    {
+        if(client->in_frame == true)
+        {
+            /* The last packet of the previous frame was lost */
+            client->last_frame = client->frame_number;
+            client->lost_frames++;
+            client->synced = false;
+        }
+
+        /* Frame numbers are shared by all clients of the server and keep
+         * counting across subscriptions; the first frame after the
+         * bridge-init packet sets the base */
+        if((client->last_frame_valid == true) &&
+           (frame_number != (uint16_t)(client->last_frame + 1u)))
+        {
+            client->lost_frames +=
+                (uint16_t)(frame_number - client->last_frame - 1u);
+            client->synced = false;
+        }
+
+        client->in_frame = true;
+        client->frame_number = frame_number;
+        client->next_chunk = 0;
+        client->payload_len = 0;
+    }
+    else if((client->in_frame == false) ||
+            (frame_number != client->frame_number) ||
+            ((chunk_index & TUNER_CHUNK_IDX_MASK) != client->next_chunk))
+    {
+        /* A packet of this frame was lost; count every frame up to it */
+        if((client->last_frame_valid == true) &&
+           (frame_number != client->last_frame))
+        {
+            client->lost_frames += (uint16_t)(frame_number - client->last_frame);
+        }
+        client->last_frame = frame_number;
+        client->last_frame_valid = true;
+        client->in_frame = false;
+        client->synced = false;
+        return TUNER_CLIENT_ERR_SEQUENCE;
+    }
+
+    if((uint32_t)client->payload_len + payload_len > client->payload_capacity)
+    {
+        client->in_frame = false;
+        client->synced = false;
+        return TUNER_CLIENT_ERR_OVERFLOW;
+    }
+
+    memcpy(&client->payload[client->payload_len], &packet[TUNER_FRAME_HDR_SIZE],
+           payload_len);
+    client->payload_len = (uint16_t)(client->payload_len + payload_len);
+    client->next_chunk++;
+
+    if((chunk_index & TUNER_LAST_CHUNK_FLAG) == 0u)
+    {
+        return TUNER_CLIENT_PARTIAL;
+    }
+
+    client->in_frame = false;
+    client->last_frame = frame_number;
+    client->last_frame_valid = true;
+
+    return frame_complete(client);
+}
+
+
+/*******************************************************************************
+* Function Name: receive_init
+********************************************************************************
+*
+* Summary:
+*   Stores the parameters of a bridge-init packet. The next frame carries
+*   every block; its number is not known in advance.
+*
+*******************************************************************************/
+static int receive_init(tuner_client_t *client, const uint8_t *packet)
+{
+    client->ds_size = (uint16_t)((uint16_t)packet[CAPSENSE_DS_SIZE_LSB_IDX] |
+                      ((uint16_t)packet[CAPSENSE_DS_SIZE_MSB_IDX] << MSB_SHIFT));
+    client->chunk_size = (uint16_t)((uint16_t)packet[NOTIFICATION_SIZE_LSB_IDX] |
+                         ((uint16_t)packet[NOTIFICATION_SIZE_MSB_IDX] << MSB_SHIFT));
+    client->image_size = (uint16_t)((uint16_t)packet[TUNER_IMAGE_SIZE_LSB_IDX] |
+                         ((uint16_t)packet[TUNER_IMAGE_SIZE_MSB_IDX] << MSB_SHIFT));
+    client->block_size = packet[TUNER_BLOCK_SIZE_IDX];
+    client->version = packet[TUNER_PROTOCOL_VERSION_IDX];
+    client->features = packet[TUNER_FEATURE_FLAGS_IDX];
+
+    client->initialized = ((client->version >= MIN_PROTOCOL_VERSION) &&
+                           (client->image_size <= client->image_capacity) &&
+                           (client->chunk_size > TUNER_FRAME_HDR_SIZE));
+    client->in_frame = false;
+    client->last_frame = 0;
+    client->last_frame_valid = false;
+    client->synced = false;
+
+    return (client->initialized == true) ? TUNER_CLIENT_INIT :
+                                           TUNER_CLIENT_ERR_LENGTH;
+}
+
+
+/*******************************************************************************
+* Function Name: frame_complete
+********************************************************************************
+*
+* Summary:
+*   Applies a reassembled frame to the image. While the image is out of sync
+*   only frames carrying every block are applied; delta-encoded frames would
+*   add to stale data, and partial raw frames would leave other blocks stale.
+*
+*******************************************************************************/
+static int frame_complete(tuner_client_t *client)
+{
+    int result = TUNER_DECODE_OK;
+
+    if(client->synced == false)
+    {
+        if((frame_is_full(client) == false) ||
+           ((client->payload[0] & TUNER_ENCODING_DELTA) != 0u))
+        {
+            client->skipped_frames++;
+            return TUNER_CLIENT_SKIPPED;
+        }
+    }
+
+    result = tuner_decode_payload(client->image, client->image_size,
+                                  client->block_size, client->payload,
+                                  client->payload_len);
+    if(result != TUNER_DECODE_OK)
+    {
+        client->synced = false;
+        return result;
+    }
+
+    client->synced = true;
+    client->frames++;
+
+    return TUNER_CLIENT_FRAME;
+}
+
+
+/*******************************************************************************
+* Function Name: frame_is_full
+********************************************************************************
+*
+* Summary:
+*   Returns true if the bitmap of the reassembled frame marks every block.
+*
+*******************************************************************************/
+static bool frame_is_full(const tuner_client_t *client)
+{
+    uint16_t block_count = (uint16_t)((client->image_size + client->block_size - 1u) /
+                                      client->block_size);
+
+    if(client->payload_len < (TUNER_PAYLOAD_HDR_SIZE +
+                              ((block_count + BITS_PER_BYTE - 1u) / BITS_PER_BYTE)))
+    {
+        return false;
+    }
+
+    for(uint16_t block = 0; block < block_count; block++)
+    {
+        if((client->payload[TUNER_PAYLOAD_HDR_SIZE + (block / BITS_PER_BYTE)] &
+            (1u << (block % BITS_PER_BYTE))) == 0u)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/*******************************************************************************
+* Function Name: crc16
+********************************************************************************
+*
+* Summary:
+*   Updates a CRC-16/CCITT-FALSE with len bytes of data, one bit at a time.
+*
+*******************************************************************************/
+static uint16_t crc16(uint16_t crc, const uint8_t *data, uint16_t len)
+{
+    for(uint16_t i = 0; i < len; i++)
+    {
+        crc ^= (uint16_t)((uint16_t)data[i] << MSB_SHIFT);
+        for(uint8_t bit = 0; bit < BITS_PER_BYTE; bit++)
+        {
+            crc = ((crc & CRC16_MSB) != 0u) ?
+                  (uint16_t)((uint16_t)(crc << 1) ^ CRC16_POLY) :
+                  (uint16_t)(crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,121 @@
+/******************************************************************************
+* File Name: tuner_client.h
+*
+* Description: This file is public interface of tuner_client.c
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include guard
+ *****************************************************************************/
+#ifndef TUNER_CLIENT_H_
+#define TUNER_CLIENT_H_
+
+/******************************************************************************
+ * Include header files
+ *****************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+/* Return values of tuner_client_receive() */
+#define TUNER_CLIENT_PARTIAL          (0)  /* Packet stored, frame incomplete */
+#define TUNER_CLIENT_INIT             (1)  /* Bridge-init packet received */
+#define TUNER_CLIENT_FRAME            (2)  /* Frame applied to the image */
+#define TUNER_CLIENT_SKIPPED          (3)  /* Frame dropped until resync */
+#define TUNER_CLIENT_ERR_NOT_INIT     (-10)
+#define TUNER_CLIENT_ERR_LENGTH       (-11)
+#define TUNER_CLIENT_ERR_CRC          (-12)
+#define TUNER_CLIENT_ERR_SEQUENCE     (-13)
+#define TUNER_CLIENT_ERR_OVERFLOW     (-14)
+
+
+/******************************************************************************
+ * Data Types
+ *****************************************************************************/
+/* Reassembly state of one GATT client. The image and payload buffers are
+ * provided by the application */
+typedef struct
+{
+    uint8_t *image;              /* Client copy of the streamed image */
+    uint16_t image_capacity;
+    uint8_t *payload;            /* Payload of the frame being reassembled */
+    uint16_t payload_capacity;
+    uint16_t payload_len;
+
+    /* Parameters from the bridge-init packet */
+    bool initialized;
+    uint16_t ds_size;
+    uint16_t chunk_size;
+    uint16_t image_size;
+    uint8_t block_size;
+    uint8_t version;
+    uint8_t features;
+
+    /* Frame in progress and the last frame applied */
+    bool in_frame;
+    uint16_t frame_number;
+    uint16_t next_chunk;
+    uint16_t last_frame;
+    bool last_frame_valid;
+
+    /* The image holds every block; cleared when a frame is lost */
+    bool synced;
+
+    /* Statistics */
+    uint32_t frames;
+    uint32_t packets;
+    uint32_t lost_frames;
+    uint32_t crc_errors;
+    uint32_t skipped_frames;
+} tuner_client_t;
+
+
+/******************************************************************************
+ * Function Prototypes
+ *****************************************************************************/
+void tuner_client_init(tuner_client_t *client, uint8_t *image,
+                       uint16_t image_capacity, uint8_t *payload,
+                       uint16_t payload_capacity);
+int tuner_client_receive(tuner_client_t *client, const uint8_t *packet,
+                         uint16_t len);
+
+
+#endif /* TUNER_CLIENT_H_ */
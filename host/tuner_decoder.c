@@ -0,0 +1,250 @@
+/******************************************************************************
+* File Name: tuner_decoder.c
+*
+* Description: Host-side reference decoder for the tuner frame payload sent by
+*              tuner_ble_server.c. Builds with any C99 compiler; it is not part of the
+*              firmware.
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <string.h>
+#include "tuner_decoder.h"
+
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Frame payload: encoding(1 byte), changed-block bitmap, block data */
+#define TUNER_PAYLOAD_HDR_SIZE       (1u)
+#define TUNER_ENCODING_IDX           (0u)
+#define TUNER_ENCODING_DELTA         (0x01u)
+#define TUNER_ENCODING_ZERO_RLE      (0x02u)
+#define TUNER_ENCODING_MASK          (TUNER_ENCODING_DELTA |\
+                                      TUNER_ENCODING_ZERO_RLE)
+#define BITS_PER_BYTE                (8u)
+#define MSB_SHIFT                    (8u)
+#define MAX_BLOCK_SIZE               (255u)
+
+
+/*******************************************************************************
+ * Data Types
+ ******************************************************************************/
+/* Reader of the block data of a payload */
+typedef struct
+{
+    const uint8_t *data;
+    uint16_t len;
+    uint16_t pos;
+    uint8_t zero_rle;
+    uint8_t zero_run;
+} tuner_data_reader_t;
+
+
+/*******************************************************************************
+ * Function Prototypes
+*******************************************************************************/
+static int read_block_data(tuner_data_reader_t *reader, uint8_t *dst,
+                           uint16_t len);
+
+
+/*******************************************************************************
+* Function Name: tuner_decode_payload
+********************************************************************************
+*
+* Summary:
+*   Applies the payload of one reassembled tuner frame to the client copy of
+*   the streamed image. The copy has to hold the previous frame, since only
+*   the changed blocks are sent and delta-encoded blocks are added to it.
+*
+* Parameters:
+*  uint8_t *image         : Client copy of the streamed image
+*  uint16_t image_size    : Size of the streamed image from the bridge-init
+*                           packet
+*  uint8_t block_size     : Block size from the bridge-init packet
+*  const uint8_t *payload : Frame payload, the notification payloads of one
+*                           frame concatenated without their headers
+*  uint16_t payload_len   : Length of the frame payload
+*
+* Return:
+*   TUNER_DECODE_OK, or a TUNER_DECODE_ERR_* code; the image may be partly
+*   updated on error and should be refreshed by the next key frame
+*
+*******************************************************************************/
+int tuner_decode_payload(uint8_t *image, uint16_t image_size,
+                         uint8_t block_size, const uint8_t *payload,
+                         uint16_t payload_len)
+{
+    tuner_data_reader_t reader;
+    uint8_t block_data[MAX_BLOCK_SIZE];
+    uint16_t block_count = 0;
+    uint16_t bitmap_size = 0;
+    uint16_t start = 0;
+    uint16_t length = 0;
+    uint16_t word = 0;
+    uint8_t encoding = 0;
+    int result = TUNER_DECODE_OK;
+
+    if((block_size == 0u) || (payload_len < TUNER_PAYLOAD_HDR_SIZE))
+    {
+        return TUNER_DECODE_ERR_LENGTH;
+    }
+
+    block_count = (uint16_t)((image_size + block_size - 1u) / block_size);
+    bitmap_size = (uint16_t)((block_count + BITS_PER_BYTE - 1u) / BITS_PER_BYTE);
+    encoding = payload[TUNER_ENCODING_IDX];
+
+    if((encoding & (uint8_t)~TUNER_ENCODING_MASK) != 0u)
+    {
+        return TUNER_DECODE_ERR_ENCODING;
+    }
+
+    if(payload_len < (TUNER_PAYLOAD_HDR_SIZE + bitmap_size))
+    {
+        return TUNER_DECODE_ERR_LENGTH;
+    }
+
+    reader.data = &payload[TUNER_PAYLOAD_HDR_SIZE + bitmap_size];
+    reader.len = (uint16_t)(payload_len - TUNER_PAYLOAD_HDR_SIZE - bitmap_size);
+    reader.pos = 0;
+    reader.zero_rle = ((encoding & TUNER_ENCODING_ZERO_RLE) != 0u);
+    reader.zero_run = 0;
+
+    for(uint16_t block = 0; block < block_count; block++)
+    {
+        if((payload[TUNER_PAYLOAD_HDR_SIZE + (block / BITS_PER_BYTE)] &
+            (1u << (block % BITS_PER_BYTE))) == 0u)
+        {
+            continue;
+        }
+
+        start = (uint16_t)(block * block_size);
+        length = block_size;
+        if((start + length) > image_size)
+        {
+            length = (uint16_t)(image_size - start);
+        }
+
+        result = read_block_data(&reader, block_data, length);
+        if(result != TUNER_DECODE_OK)
+        {
+            return result;
+        }
+
+        if((encoding & TUNER_ENCODING_DELTA) != 0u)
+        {
+            /* Add the 16-bit differences to the previous frame */
+            for(uint16_t j = 0; (j + 1u) < length; j += 2u)
+            {
+                word = (uint16_t)(((uint16_t)image[start + j] |
+                                   ((uint16_t)image[start + j + 1u] << MSB_SHIFT)) +
+                                  ((uint16_t)block_data[j] |
+                                   ((uint16_t)block_data[j + 1u] << MSB_SHIFT)));
+                image[start + j] = (uint8_t)(word & 0x00FFu);
+                image[start + j + 1u] = (uint8_t)(word >> MSB_SHIFT);
+            }
+
+            if((length % 2u) != 0u)
+            {
+                image[start + length - 1u] += block_data[length - 1u];
+            }
+        }
+        else
+        {
+            memcpy(&image[start], block_data, length);
+        }
+    }
+
+    /* All block data has to be consumed */
+    if((reader.pos != reader.len) || (reader.zero_run != 0u))
+    {
+        return TUNER_DECODE_ERR_DATA;
+    }
+
+    return TUNER_DECODE_OK;
+}
+
+
+/*******************************************************************************
+* Function Name: read_block_data
+********************************************************************************
+*
+* Summary:
+*   Reads the next len bytes of block data, expanding zero runs if the
+*   payload is zero-run-length encoded. A zero run may span blocks.
+*
+* Return:
+*   TUNER_DECODE_OK, or TUNER_DECODE_ERR_DATA if the data ends early
+*
+*******************************************************************************/
+static int read_block_data(tuner_data_reader_t *reader, uint8_t *dst,
+                           uint16_t len)
+{
+    for(uint16_t i = 0; i < len; i++)
+    {
+        if(reader->zero_run > 0u)
+        {
+            dst[i] = 0u;
+            reader->zero_run--;
+            continue;
+        }
+
+        if(reader->pos >= reader->len)
+        {
+            return TUNER_DECODE_ERR_DATA;
+        }
+
+        dst[i] = reader->data[reader->pos++];
+
+        if((reader->zero_rle != 0u) && (dst[i] == 0u))
+        {
+            /* Zero byte followed by the run length, this byte included */
+            if((reader->pos >= reader->len) || (reader->data[reader->pos] == 0u))
+            {
+                return TUNER_DECODE_ERR_DATA;
+            }
+            reader->zero_run = (uint8_t)(reader->data[reader->pos++] - 1u);
+        }
+    }
+
+    return TUNER_DECODE_OK;
+}
+
+
+/* [] END OF FILE */
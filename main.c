@@ -45,12 +45,28 @@
 #include "cycfg_capsense.h"
 #include "cycfg_ble.h"
 #include "tuner_ble_server.h"
+#include "tuner_profiler.h"
+#include "tuner_time.h"
+#include "tuner_sample_log.h"
+#include "tuner_summary.h"
+#include "tuner_snr.h"
+#include "tuner_touch_events.h"
+#include "tuner_transport.h"
 
 
 /*******************************************************************************
 * Macros
 *******************************************************************************/
 #define CAPSENSE_INTR_PRIORITY  (7u)
+#define ENABLE                  (1u)
+#define DISABLE                 (0u)
+#define PERCENT                 (100u)
+
+/* Print the number of complete scans of all widgets per second */
+#define SCAN_RATE_REPORT_ENABLE (ENABLE)
+
+/* Put the CPU to sleep while it waits for a scan or the BLE stack */
+#define LOW_POWER_ENABLE        (ENABLE)
 
 
 /*******************************************************************************
@@ -58,6 +74,32 @@
 *******************************************************************************/
 static cy_status initialize_capsense(void);
 static void capsense_isr(void);
+static void capsense_eos_callback(cy_stc_active_scan_sns_t *ptrActiveScan);
+static void main_loop_sleep(void);
+static void scan_rate_init(void);
+static void scan_rate_update(void);
+static void tuner_writes_apply(void);
+static void widget_baseline_reinit(uint32_t widget);
+static void touch_events_update(uint32_t widget);
+
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+/* Complete scans of all widgets in the current one-second window */
+static uint32_t scan_frames = 0;
+
+/* Time base value at the start of the current window and the time the CPU
+ * slept in it */
+static uint32_t scan_rate_window_start = 0;
+static uint32_t scan_rate_sleep_us = 0;
+
+/* Set by the CapSense interrupt when the scan of a widget completes */
+static volatile bool scan_complete = false;
+
+/* Widgets whose raw counts a tuner write changed; the baseline is
+ * initialized again from their first scan with the new settings */
+static bool widget_reinit[CY_CAPSENSE_WIDGET_COUNT];
 
 
 /*******************************************************************************
@@ -68,7 +110,14 @@ static void capsense_isr(void);
 *  - initial setup of device
 *  - initialize CapSense
 *  - initialize ble for tuner communication
-*  - scan touch input continuously.
+*  - scan touch input continuously. The widgets are scanned one at a time;
+*    the scan of the next widget is started before the results of the
+*    previous one are processed, so the CSD hardware keeps scanning while
+*    the CPU processes the results and the radio sends the tuner frame.
+*  - sleep between events. The loop runs when the CapSense interrupt
+*    reports a complete scan or the BLESS interrupt reports stack events.
+*    Scans run back to back, so the periodic tasks still run at least once
+*    per widget scan.
 *
 * Parameters:
 *  void
@@ -82,6 +131,16 @@ int main(void)
     cy_rslt_t result = CY_RSLT_SUCCESS;
     cy_status status = CYRET_SUCCESS;
 
+    /* Widget being scanned and widget whose results are ready */
+    uint32_t scan_widget = 0;
+    uint32_t done_widget = 0;
+
+    /* Time base value at the start of the scan and cycle counter values at
+     * the start of a profiled phase and of the gap between two frames */
+    uint32_t scan_start = 0;
+    uint32_t phase_start = 0;
+    uint32_t gap_start = 0;
+
     /* Initialize the device and board peripherals */
     result = cybsp_init() ;
 
@@ -103,6 +162,9 @@ int main(void)
     /* Enable global interrupts */
     __enable_irq();
 
+    /* Start the time base used by the periodic tasks */
+    tuner_time_init();
+
     /* Initialize CapSense block */
     status = initialize_capsense();
 
@@ -123,27 +185,106 @@ int main(void)
            "Tuning CapSense over BLE - Server"\
            " ****************** \r\n\n");
 
+    profiler_init();
+    scan_rate_init();
+
     /* Start the initial CapSense scan */
-    Cy_CapSense_ScanAllWidgets(&cy_capsense_context);
+    Cy_CapSense_SetupWidget(scan_widget, &cy_capsense_context);
+    Cy_CapSense_Scan(&cy_capsense_context);
+    PROFILER_START_US(scan_start);
 
     for(;;)
     {
-        /* Process the BLE stack events */
+        /* Process the BLE stack events and send pending tuner packets */
         ble_process_events();
 
-        if(CY_CAPSENSE_NOT_BUSY == Cy_CapSense_IsBusy(&cy_capsense_context))
+        if(scan_complete == true)
         {
-            /* Process all widgets */
-            Cy_CapSense_ProcessAllWidgets(&cy_capsense_context);
+            /* Cleared before the next scan is started */
+            scan_complete = false;
+            PROFILER_STOP_US(PROFILER_PHASE_SCAN, scan_start);
+
+            done_widget = scan_widget;
+            scan_widget++;
+
+            if(scan_widget < CY_CAPSENSE_WIDGET_COUNT)
+            {
+                /* Start scanning the next widget first; the scan only
+                 * updates the sensors of that widget, so the results of
+                 * done_widget can be processed meanwhile */
+                Cy_CapSense_SetupWidget(scan_widget, &cy_capsense_context);
+                Cy_CapSense_Scan(&cy_capsense_context);
+                PROFILER_START_US(scan_start);
+
+                widget_baseline_reinit(done_widget);
+                PROFILER_START(phase_start);
+                Cy_CapSense_ProcessWidget(done_widget, &cy_capsense_context);
+                PROFILER_STOP(PROFILER_PHASE_PROCESS, phase_start);
+                touch_events_update(done_widget);
+            }
+            else
+            {
+                /* Last widget of the frame. The scan of the first widget
+                 * cannot start yet: it writes the raw counts of its sensors
+                 * as each conversion ends, while the sample log, the
+                 * summary, the SNR and the tuner snapshot below still read
+                 * the raw counts of this frame, and the queued tuner writes
+                 * must take effect before it starts. The hardware idles
+                 * for the frame_gap phase of the profiler */
+                PROFILER_START(gap_start);
+                widget_baseline_reinit(done_widget);
+                PROFILER_START(phase_start);
+                Cy_CapSense_ProcessWidget(done_widget, &cy_capsense_context);
+                PROFILER_STOP(PROFILER_PHASE_PROCESS, phase_start);
+                touch_events_update(done_widget);
+
+                /* Every widget is processed; log the selected values of
+                 * this scan before the tuner sees only the newest one */
+                tuner_sample_log_record();
+
+                /* The summary is only streamed; skip it without a client */
+                if(tuner_transport_client_connected() == true)
+                {
+                    tuner_summary_update();
+                }
+                else
+                {
+                    tuner_summary_restart();
+                }
+
+                tuner_snr_update();
+
+                /* Establishes synchronized operation between the CapSense
+                 * middleware and the CapSense Tuner tool. This takes a
+                 * snapshot of the results and only starts a frame; the
+                 * notification packets are drained by ble_process_events()
+                 * while the next scan is running.
+                 */
+                PROFILER_START(phase_start);
+                Cy_CapSense_RunTuner(&cy_capsense_context);
+                PROFILER_STOP(PROFILER_PHASE_RUN_TUNER, phase_start);
+
+                /* No scan is running and every result is processed, so
+                 * the queued tuner writes can take effect together */
+                tuner_writes_apply();
+
+                /* Start next scan */
+                scan_widget = 0;
+                Cy_CapSense_SetupWidget(scan_widget, &cy_capsense_context);
+                Cy_CapSense_Scan(&cy_capsense_context);
+                PROFILER_START_US(scan_start);
+                PROFILER_STOP(PROFILER_PHASE_FRAME_GAP, gap_start);
+
+                scan_frames++;
+            }
+        }
 
-            /* Establishes synchronized operation between the CapSense
-             * middleware and the CapSense Tuner tool.
-             */
-            Cy_CapSense_RunTuner(&cy_capsense_context);
+        scan_rate_update();
+        profiler_update();
 
-            /* Start next scan */
-            Cy_CapSense_ScanAllWidgets(&cy_capsense_context);
-        }
+        /* Wait for the next scan to complete or the BLE stack to need the
+         * CPU */
+        main_loop_sleep();
     }
 }
 
@@ -156,6 +297,7 @@ int main(void)
 *  - initializes the CapSense
 *  - configure the CapSense interrupt.
 *  - register callback functions to be used for tuner ble
+*  - register the end of scan callback that wakes the main loop
 *
 *  Return:
 *   - cy_status
@@ -188,6 +330,14 @@ static cy_status initialize_capsense(void)
     /* Register tuner communication callback */
     cy_capsense_context.ptrCommonContext->ptrTunerSendCallback = tuner_send_callback;
 
+    /* Register end of scan callback */
+    if(CYRET_SUCCESS == status)
+    {
+        status = Cy_CapSense_RegisterCallback(CY_CAPSENSE_END_OF_SCAN_E,
+                                              capsense_eos_callback,
+                                              &cy_capsense_context);
+    }
+
     /* To avoid compiler warning*/
     (void) sysint_status;
 
@@ -195,6 +345,79 @@ static cy_status initialize_capsense(void)
 }
 
 
+/*******************************************************************************
+* Function Name: tuner_writes_apply
+********************************************************************************
+* Summary:
+*  Applies the tuner writes received since the last frame and marks the
+*  widgets whose raw counts they change, such as with a new sense clock or
+*  IDAC, for widget_baseline_reinit(). The other widgets keep their
+*  baseline, so changing a threshold does not disturb a finger that is
+*  already on a button.
+*
+*******************************************************************************/
+static void tuner_writes_apply(void)
+{
+    bool changed[CY_CAPSENSE_WIDGET_COUNT];
+
+    if(tuner_transport_writes_apply(changed) == true)
+    {
+        for(uint32_t widget = 0; widget < CY_CAPSENSE_WIDGET_COUNT; widget++)
+        {
+            if(changed[widget] == true)
+            {
+                widget_reinit[widget] = true;
+            }
+        }
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: widget_baseline_reinit
+********************************************************************************
+* Summary:
+*  Initializes the baseline of a widget again if a tuner write changed its
+*  raw counts. Called when the first scan with the new settings is complete
+*  and before its results are processed; the raw counts of the previous
+*  settings would leave the baseline off by the whole change.
+*
+* Parameters:
+*  uint32_t widget : Index of the widget just scanned
+*
+*******************************************************************************/
+static void widget_baseline_reinit(uint32_t widget)
+{
+    if(widget_reinit[widget] == true)
+    {
+        widget_reinit[widget] = false;
+        Cy_CapSense_InitializeWidgetBaseline(widget, &cy_capsense_context);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: touch_events_update
+********************************************************************************
+* Summary:
+*  Queues a touch event if the status of a widget just processed changed and
+*  hands it to the BLE stack right away, ahead of the tuner frame and the
+*  sample log. If the stack is busy, the event goes out before their next
+*  packet.
+*
+* Parameters:
+*  uint32_t widget : Index of the widget just processed
+*
+*******************************************************************************/
+static void touch_events_update(uint32_t widget)
+{
+    if(tuner_touch_events_update(widget) == true)
+    {
+        ble_touch_events_send();
+    }
+}
+
+
 /*******************************************************************************
 * Function Name: capsense_isr
 ********************************************************************************
@@ -208,4 +431,94 @@ static void capsense_isr(void)
 }
 
 
+/*******************************************************************************
+* Function Name: capsense_eos_callback
+********************************************************************************
+* Summary:
+*  Called from capsense_isr() once the scan of a widget is complete and the
+*  CapSense middleware is no longer busy.
+*
+* Parameters:
+*  cy_stc_active_scan_sns_t *ptrActiveScan : Last scanned sensor (unused)
+*
+*******************************************************************************/
+static void capsense_eos_callback(cy_stc_active_scan_sns_t *ptrActiveScan)
+{
+    (void)ptrActiveScan;
+
+    scan_complete = true;
+}
+
+
+/*******************************************************************************
+* Function Name: main_loop_sleep
+********************************************************************************
+* Summary:
+*  Puts the CPU to Sleep until the next interrupt, unless a scan result or a
+*  BLE stack event is already waiting. The check is made with interrupts
+*  disabled so that an event arriving just before the sleep is not missed;
+*  a pending interrupt still wakes the CPU and is taken once interrupts are
+*  enabled again. The time spent sleeping is added to the scan rate report.
+*
+*******************************************************************************/
+static void main_loop_sleep(void)
+{
+#if (LOW_POWER_ENABLE == ENABLE)
+    uint32_t interrupt_state = 0;
+    uint32_t sleep_start = 0;
+
+    interrupt_state = Cy_SysLib_EnterCriticalSection();
+
+    if((scan_complete == false) && (ble_event_pending() == false))
+    {
+        sleep_start = tuner_time_us();
+        (void)Cy_SysPm_CpuEnterSleep(CY_SYSPM_WAIT_FOR_INTERRUPT);
+        scan_rate_sleep_us += tuner_time_us() - sleep_start;
+    }
+
+    Cy_SysLib_ExitCriticalSection(interrupt_state);
+#endif
+}
+
+
+/*******************************************************************************
+* Function Name: scan_rate_init
+********************************************************************************
+* Summary:
+*  Starts the first scan rate window.
+*
+*******************************************************************************/
+static void scan_rate_init(void)
+{
+    scan_frames = 0;
+    scan_rate_sleep_us = 0;
+    scan_rate_window_start = tuner_time_us();
+}
+
+
+/*******************************************************************************
+* Function Name: scan_rate_update
+********************************************************************************
+* Summary:
+*  Prints the number of complete scans of all widgets and the percentage of
+*  the time the CPU slept once every second.
+*
+*******************************************************************************/
+static void scan_rate_update(void)
+{
+    if((tuner_time_us() - scan_rate_window_start) >= TUNER_TIME_US_PER_S)
+    {
+#if (SCAN_RATE_REPORT_ENABLE == ENABLE)
+        printf("Scan rate: %lu scans/s, CPU asleep %lu%%\r\n",
+               (unsigned long)scan_frames,
+               (unsigned long)(scan_rate_sleep_us /\
+                               (TUNER_TIME_US_PER_S / PERCENT)));
+#endif
+        scan_frames = 0;
+        scan_rate_sleep_us = 0;
+        scan_rate_window_start += TUNER_TIME_US_PER_S;
+    }
+}
+
+
 /* [] END OF FILE */
@@ -47,6 +47,13 @@
 #include "cycfg_ble.h"
 #include "cy_retarget_io.h"
 #include "tuner_ble_server.h"
+#include "tuner_transport.h"
+#include "tuner_link.h"
+#include "tuner_profiler.h"
+#include "tuner_time.h"
+#include "tuner_sample_log.h"
+#include "tuner_snr.h"
+#include "tuner_touch_events.h"
 
 
 /*******************************************************************************
@@ -56,6 +63,10 @@
 #define DISABLE                      (0u)
 #define CY_ASSERT_FAILED             (0u)
 #define DEBUG_BLE_ENABLE             (DISABLE)
+
+/* Print the tuner transport benchmark results once every second */
+#define TUNER_BENCH_REPORT_ENABLE    (DISABLE)
+
 #if DEBUG_BLE_ENABLE
 #define DEBUG_PRINTF                 (printf)
 #else
@@ -64,60 +75,214 @@
 
 /* BLE related macros */
 #define BLESS_INTR_PRIORITY          (1u)
-#define NOTIFICATION_PKT_SIZE        (492u)
 #define SUCCESS                      (0U)
 #define DEVICE_NAME_LENGTH           (20u)
-#define DEFAULT_NOTIFICATION_COUNT   (1u)
 
-/* Length of notification packet to send size of CapSense structure(2 bytes)
- * No of notification packets required to send complete CapSense data(1 byte) */
-#define TUNER_BRIDGE_INIT_NTF_SIZE   (3u)
-#define CAPSENSE_DS_SIZE_LSB_IDX     (0u)
-#define CAPSENSE_DS_SIZE_MSB_IDX     (1u)
-#define NOTIFICATION_COUNT_IDX       (2u)
+/* ATT opcode and handle in front of a notification value */
+#define ATT_NTF_HEADER_SIZE          (3u)
+
+/* ATT opcode in front of a read or read blob response value */
+#define ATT_READ_RSP_HEADER_SIZE     (1u)
+
+/* Connection i streams through tuner transport session i */
+#if (CY_BLE_CONN_COUNT > TUNER_MAX_SESSIONS)
+#error "TUNER_MAX_SESSIONS has to cover every BLE connection"
+#endif
 
-/* Custom Tuner command packet received from GATT Client - 7 bytes */
-#define TUNER_COMMAND_SIZE_0_IDX     (0u)
-#define TUNER_COMMAND_OFFS_0_IDX     (1u)
-#define TUNER_COMMAND_OFFS_1_IDX     (2u)
-#define TUNER_COMMAND_DATA_0_IDX     (3u)
-#define TUNER_COMMAND_DATA_1_IDX     (4u)
-#define TUNER_COMMAND_DATA_2_IDX     (5u)
-#define TUNER_COMMAND_DATA_3_IDX     (6u)
-#define TUNER_COMMAND_PACKET_SIZE    (7u)
-#define MAX_DATA_LENGTH              (4u)
-#define MSB_SHIFT                    (8u)
+/* Returned when no connection matches */
+#define NO_SESSION                   (0xFFu)
+
+/* Link_Stats characteristic, all values LSB first:
+ * Frames started(4 bytes)
+ * Frames completed by every client taking part(4 bytes)
+ * Frames aborted for a client by a disconnection or a new subscription
+ * (4 bytes)
+ * Notification packets accepted by the BLE stack(4 bytes)
+ * Notification packets refused by the BLE stack(4 bytes)
+ * Busy polls: the stack was busy while a packet was ready(4 bytes)
+ * Last CY_BLE_ERROR_* code returned for a notification(2 bytes)
+ * ATT MTU(2 bytes)
+ * LL data length, transmit octets(2 bytes)
+ * Transmit PHY and receive PHY, CY_BLE_PHY_MASK_* (1 byte each)
+ * Connections(2 bytes)
+ * Disconnections(2 bytes)
+ * HCI reasons of the last disconnections, newest first(1 byte each)
+ * Event busy polls: a touch event was ready but the stack was busy or
+ * refused it(4 bytes)
+ * Longest touch event latency of the last second, from the processing of
+ * the widget to the hand-off of the event, in microseconds(4 bytes)
+ * The counters run from power-up and are shared by all connections. The
+ * MTU, data length and PHY are those of the connection the value is
+ * notified on; the value read from the GATT database carries the link of
+ * the first subscribed connection. The value is refreshed once a second and
+ * notified if notifications are enabled and the ATT MTU is large enough */
+#define LINK_STATS_SIZE              (48u)
+#define LINK_STATS_REASON_COUNT      (4u)
+#define BYTE_SHIFT                   (8u)
+
+/* Tuner_Control characteristic, all values LSB first:
+ * Target frame rate in frames/s, 0 for as fast as the link allows(2 bytes)
+ * Frames completed during the last second(2 bytes)
+ * Frames skipped during the last second(2 bytes)
+ * The client writes the target only, as a 2-byte value; it applies to all
+ * clients. A frame is skipped when a scan completes while the previous
+ * frame is still in flight or the next one is not due yet. Its changes are
+ * not lost: the next frame is taken from the newest snapshot and carries
+ * every block that changed since the last frame sent */
+#define TUNER_CONTROL_SIZE           (6u)
+#define TUNER_CONTROL_TARGET_SIZE    (2u)
+
+/* Tuner_Range characteristic: the client writes the offset and the length
+ * of a range of cy_capsense_tuner (2 bytes each, LSB first) and reads the
+ * range back with a read request. Each connection has its own range; until
+ * one is written, it is the start of the structure. A range has to fit in
+ * one read response, so every read holds the values of a single scan; the
+ * client walks a larger part of the structure by writing the next offset */
+#define TUNER_RANGE_WRITE_SIZE       (4u)
+#define TUNER_RANGE_MAX_SIZE         (512u)
 
 
 /*******************************************************************************
- * Global variables
+ * Data Types
  ******************************************************************************/
-/* No of notification packets to send one complete CapSense structure */
-static uint8_t count = DEFAULT_NOTIFICATION_COUNT;
+/* States of the tuner transmit state machine */
+typedef enum
+{
+    TUNER_TX_IDLE,          /* No frame in flight */
+    TUNER_TX_SENDING        /* Notification packets of a frame are pending */
+} tuner_tx_state_t;
+
+
+/* State of one BLE connection */
+typedef struct
+{
+    cy_stc_ble_conn_handle_t conn_handle;
+    bool connected;
+    bool notification_enabled;  /* CapSense_DS notifications */
+    bool link_stats_notify;     /* Link_Stats notifications */
+    bool control_notify;        /* Tuner_Control notifications */
+    bool samples_notify;        /* Tuner_Samples notifications */
+    bool stats_notify;          /* Sensor_Stats notifications */
+    bool stats_ntf_pending;     /* Sensor_Stats header not notified yet */
+    bool events_notify;         /* Touch_Events notifications */
+    uint16_t range_offset;      /* Tuner_Range window */
+    uint16_t range_len;         /* 0 until the client writes one */
+} ble_session_t;
+
+
+/* Link statistics since power-up, sent over the Link_Stats characteristic */
+typedef struct
+{
+    uint32_t frames_started;
+    uint32_t frames_completed;
+    uint32_t frames_aborted;
+    uint32_t notifications;     /* Frame packets accepted by the BLE stack */
+    uint32_t ntf_errors;        /* Frame packets refused by the BLE stack */
+    uint32_t busy_polls;        /* Stack busy while a packet was ready */
+    uint16_t last_error;
+    uint16_t connections;
+    uint16_t disconnections;
+    uint8_t disconnect_reasons[LINK_STATS_REASON_COUNT];
+    uint32_t event_busy_polls;  /* Stack busy while a touch event was ready */
+    uint32_t event_latency_max; /* Touch event latency of the last window */
+} link_stats_t;
+
+
+/* Frame rate control */
+typedef struct
+{
+    uint16_t target;            /* Frames per second, 0 for no limit */
+    uint32_t period;            /* Microseconds between frame starts */
+    uint32_t next_frame;        /* Time base value the next frame is due */
+    uint16_t achieved;          /* Frames completed in the last window */
+    uint16_t skipped;           /* Frames skipped in the last window */
+    uint32_t window_skipped;    /* Frames skipped in the current window */
+} tuner_rate_t;
 
-/* Buffer to hold Tuner receive command packet */
-static uint8_t ble_write_buffer[TUNER_COMMAND_PACKET_SIZE] = {0};
 
-/* Size of the CapSense data structure */
-static uint16_t capsense_ds_size = 0;
+/* Transport benchmark values of the current one-second window */
+typedef struct
+{
+    link_stats_t base;          /* Link statistics at the window start */
+    uint32_t bytes;             /* Bytes of the accepted frame packets */
+    uint32_t latency_sum;       /* Microseconds from snapshot to last packet */
+    uint32_t latency_max;
+} tuner_bench_t;
 
-/* To indicate that notification is enabled by GATT client */
-static volatile bool ble_notification_enabled = false;
 
-/* To store the connection handle */
-static cy_stc_ble_conn_handle_t appConnHandle;
+/*******************************************************************************
+ * Global variables
+ ******************************************************************************/
+/* BLE connections, indexed like the tuner transport sessions and the links
+ * of tuner_link.c */
+static ble_session_t ble_sessions[CY_BLE_CONN_COUNT];
 
 /* To send notification packet to GATT client */
 static cy_stc_ble_gatts_handle_value_ntf_t notificationPacket;
 
-static volatile bool ble_disconnected = false;
+/* State of the tuner transmit state machine */
+static tuner_tx_state_t tuner_tx_state = TUNER_TX_IDLE;
+
+/* Link statistics */
+static link_stats_t link_stats;
+
+/* Transport benchmark values, the time base value at the start of the
+ * current one-second window and at the start of the frame in flight */
+static tuner_bench_t tuner_bench;
+static uint32_t stats_window_start = 0;
+static uint32_t frame_start_time = 0;
+
+/* Frame rate target and the rates achieved in the last window */
+static tuner_rate_t tuner_rate;
+
+/* Sample packet being handed to the BLE stack */
+static uint8_t sample_packet[TUNER_SAMPLE_PKT_MAX_SIZE];
+
+/* Touch event packet being handed to the BLE stack */
+static uint8_t touch_event_packet[TUNER_TOUCH_EVENT_PKT_MAX_SIZE];
+
+/* Sensor_Stats value: the client writes the phase and the number of scans
+ * of a statistics run, see tuner_snr.c. The value holds the results of the
+ * last run and is updated when a run starts and when it finishes. A
+ * notification carries the header only; the client reads the records with
+ * read and read blob requests */
+static uint8_t sensor_stats_value[TUNER_SNR_VALUE_SIZE];
+
+/* Set by the BLE stack when it has events for Cy_BLE_ProcessEvents(); lets
+ * the main loop sleep while there is nothing to do */
+static volatile bool ble_event_flag = true;
 
 
 /*******************************************************************************
  * Function Prototypes
 *******************************************************************************/
 static void bless_interrupt_handler(void);
+static void ble_app_host_callback(void);
 static void stack_event_handler(uint32_t event, void* eventParam);
+static uint8_t ble_session_find(uint8_t bd_handle);
+static uint8_t ble_session_count(void);
+static uint8_t ble_session_primary(void);
+static void ble_session_unsubscribe(uint8_t session);
+static void tuner_tx_process(void);
+static void tuner_session_send(uint8_t session);
+static void tuner_samples_send(uint8_t session);
+static bool tuner_touch_events_send(uint8_t session);
+static uint16_t tuner_sample_packet_size(uint8_t session);
+static uint16_t tuner_sample_packet_size_min(uint8_t session);
+static bool tuner_send_bridge_init(uint8_t session);
+static void tuner_stats_update(void);
+static void link_stats_publish(void);
+static uint16_t link_stats_pack(uint8_t session, uint8_t *buffer);
+static void ble_write_error_rsp(const cy_stc_ble_gatt_write_param_t *write_req_param,\
+                                cy_en_ble_gatt_err_code_t error_code);
+static void tuner_rate_set(uint16_t target);
+static bool tuner_rate_due(void);
+static void tuner_rate_frame_started(void);
+static void tuner_control_publish(void);
+static bool tuner_range_set(uint8_t session, const uint8_t *data, uint16_t len);
+static void tuner_range_read(uint8_t session);
+static void sensor_stats_publish(void);
+static void sensor_stats_notify(void);
 
 
 /*******************************************************************************
@@ -133,6 +298,21 @@ static void bless_interrupt_handler(void)
 }
 
 
+/*******************************************************************************
+* Function Name: ble_app_host_callback
+********************************************************************************
+* Summary:
+*  Called by the BLE stack, from the BLESS interrupt, when the host has events
+*  to process. The interrupt itself wakes the CPU; the flag keeps the main
+*  loop from going back to sleep before it has called ble_process_events().
+*
+*******************************************************************************/
+static void ble_app_host_callback(void)
+{
+    ble_event_flag = true;
+}
+
+
 /*******************************************************************************
  * Function Name: ble_capsense_tuner_init()
  *******************************************************************************
@@ -168,6 +348,9 @@ void ble_capsense_tuner_init(void)
     /* Register the generic event handler */
     Cy_BLE_RegisterEventCallback(stack_event_handler);
 
+    /* Register the callback that reports pending stack events */
+    (void)Cy_BLE_RegisterAppHostCallback(ble_app_host_callback);
+
     /* Initialize the BLE host */
     apiResult = Cy_BLE_Init(&cy_ble_config);
 
@@ -212,6 +395,10 @@ void ble_capsense_tuner_init(void)
 static void stack_event_handler(uint32_t event, void* eventParam)
 {
     cy_en_ble_api_result_t apiResult = CY_BLE_SUCCESS;
+    uint8_t session = NO_SESSION;
+
+    /* Link parameters and their negotiation */
+    tuner_link_event(event, eventParam);
 
     switch(event)
     {
@@ -262,9 +449,9 @@ static void stack_event_handler(uint32_t event, void* eventParam)
             printf("%s\n\r",device_name);
         }
         else if((adv_state == CY_BLE_ADV_STATE_STOPPED) &&\
-                (Cy_BLE_GetConnectionState(appConnHandle) ==\
-                 CY_BLE_CONN_STATE_DISCONNECTED))
+                (ble_session_count() < CY_BLE_CONN_COUNT))
         {
+            /* Keep advertising while another client can connect */
             printf("Restarting Advertisement \r\n");
             printf("\n\rDevice is advertising with name: ");
             Cy_BLE_GetLocalName(device_name);
@@ -285,50 +472,47 @@ static void stack_event_handler(uint32_t event, void* eventParam)
         cy_stc_ble_gap_enhance_conn_complete_param_t *conn_param =\
                 (cy_stc_ble_gap_enhance_conn_complete_param_t *)eventParam;
 
-        /* Variable to store values to update PHY to 2M */
-        cy_stc_ble_set_phy_info_t phy_param;
-        phy_param.allPhyMask = CY_BLE_PHY_NO_PREF_MASK_NONE;
-        phy_param.bdHandle = appConnHandle.bdHandle;
-        phy_param.rxPhyMask = CY_BLE_PHY_MASK_LE_2M;
-        phy_param.txPhyMask = CY_BLE_PHY_MASK_LE_2M;
+        /* Take the first free session */
+        for(session = 0; session < CY_BLE_CONN_COUNT; session++)
+        {
+            if(ble_sessions[session].connected == false)
+            {
+                break;
+            }
+        }
+
+        if(session == CY_BLE_CONN_COUNT)
+        {
+            DEBUG_PRINTF("No free session for BDhandle 0x%02X\r\n",\
+                          conn_param->bdHandle);
+            break;
+        }
 
         printf("\n\rConnected to device: ");
         for(uint8_t i = (CY_BLE_BD_ADDR_SIZE); i > 0u; i--)
         {
             printf(" %X", conn_param->peerBdAddr[i - 1u]);
         }
+        printf(" (GATT Client %u)\r\n", session);
 
         DEBUG_PRINTF("\r\nBDhandle : 0x%02X\r\n", conn_param->bdHandle);
 
-        /* Reset notification enabled flag */
-        ble_notification_enabled = false;
+        /* The ATT connection ID is known at CY_BLE_EVT_GATT_CONNECT_IND */
+        memset(&ble_sessions[session], 0, sizeof(ble_session_t));
+        ble_sessions[session].conn_handle.bdHandle = conn_param->bdHandle;
+        ble_sessions[session].conn_handle.attId = CY_BLE_INVALID_CONN_HANDLE_VALUE;
+        ble_sessions[session].connected = true;
+        link_stats.connections++;
 
-        /* Reset ble_disconnected enabled flag */
-        ble_disconnected = false;
+        /* The main loop learns of the client in order with its writes */
+        tuner_transport_connection_event(session, true);
+
+        /* Negotiate the data length, the PHY and the connection interval;
+         * the MTU and data length start at their defaults */
+        tuner_link_start(session, conn_param->bdHandle, conn_param->connIntv);
 
         /* Turn ON the user LED when ble connection is established */
         cyhal_gpio_write((cyhal_gpio_t)CYBSP_USER_LED1, CYBSP_LED_STATE_ON);
-
-        /* Function call to set PHY to 2M */
-        apiResult = Cy_BLE_SetPhy(&phy_param);
-        if(apiResult == CY_BLE_SUCCESS)
-        {
-            DEBUG_PRINTF("Set PHY to 2M successfull");
-            DEBUG_PRINTF("Request sent to switch PHY to 2M\r\n");
-        }
-        else
-        {
-            DEBUG_PRINTF("Set PHY to 2M API failure, errorcode = 0x%X", apiResult);
-        }
-        break;
-    }
-
-    /* This event is triggered when there is a change to either the maximum
-     * Payload length or the maximum transmission time of Data Channel PDUs in
-     * either direction */
-    case CY_BLE_EVT_DATA_LENGTH_CHANGE:
-    {
-        DEBUG_PRINTF("CY_BLE_EVT_DATA_LENGTH_CHANGE \r\n");
         break;
     }
 
@@ -336,46 +520,49 @@ static void stack_event_handler(uint32_t event, void* eventParam)
      * establish connection. */
     case CY_BLE_EVT_GAP_DEVICE_DISCONNECTED:
     {
-        if(Cy_BLE_GetConnectionState(appConnHandle) ==\
-                                            CY_BLE_CONN_STATE_DISCONNECTED)
+        cy_stc_ble_gap_disconnect_param_t *disc_param =\
+                (cy_stc_ble_gap_disconnect_param_t *)eventParam;
+
+        /* Keep the HCI reason, newest first */
+        memmove(&link_stats.disconnect_reasons[1], link_stats.disconnect_reasons,\
+                LINK_STATS_REASON_COUNT - 1u);
+        link_stats.disconnect_reasons[0] = disc_param->reason;
+        link_stats.disconnections++;
+
+        session = ble_session_find(disc_param->bdHandle);
+        if(session != NO_SESSION)
         {
             DEBUG_PRINTF("CY_BLE_EVT_GAP_DEVICE_DISCONNECTED %d\r\n",\
                     CY_BLE_CONN_STATE_DISCONNECTED);
-            printf("Disconnected. \r\n\n");
+            printf("GATT Client %u disconnected. \r\n\n", session);
+
+            /* Drop the rest of its frame; the other clients keep going */
+            ble_session_unsubscribe(session);
+            tuner_link_stop(session);
+            ble_sessions[session].connected = false;
+            ble_sessions[session].link_stats_notify = false;
+            ble_sessions[session].control_notify = false;
+            ble_sessions[session].samples_notify = false;
+            ble_sessions[session].stats_notify = false;
+            ble_sessions[session].stats_ntf_pending = false;
+            ble_sessions[session].events_notify = false;
+            tuner_sample_log_unsubscribe(session);
+            tuner_touch_events_unsubscribe(session);
+            tuner_transport_connection_event(session, false);
         }
 
-        /* Set ble_disconnected flag to true */
-        ble_disconnected = true;
-
-        /*Reset ble_notification_enabled flag to false */
-        ble_notification_enabled = false;
-
-        /* BLE disconnected - turn off LED */
-        cyhal_gpio_write((cyhal_gpio_t)CYBSP_USER_LED1, CYBSP_LED_STATE_OFF);
-
-        /* Device disconnected; restart advertisement */
-        Cy_BLE_GAPP_StartAdvertisement(CY_BLE_ADVERTISING_FAST,\
-                                       CY_BLE_PERIPHERAL_CONFIGURATION_0_INDEX);
-        break;
-    }
+        /* All BLE links are down - turn off LED */
+        if(ble_session_count() == 0u)
+        {
+            cyhal_gpio_write((cyhal_gpio_t)CYBSP_USER_LED1, CYBSP_LED_STATE_OFF);
+        }
 
-    /* This event indicates that the controller has changed the transmitter
-     * PHY or receiver PHY in use */
-    case CY_BLE_EVT_PHY_UPDATE_COMPLETE:
-    {
-        DEBUG_PRINTF("UPDATE PHY parameters\r\n");
-        /* To remove unused parameter warning when UART debug is disabled */
-#if (DEBUG_BLE_ENABLE == ENABLE)
-        cy_stc_ble_events_param_generic_t *param =\
-                (cy_stc_ble_events_param_generic_t *)eventParam;
-        cy_stc_ble_phy_param_t *phyparam = NULL;
-        if(param->status == SUCCESS)
+        /* A connection is free again; restart advertisement */
+        if(Cy_BLE_GetAdvertisementState() == CY_BLE_ADV_STATE_STOPPED)
         {
-            phyparam = (cy_stc_ble_phy_param_t *)param->eventParams;
-            DEBUG_PRINTF("RxPhy Mask : 0x%02X\r\nTxPhy Mask : 0x%02X\r\n",\
-                    phyparam->rxPhyMask, phyparam->txPhyMask);
+            Cy_BLE_GAPP_StartAdvertisement(CY_BLE_ADVERTISING_FAST,\
+                                           CY_BLE_PERIPHERAL_CONFIGURATION_0_INDEX);
         }
-#endif
         break;
     }
 
@@ -387,11 +574,18 @@ static void stack_event_handler(uint32_t event, void* eventParam)
      * completed with peer Central device. */
     case CY_BLE_EVT_GATT_CONNECT_IND:
     {
-        appConnHandle = *(cy_stc_ble_conn_handle_t *)eventParam;
+        cy_stc_ble_conn_handle_t conn_handle =\
+                *(cy_stc_ble_conn_handle_t *)eventParam;
+
         DEBUG_PRINTF("CY_BLE_EVT_GATT_CONNECT_IND: %x, %x \r\n",\
-                      appConnHandle.attId,\
-                      appConnHandle.bdHandle);
-        Cy_BLE_GetPhy(appConnHandle.bdHandle);
+                      conn_handle.attId,\
+                      conn_handle.bdHandle);
+
+        session = ble_session_find(conn_handle.bdHandle);
+        if(session != NO_SESSION)
+        {
+            ble_sessions[session].conn_handle = conn_handle;
+        }
         break;
     }
 
@@ -400,39 +594,21 @@ static void stack_event_handler(uint32_t event, void* eventParam)
     {
         DEBUG_PRINTF("CY_BLE_EVT_GATT_DISCONNECT_IND \r\n");
 
-        if(appConnHandle.bdHandle ==\
-                (*(cy_stc_ble_conn_handle_t *)eventParam).bdHandle)
+        /* The session is released at CY_BLE_EVT_GAP_DEVICE_DISCONNECTED */
+        session = ble_session_find((*(cy_stc_ble_conn_handle_t *)eventParam).bdHandle);
+        if(session != NO_SESSION)
         {
-            appConnHandle.bdHandle = CY_BLE_INVALID_CONN_HANDLE_VALUE;
-            appConnHandle.attId    = CY_BLE_INVALID_CONN_HANDLE_VALUE;
+            ble_session_unsubscribe(session);
+            ble_sessions[session].conn_handle.attId = CY_BLE_INVALID_CONN_HANDLE_VALUE;
         }
 
         break;
     }
 
-    /* This event is triggered when GATT MTU Exchange Request received from
-     * GATT client device. */
-    case CY_BLE_EVT_GATTS_XCNHG_MTU_REQ:
-    {
-        /* To remove unused parameter warning when UART debug is disabled */
-#if (DEBUG_BLE_ENABLE == ENABLE)
-        uint16_t negotiated_mtu = 0;
-        negotiated_mtu =\
-        (((cy_stc_ble_gatt_xchg_mtu_param_t *)eventParam)->mtu < CY_BLE_GATT_MTU) ?\
-        ((cy_stc_ble_gatt_xchg_mtu_param_t *)eventParam)->mtu : CY_BLE_GATT_MTU;
-        DEBUG_PRINTF("CY_BLE_EVT_GATTS_XCNHG_MTU_REQ negotiated = %d\r\n",\
-                      negotiated_mtu);
-#endif
-        break;
-    }
-
     /* This event is triggered when a  write request is received from a peer
      * Client device */
     case CY_BLE_EVT_GATTS_WRITE_REQ:
     {
-        uint16_t size = 0;
-        uint8_t tuner_init_buffer[TUNER_BRIDGE_INIT_NTF_SIZE] = {0};
-
         cy_stc_ble_gatt_write_param_t *write_req_param =\
                 (cy_stc_ble_gatt_write_param_t *)eventParam;
         cy_stc_ble_gatts_db_attr_val_info_t attr_param;
@@ -443,64 +619,191 @@ static void stack_event_handler(uint32_t event, void* eventParam)
         attr_param.handleValuePair = write_req_param->handleValPair;
         attr_param.offset = 0;
 
-        if(write_req_param->handleValPair.attrHandle ==\
-           CY_BLE_CAPSENSE_TUNER_CAPSENSE_DS_CLIENT_CHARACTERISTIC_CONFIGURATION_DESC_HANDLE)
+        session = ble_session_find(write_req_param->connHandle.bdHandle);
+
+        if((write_req_param->handleValPair.attrHandle ==\
+            CY_BLE_CAPSENSE_TUNER_CAPSENSE_DS_CLIENT_CHARACTERISTIC_CONFIGURATION_DESC_HANDLE) &&\
+           (session != NO_SESSION))
         {
             /* Write Response to GATT Client in response to Write request */
             Cy_BLE_GATTS_WriteRsp(write_req_param->connHandle);
 
-            Cy_BLE_GATTS_WriteAttributeValuePeer(&appConnHandle, &(write_req_param->handleValPair));
+            Cy_BLE_GATTS_WriteAttributeValuePeer(&write_req_param->connHandle,\
+                    &(write_req_param->handleValPair));
 
-            ble_notification_enabled = attr_param.handleValuePair.value.val[0];
-            notificationPacket.connHandle = appConnHandle;
-            notificationPacket.handleValPair.attrHandle =\
-                    CY_BLE_CAPSENSE_TUNER_CAPSENSE_DS_CHAR_HANDLE;
+            /* Drop a frame still in flight from a previous subscription */
+            ble_session_unsubscribe(session);
 
             /* If notification is enabled, send size of CapSense data structure
              * and the number of notification packets required to send the
              * CapSense data structure to the GATT client to initialize the
              * Tuner bridge */
-            if(ble_notification_enabled == true)
+            if(attr_param.handleValuePair.value.val[0] != 0u)
+            {
+                printf("\n\rNotifications enabled by GATT Client %u... \n\r",\
+                       session);
+
+                ble_sessions[session].notification_enabled = true;
+                tuner_transport_subscribe(session);
+
+                (void)tuner_send_bridge_init(session);
+            }
+        }
+        else if((write_req_param->handleValPair.attrHandle ==\
+                 CY_BLE_CAPSENSE_TUNER_LINK_STATS_CLIENT_CHARACTERISTIC_CONFIGURATION_DESC_HANDLE) &&\
+                (session != NO_SESSION))
+        {
+            Cy_BLE_GATTS_WriteRsp(write_req_param->connHandle);
+            Cy_BLE_GATTS_WriteAttributeValuePeer(&write_req_param->connHandle,\
+                    &(write_req_param->handleValPair));
+            ble_sessions[session].link_stats_notify =\
+                    ((attr_param.handleValuePair.value.val[0] &\
+                      CY_BLE_CCCD_NOTIFICATION) != 0u);
+        }
+        else if((write_req_param->handleValPair.attrHandle ==\
+                 CY_BLE_CAPSENSE_TUNER_TUNER_CONTROL_CLIENT_CHARACTERISTIC_CONFIGURATION_DESC_HANDLE) &&\
+                (session != NO_SESSION))
+        {
+            Cy_BLE_GATTS_WriteRsp(write_req_param->connHandle);
+            Cy_BLE_GATTS_WriteAttributeValuePeer(&write_req_param->connHandle,\
+                    &(write_req_param->handleValPair));
+            ble_sessions[session].control_notify =\
+                    ((attr_param.handleValuePair.value.val[0] &\
+                      CY_BLE_CCCD_NOTIFICATION) != 0u);
+        }
+        else if((write_req_param->handleValPair.attrHandle ==\
+                 CY_BLE_CAPSENSE_TUNER_TUNER_SAMPLES_CLIENT_CHARACTERISTIC_CONFIGURATION_DESC_HANDLE) &&\
+                (session != NO_SESSION))
+        {
+            Cy_BLE_GATTS_WriteRsp(write_req_param->connHandle);
+            Cy_BLE_GATTS_WriteAttributeValuePeer(&write_req_param->connHandle,\
+                    &(write_req_param->handleValPair));
+            ble_sessions[session].samples_notify =\
+                    ((attr_param.handleValuePair.value.val[0] &\
+                      CY_BLE_CCCD_NOTIFICATION) != 0u);
+
+            if(ble_sessions[session].samples_notify == true)
+            {
+                tuner_sample_log_subscribe(session);
+            }
+            else
+            {
+                tuner_sample_log_unsubscribe(session);
+            }
+        }
+        else if((write_req_param->handleValPair.attrHandle ==\
+                 CY_BLE_CAPSENSE_TUNER_SENSOR_STATS_CLIENT_CHARACTERISTIC_CONFIGURATION_DESC_HANDLE) &&\
+                (session != NO_SESSION))
+        {
+            Cy_BLE_GATTS_WriteRsp(write_req_param->connHandle);
+            Cy_BLE_GATTS_WriteAttributeValuePeer(&write_req_param->connHandle,\
+                    &(write_req_param->handleValPair));
+            ble_sessions[session].stats_notify =\
+                    ((attr_param.handleValuePair.value.val[0] &\
+                      CY_BLE_CCCD_NOTIFICATION) != 0u);
+            ble_sessions[session].stats_ntf_pending = false;
+        }
+        else if((write_req_param->handleValPair.attrHandle ==\
+                 CY_BLE_CAPSENSE_TUNER_TOUCH_EVENTS_CLIENT_CHARACTERISTIC_CONFIGURATION_DESC_HANDLE) &&\
+                (session != NO_SESSION))
+        {
+            Cy_BLE_GATTS_WriteRsp(write_req_param->connHandle);
+            Cy_BLE_GATTS_WriteAttributeValuePeer(&write_req_param->connHandle,\
+                    &(write_req_param->handleValPair));
+            ble_sessions[session].events_notify =\
+                    ((attr_param.handleValuePair.value.val[0] &\
+                      CY_BLE_CCCD_NOTIFICATION) != 0u);
+
+            if(ble_sessions[session].events_notify == true)
+            {
+                tuner_touch_events_subscribe(session);
+            }
+            else
+            {
+                tuner_touch_events_unsubscribe(session);
+            }
+        }
+        else if(write_req_param->handleValPair.attrHandle ==\
+                CY_BLE_CAPSENSE_TUNER_SENSOR_STATS_CHAR_HANDLE)
+        {
+            /* The run is not kept in the value, which carries the results */
+            if(tuner_snr_start(write_req_param->handleValPair.value.val,\
+                               write_req_param->handleValPair.value.len) == true)
+            {
+                Cy_BLE_GATTS_WriteRsp(write_req_param->connHandle);
+                sensor_stats_publish();
+            }
+            else
+            {
+                ble_write_error_rsp(write_req_param,\
+                                    CY_BLE_GATT_ERR_INVALID_ATTRIBUTE_LEN);
+            }
+        }
+        else if(write_req_param->handleValPair.attrHandle ==\
+                CY_BLE_CAPSENSE_TUNER_TUNER_SAMPLES_CHAR_HANDLE)
+        {
+            /* The selection is not kept in the value, which carries the
+             * notified sample packets */
+            if((session != NO_SESSION) &&\
+               (tuner_sample_log_configure(write_req_param->handleValPair.value.val,\
+                    write_req_param->handleValPair.value.len,\
+                    tuner_sample_packet_size_min(session)) == true))
+            {
+                Cy_BLE_GATTS_WriteRsp(write_req_param->connHandle);
+            }
+            else
+            {
+                ble_write_error_rsp(write_req_param,\
+                                    CY_BLE_GATT_ERR_INVALID_ATTRIBUTE_LEN);
+            }
+        }
+        else if(write_req_param->handleValPair.attrHandle ==\
+                CY_BLE_CAPSENSE_TUNER_TUNER_RANGE_CHAR_HANDLE)
+        {
+            if((session != NO_SESSION) &&\
+               (tuner_range_set(session, write_req_param->handleValPair.value.val,\
+                    write_req_param->handleValPair.value.len) == true))
+            {
+                Cy_BLE_GATTS_WriteRsp(write_req_param->connHandle);
+            }
+            else
+            {
+                ble_write_error_rsp(write_req_param,\
+                                    CY_BLE_GATT_ERR_INVALID_ATTRIBUTE_LEN);
+            }
+        }
+        else if(write_req_param->handleValPair.attrHandle ==\
+                CY_BLE_CAPSENSE_TUNER_TUNER_CONTROL_CHAR_HANDLE)
+        {
+            if(write_req_param->handleValPair.value.len == TUNER_CONTROL_TARGET_SIZE)
+            {
+                tuner_rate_set((uint16_t)write_req_param->handleValPair.value.val[0] |\
+                    ((uint16_t)write_req_param->handleValPair.value.val[1] << BYTE_SHIFT));
+                Cy_BLE_GATTS_WriteRsp(write_req_param->connHandle);
+
+                /* The achieved rates stay in the value; refresh it */
+                tuner_control_publish();
+            }
+            else
+            {
+                ble_write_error_rsp(write_req_param,\
+                                    CY_BLE_GATT_ERR_INVALID_ATTRIBUTE_LEN);
+            }
+        }
+        else if(write_req_param->handleValPair.attrHandle ==\
+                CY_BLE_CAPSENSE_TUNER_TUNER_REGIONS_CHAR_HANDLE)
+        {
+            if(tuner_transport_regions_write(write_req_param->handleValPair.value.val,\
+                    write_req_param->handleValPair.value.len) == true)
+            {
+                Cy_BLE_GATTS_WriteAttributeValuePeer(&write_req_param->connHandle,\
+                        &(write_req_param->handleValPair));
+                Cy_BLE_GATTS_WriteRsp(write_req_param->connHandle);
+            }
+            else
             {
-                printf("\n\rNotifications enabled... \n\r");
-                printf("\n\rSending Tuner bridge initialization parameters"\
-                           "to GATT Client... \n\r");
-                capsense_ds_size = sizeof(cy_capsense_tuner);
-                size = capsense_ds_size;
-
-                /* Calculate how many notification packets are required to
-                 * transmit the CapSense data structure */
-                while(1)
-                {
-                    if(size > NOTIFICATION_PKT_SIZE)
-                    {
-                        size = size - NOTIFICATION_PKT_SIZE;
-                        count++;
-                    }
-                    else
-                    {
-                        break;
-                    }
-                }
-                tuner_init_buffer[CAPSENSE_DS_SIZE_LSB_IDX] =\
-                                           (uint8_t)(capsense_ds_size & 0x00FF);
-                tuner_init_buffer[CAPSENSE_DS_SIZE_MSB_IDX] =\
-                                           (uint8_t)(capsense_ds_size >> 8);
-                tuner_init_buffer[NOTIFICATION_COUNT_IDX] = count;
-
-                printf("Size of CapSense Data Structure: %u\n\r",\
-                                                capsense_ds_size);
-                printf("Notification packet size: %u \n\r",\
-                                                NOTIFICATION_PKT_SIZE);
-                printf("No of notifications to send complete data structure: "\
-                                                "%u\n\r", count);
-                /* Send Bridge initialization parameters */
-                notificationPacket.handleValPair.value.len =\
-                                                 TUNER_BRIDGE_INIT_NTF_SIZE;
-                notificationPacket.handleValPair.value.val = tuner_init_buffer;
-                /* Send notification to GATT client to initialize tuner bridge
-                 * parameters */
-                Cy_BLE_GATTS_Notification(&notificationPacket);
+                ble_write_error_rsp(write_req_param,\
+                                    CY_BLE_GATT_ERR_INVALID_ATTRIBUTE_LEN);
             }
         }
         break;
@@ -510,34 +813,43 @@ static void stack_event_handler(uint32_t event, void* eventParam)
      * GATT Client */
     case CY_BLE_EVT_GATTS_WRITE_CMD_REQ:
     {
-        uint16_t offset_address= 0;
-        uint8_t length = 0;
-
         cy_stc_ble_gatts_write_cmd_req_param_t write_cmd_param =\
                 *(cy_stc_ble_gatts_write_cmd_req_param_t *) eventParam;
 
-        /* Check if length of received packet is equal to
-         * TUNER_COMMAND_PACKET_SIZE */
-        if(write_cmd_param.handleValPair.value.len == TUNER_COMMAND_PACKET_SIZE)
-        {
-            memcpy(ble_write_buffer,\
-                   write_cmd_param.handleValPair.value.val,\
-                   write_cmd_param.handleValPair.value.len);
+        session = ble_session_find(write_cmd_param.connHandle.bdHandle);
 
-            offset_address =\
-            ((uint16_t)ble_write_buffer[TUNER_COMMAND_OFFS_0_IDX] << MSB_SHIFT)\
-             | (uint16_t)ble_write_buffer[TUNER_COMMAND_OFFS_1_IDX];
+        if(write_cmd_param.handleValPair.attrHandle ==\
+           CY_BLE_CAPSENSE_TUNER_TUNER_REGIONS_CHAR_HANDLE)
+        {
+            if(tuner_transport_regions_write(write_cmd_param.handleValPair.value.val,\
+                    write_cmd_param.handleValPair.value.len) == true)
+            {
+                Cy_BLE_GATTS_WriteAttributeValuePeer(&write_cmd_param.connHandle,\
+                        &(write_cmd_param.handleValPair));
+            }
+        }
+        else if(session != NO_SESSION)
+        {
+            tuner_transport_command_write(session,\
+                                          write_cmd_param.handleValPair.value.val,\
+                                          write_cmd_param.handleValPair.value.len);
+        }
+        break;
+    }
 
-            length = ble_write_buffer[TUNER_COMMAND_SIZE_0_IDX];
+    /* This event is generated before the stack answers a read or read blob
+     * request from the GATT database */
+    case CY_BLE_EVT_GATTS_READ_CHAR_VAL_ACCESS_REQ:
+    {
+        cy_stc_ble_gatts_char_val_read_req_t *read_req_param =\
+                (cy_stc_ble_gatts_char_val_read_req_t *)eventParam;
 
-            if(length <= MAX_DATA_LENGTH)
+        if(read_req_param->attrHandle == CY_BLE_CAPSENSE_TUNER_TUNER_RANGE_CHAR_HANDLE)
+        {
+            session = ble_session_find(read_req_param->connHandle.bdHandle);
+            if(session != NO_SESSION)
             {
-                /* Modify CapSense data structure */
-                for (uint8_t i = 0 , j = MAX_DATA_LENGTH - 1; i < length; i++, j--)
-                {
-                    *(((uint8_t *)&cy_capsense_tuner) + offset_address + i) =\
-                        ble_write_buffer[TUNER_COMMAND_DATA_0_IDX + j];
-                }
+                tuner_range_read(session);
             }
         }
         break;
@@ -553,92 +865,1067 @@ static void stack_event_handler(uint32_t event, void* eventParam)
 
 
 /*******************************************************************************
-* Function Name: ble_capsense_process
+* Function Name: ble_session_find
 ********************************************************************************
 *
 * Summary:
-*   -  allows the BLE stack to process pending events
+*   Returns the session of the connection with the given BD handle.
+*
+* Parameters:
+*  uint8_t bd_handle : BD handle of the connection
+*
+* Return:
+*   Session index, NO_SESSION if the handle is not connected
 *
 *******************************************************************************/
-void ble_process_events(void)
+static uint8_t ble_session_find(uint8_t bd_handle)
 {
-    /* Cy_BLE_ProcessEvents() allows the BLE stack to process pending events */
-    Cy_BLE_ProcessEvents();
+    for(uint8_t i = 0; i < CY_BLE_CONN_COUNT; i++)
+    {
+        if((ble_sessions[i].connected == true) &&\
+           (ble_sessions[i].conn_handle.bdHandle == bd_handle))
+        {
+            return i;
+        }
+    }
+
+    return NO_SESSION;
 }
 
 
 /*******************************************************************************
-* Function Name: tuner_send_callback
+* Function Name: ble_session_count
 ********************************************************************************
 *
 * Summary:
-*   - Tuner send callback function periodically called by CapSense_RunTuner().
-*   - This function sends CapSense data structure to the GATT client as
-*     notification packets to be read by the Tuner GUI
+*   Returns the number of connected GATT clients.
+*
+*******************************************************************************/
+static uint8_t ble_session_count(void)
+{
+    uint8_t count = 0;
+
+    for(uint8_t i = 0; i < CY_BLE_CONN_COUNT; i++)
+    {
+        if(ble_sessions[i].connected == true)
+        {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+
+/*******************************************************************************
+* Function Name: ble_session_primary
+********************************************************************************
+*
+* Summary:
+*   Returns the session whose link is reported where only one can be: the
+*   first session with notifications enabled, else the first connected one,
+*   else session 0.
+*
+*******************************************************************************/
+static uint8_t ble_session_primary(void)
+{
+    uint8_t primary = NO_SESSION;
+
+    for(uint8_t i = 0; i < CY_BLE_CONN_COUNT; i++)
+    {
+        if(ble_sessions[i].notification_enabled == true)
+        {
+            return i;
+        }
+
+        if((primary == NO_SESSION) && (ble_sessions[i].connected == true))
+        {
+            primary = i;
+        }
+    }
+
+    return (primary == NO_SESSION) ? 0u : primary;
+}
+
+
+/*******************************************************************************
+* Function Name: ble_session_unsubscribe
+********************************************************************************
+*
+* Summary:
+*   Stops streaming to a GATT client that disabled notifications,
+*   subscribes again or went away. The rest of its frame is dropped.
 *
 * Parameters:
-*  void * context: The pointer to the CapSense context structure
+*  uint8_t session : Session index
 *
 *******************************************************************************/
-void tuner_send_callback(void * context)
+static void ble_session_unsubscribe(uint8_t session)
 {
-    /* To remove compiler warning  */
-    (void)context;
-    cy_en_ble_api_result_t api_result = CY_BLE_SUCCESS;
-    uint8_t *ptr_capsense = NULL;
-    uint8_t notification_count = 0;
+    if(ble_sessions[session].notification_enabled == false)
+    {
+        return;
+    }
 
-    /* Remaining bytes that is less than NOTIFICATION_PKT_SIZE */
-    uint16_t remaining_bytes = 0;
+    if(tuner_transport_frame_done(session) == false)
+    {
+        link_stats.frames_aborted++;
+    }
 
-    /* Variable to keep track of CapSense structure current index */
-    uint8_t index = 0;
+    tuner_transport_unsubscribe(session);
+    ble_sessions[session].notification_enabled = false;
+}
 
-    ptr_capsense = (uint8_t *)&cy_capsense_tuner;
-    notification_count = count;
-    remaining_bytes = capsense_ds_size % NOTIFICATION_PKT_SIZE;
 
-    /* Cy_Ble_ProcessEvents() allows BLE stack to process pending events */
+/*******************************************************************************
+* Function Name: ble_capsense_process
+********************************************************************************
+*
+* Summary:
+*   -  allows the BLE stack to process pending events
+*   -  resumes the tuner frame in flight, if any
+*
+*******************************************************************************/
+void ble_process_events(void)
+{
+    uint32_t phase_start = 0;
+
+    /* Cy_BLE_ProcessEvents() allows the BLE stack to process pending events.
+     * Events reported while it runs set the flag again */
+    ble_event_flag = false;
+    PROFILER_START(phase_start);
     Cy_BLE_ProcessEvents();
+    PROFILER_STOP(PROFILER_PHASE_BLE_EVENTS, phase_start);
 
-    if(ble_notification_enabled == true)
+    /* Move the link negotiation of each connection on */
+    tuner_link_process();
+
+    /* Touch events go first. The sample log is drained ahead of the
+     * frames; the frames are sent from the newest snapshot and can skip
+     * scans, the log cannot */
+    ble_touch_events_send();
+    for(uint8_t i = 0; i < CY_BLE_CONN_COUNT; i++)
     {
-        while(notification_count > 0u)
-        {
-            /* Allows BLE stack to process pending events */
-            Cy_BLE_ProcessEvents();
+        tuner_samples_send(i);
+    }
 
-            if(ble_disconnected == true)
-            {
-                /* BLE disconnect event occurred. Exit from while loop */
-                break;
-            }
+    /* Hand out the results of a statistics run once it finishes */
+    if(tuner_snr_finished() == true)
+    {
+        sensor_stats_publish();
+    }
+    sensor_stats_notify();
 
-            /* Check if BLE stack is free */
-            if(Cy_BLE_GATT_GetBusyStatus(appConnHandle.attId) == CY_BLE_STACK_STATE_FREE)
-            {
-                if(notification_count > 1)
-                {
-                    notificationPacket.handleValPair.value.len = NOTIFICATION_PKT_SIZE;
-                }
-                else
-                {
-                    notificationPacket.handleValPair.value.len = remaining_bytes;
-                }
-
-                /* Update the notification packet with CapSense Tuner structure */
-                notificationPacket.handleValPair.value.val =\
-                        (ptr_capsense + (index * NOTIFICATION_PKT_SIZE));
-
-                /* Send notification to GATT Client */
-                api_result = Cy_BLE_GATTS_Notification(&notificationPacket);
-
-                if(api_result == CY_BLE_SUCCESS)
-                {
-                    notification_count--;
-                    index++;
-                }
-            }
+    /* Send the notification packets the stack can take right now */
+    PROFILER_START(phase_start);
+    tuner_tx_process();
+    PROFILER_STOP(PROFILER_PHASE_NOTIFY, phase_start);
+
+    tuner_stats_update();
+}
+
+
+/*******************************************************************************
+* Function Name: ble_event_pending
+********************************************************************************
+*
+* Summary:
+*   Returns true if the BLE stack has reported events that have not been
+*   processed yet. The main loop only sleeps while this is false.
+*
+*******************************************************************************/
+bool ble_event_pending(void)
+{
+    return ble_event_flag;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_frame_in_flight
+********************************************************************************
+*
+* Summary:
+*   Returns true while a CapSense data structure frame is being sent to any
+*   GATT client.
+*
+*******************************************************************************/
+bool tuner_frame_in_flight(void)
+{
+    return (tuner_tx_state != TUNER_TX_IDLE);
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_tx_process
+********************************************************************************
+*
+* Summary:
+*   - Sends as many notification packets of the frame in flight to each
+*     GATT client as the BLE stack accepts and returns without waiting for
+*     the stack to be free.
+*   - The frame is resumed from the same packet on the next call.
+*   - The frame is complete once every client taking part has all of its
+*     packets, so the slowest client paces the frames.
+*
+*******************************************************************************/
+static void tuner_tx_process(void)
+{
+    uint32_t latency = 0;
+    bool frame_done = true;
+
+    if(tuner_tx_state == TUNER_TX_IDLE)
+    {
+        return;
+    }
+
+    for(uint8_t i = 0; i < CY_BLE_CONN_COUNT; i++)
+    {
+        tuner_session_send(i);
+
+        if(tuner_transport_frame_done(i) == false)
+        {
+            frame_done = false;
+        }
+    }
+
+    if(frame_done == true)
+    {
+        latency = tuner_time_us() - frame_start_time;
+        link_stats.frames_completed++;
+        tuner_bench.latency_sum += latency;
+        if(latency > tuner_bench.latency_max)
+        {
+            tuner_bench.latency_max = latency;
+        }
+
+        tuner_tx_state = TUNER_TX_IDLE;
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_session_send
+********************************************************************************
+*
+* Summary:
+*   Sends the notification packets of the frame in flight to one GATT client
+*   until its part of the frame is complete or the BLE stack is busy.
+*
+* Parameters:
+*  uint8_t session : Session index
+*
+*******************************************************************************/
+static void tuner_session_send(uint8_t session)
+{
+    cy_en_ble_api_result_t api_result = CY_BLE_SUCCESS;
+    const uint8_t *chunk = NULL;
+    uint16_t chunk_len = 0;
+
+    notificationPacket.connHandle = ble_sessions[session].conn_handle;
+    notificationPacket.handleValPair.attrHandle =\
+            CY_BLE_CAPSENSE_TUNER_CAPSENSE_DS_CHAR_HANDLE;
+
+    while(tuner_transport_frame_done(session) == false)
+    {
+        /* A touch event takes the place of the next packet; no packet
+         * goes ahead of an event the stack could not take */
+        if(tuner_touch_events_send(session) == false)
+        {
+            break;
+        }
+
+        if(Cy_BLE_GATT_GetBusyStatus(ble_sessions[session].conn_handle.attId) !=\
+           CY_BLE_STACK_STATE_FREE)
+        {
+            link_stats.busy_polls++;
+            break;
+        }
+
+        chunk_len = tuner_transport_next_chunk(session, &chunk);
+
+        notificationPacket.handleValPair.value.len = chunk_len;
+        notificationPacket.handleValPair.value.val = (uint8_t *)chunk;
+
+        /* Send notification to GATT Client */
+        api_result = Cy_BLE_GATTS_Notification(&notificationPacket);
+
+        if(api_result != CY_BLE_SUCCESS)
+        {
+            /* Retry the same packet on the next call */
+            link_stats.ntf_errors++;
+            link_stats.last_error = (uint16_t)api_result;
+            break;
+        }
+
+        tuner_transport_chunk_sent(session);
+        link_stats.notifications++;
+        tuner_bench.bytes += chunk_len;
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_samples_send
+********************************************************************************
+*
+* Summary:
+*   Sends sample packets to a GATT client that enabled the Tuner_Samples
+*   notifications until its part of the sample log is empty or the BLE stack
+*   is busy. Each packet is as large as the ATT MTU of the connection allows.
+*
+* Parameters:
+*  uint8_t session : Session index
+*
+*******************************************************************************/
+static void tuner_samples_send(uint8_t session)
+{
+    cy_stc_ble_gatts_handle_value_ntf_t sample_ntf;
+    uint16_t max_len = 0;
+    uint16_t len = 0;
+
+    if(ble_sessions[session].samples_notify == false)
+    {
+        return;
+    }
+
+    max_len = tuner_sample_packet_size(session);
+
+    sample_ntf.connHandle = ble_sessions[session].conn_handle;
+    sample_ntf.handleValPair.attrHandle =\
+            CY_BLE_CAPSENSE_TUNER_TUNER_SAMPLES_CHAR_HANDLE;
+    sample_ntf.handleValPair.value.val = sample_packet;
+
+    for(;;)
+    {
+        /* A touch event takes the place of the next packet; no packet
+         * goes ahead of an event the stack could not take */
+        if((tuner_touch_events_send(session) == false) ||\
+           (Cy_BLE_GATT_GetBusyStatus(ble_sessions[session].conn_handle.attId) !=\
+            CY_BLE_STACK_STATE_FREE))
+        {
+            break;
+        }
+
+        len = tuner_sample_log_build(session, sample_packet, max_len);
+        if(len == 0u)
+        {
+            break;
+        }
+
+        sample_ntf.handleValPair.value.len = len;
+
+        /* A refused packet is built again on the next call */
+        if(Cy_BLE_GATTS_Notification(&sample_ntf) != CY_BLE_SUCCESS)
+        {
+            break;
+        }
+
+        tuner_sample_log_sent(session);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: ble_touch_events_send
+********************************************************************************
+*
+* Summary:
+*   Sends the queued touch events to every GATT client that enabled the
+*   Touch_Events notifications. Called by the main loop as soon as a widget
+*   status changes, and by the senders of the bulk data before each of their
+*   packets, so an event is handed to the BLE stack ahead of any bulk packet
+*   that is not with the stack yet.
+*
+*******************************************************************************/
+void ble_touch_events_send(void)
+{
+    for(uint8_t i = 0; i < CY_BLE_CONN_COUNT; i++)
+    {
+        (void)tuner_touch_events_send(i);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_touch_events_send
+********************************************************************************
+*
+* Summary:
+*   Sends the queued touch events of one GATT client while the BLE stack is
+*   free. Each packet is as large as the ATT MTU of the connection allows.
+*
+* Parameters:
+*  uint8_t session : Session index
+*
+* Return:
+*   true if no event of the client is left waiting
+*
+*******************************************************************************/
+static bool tuner_touch_events_send(uint8_t session)
+{
+    cy_stc_ble_gatts_handle_value_ntf_t event_ntf;
+    uint16_t max_len = 0;
+    uint16_t len = 0;
+
+    if((ble_sessions[session].events_notify == false) ||\
+       (tuner_touch_events_pending(session) == false))
+    {
+        return true;
+    }
+
+    max_len = tuner_link_params(session)->mtu - ATT_NTF_HEADER_SIZE;
+    if(max_len > TUNER_TOUCH_EVENT_PKT_MAX_SIZE)
+    {
+        max_len = TUNER_TOUCH_EVENT_PKT_MAX_SIZE;
+    }
+
+    event_ntf.connHandle = ble_sessions[session].conn_handle;
+    event_ntf.handleValPair.attrHandle =\
+            CY_BLE_CAPSENSE_TUNER_TOUCH_EVENTS_CHAR_HANDLE;
+    event_ntf.handleValPair.value.val = touch_event_packet;
+
+    while(tuner_touch_events_pending(session) == true)
+    {
+        if(Cy_BLE_GATT_GetBusyStatus(ble_sessions[session].conn_handle.attId) !=\
+           CY_BLE_STACK_STATE_FREE)
+        {
+            link_stats.event_busy_polls++;
+            return false;
+        }
+
+        len = tuner_touch_events_build(session, touch_event_packet, max_len);
+        if(len == 0u)
+        {
+            break;
+        }
+
+        event_ntf.handleValPair.value.len = len;
+
+        /* A refused packet is built again on the next call */
+        if(Cy_BLE_GATTS_Notification(&event_ntf) != CY_BLE_SUCCESS)
+        {
+            link_stats.event_busy_polls++;
+            return false;
+        }
+
+        tuner_touch_events_sent(session);
+    }
+
+    return (tuner_touch_events_pending(session) == false);
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_sample_packet_size
+********************************************************************************
+*
+* Summary:
+*   Returns the largest sample packet the connection of a session carries:
+*   the ATT MTU less the notification header, limited by the length of the
+*   Tuner_Samples characteristic.
+*
+* Parameters:
+*  uint8_t session : Session index
+*
+*******************************************************************************/
+static uint16_t tuner_sample_packet_size(uint8_t session)
+{
+    uint16_t size = tuner_link_params(session)->mtu - ATT_NTF_HEADER_SIZE;
+
+    return (size > TUNER_SAMPLE_PKT_MAX_SIZE) ? TUNER_SAMPLE_PKT_MAX_SIZE : size;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_sample_packet_size_min
+********************************************************************************
+*
+* Summary:
+*   Returns the smallest of the largest sample packets of a session and of
+*   the sessions that enabled the Tuner_Samples notifications. A selection
+*   is checked against it so that every client drains the shared log.
+*
+* Parameters:
+*  uint8_t session : Session index of the client that writes the selection
+*
+*******************************************************************************/
+static uint16_t tuner_sample_packet_size_min(uint8_t session)
+{
+    uint16_t size = tuner_sample_packet_size(session);
+
+    for(uint8_t i = 0; i < CY_BLE_CONN_COUNT; i++)
+    {
+        if((ble_sessions[i].samples_notify == true) &&\
+           (tuner_sample_packet_size(i) < size))
+        {
+            size = tuner_sample_packet_size(i);
+        }
+    }
+
+    return size;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_send_bridge_init
+********************************************************************************
+*
+* Summary:
+*   Sends the tuner bridge initialization parameters built by the transport
+*   to a GATT client to initialize its Tuner bridge.
+*
+* Parameters:
+*  uint8_t session : Session index
+*
+* Return:
+*   true if the initialization packet was accepted by the BLE stack
+*
+*******************************************************************************/
+static bool tuner_send_bridge_init(uint8_t session)
+{
+    cy_en_ble_api_result_t api_result = CY_BLE_SUCCESS;
+    uint8_t tuner_init_buffer[TUNER_BRIDGE_INIT_NTF_SIZE] = {0};
+
+    /* Send Bridge initialization parameters */
+    notificationPacket.connHandle = ble_sessions[session].conn_handle;
+    notificationPacket.handleValPair.attrHandle =\
+            CY_BLE_CAPSENSE_TUNER_CAPSENSE_DS_CHAR_HANDLE;
+    notificationPacket.handleValPair.value.len =\
+            tuner_transport_build_init(session, tuner_init_buffer);
+    notificationPacket.handleValPair.value.val = tuner_init_buffer;
+    api_result = Cy_BLE_GATTS_Notification(&notificationPacket);
+
+    if(api_result == CY_BLE_SUCCESS)
+    {
+        tuner_transport_init_sent(session);
+    }
+
+    return (api_result == CY_BLE_SUCCESS);
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_send_callback
+********************************************************************************
+*
+* Summary:
+*   - Tuner send callback function periodically called by CapSense_RunTuner().
+*   - This function starts sending the blocks of the CapSense data structure
+*     that changed since the previous frame to the subscribed GATT clients
+*     as notification packets to be read by the Tuner GUI. All clients get
+*     the same snapshot. It does not wait for the frame to complete; the
+*     remaining packets are sent from ble_process_events(). A new frame is
+*     not started while the previous one is still in flight for any client
+*     or before the frame rate target allows it; the scan is then counted
+*     as a skipped frame. No frame is sent when nothing changed.
+*
+* Parameters:
+*  void * context: The pointer to the CapSense context structure
+*
+*******************************************************************************/
+void tuner_send_callback(void * context)
+{
+    uint32_t phase_start = 0;
+    bool frame_started = false;
+
+    /* To remove compiler warning  */
+    (void)context;
+
+    /* Cy_Ble_ProcessEvents() allows BLE stack to process pending events */
+    ble_event_flag = false;
+    Cy_BLE_ProcessEvents();
+
+    if(tuner_tx_state == TUNER_TX_IDLE)
+    {
+        /* Frames are only sent to a client once it knows the packet size; a
+         * client whose initialization packet was not accepted sits this
+         * frame out */
+        for(uint8_t i = 0; i < CY_BLE_CONN_COUNT; i++)
+        {
+            if((ble_sessions[i].notification_enabled == true) &&\
+               (tuner_transport_init_pending(i) == true))
+            {
+                (void)tuner_send_bridge_init(i);
+            }
+        }
+    }
+
+    if((tuner_tx_state == TUNER_TX_IDLE) && (tuner_rate_due() == true))
+    {
+        /* Start a new frame with the blocks that changed */
+        frame_start_time = tuner_time_us();
+        PROFILER_START(phase_start);
+        frame_started = tuner_transport_frame_start();
+        PROFILER_STOP(PROFILER_PHASE_FRAME_START, phase_start);
+
+        if(frame_started == true)
+        {
+            link_stats.frames_started++;
+            tuner_tx_state = TUNER_TX_SENDING;
+            tuner_rate_frame_started();
+        }
+    }
+    else if(ble_sessions[ble_session_primary()].notification_enabled == true)
+    {
+        /* A client is waiting; the changes of this scan go out with the
+         * next frame */
+        tuner_rate.window_skipped++;
+    }
+
+    tuner_tx_process();
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_stats_update
+********************************************************************************
+*
+* Summary:
+*   Called from ble_process_events(). Once every second, publishes the link
+*   statistics and the achieved frame rate and closes the benchmark window.
+*   With TUNER_BENCH_REPORT_ENABLE, prints one comma-separated line per
+*   window for comparing transport changes against a baseline:
+*   BENCH,<frames/s>,<notifications/s>,<bytes/s>,<busy polls>,<retries>,
+*   <mean latency us>,<max latency us>,<MTU>,<LL octets>,<packet size>,
+*   <image size>,<max touch event latency us>
+*   The latency runs from the snapshot of a frame to the BLE stack accepting
+*   its last packet for the slowest client. The touch event latency runs
+*   from the processing of the widget to the hand-off of the event. The
+*   counters cover all clients; the link values are those of the first
+*   subscribed client.
+*
+*******************************************************************************/
+static void tuner_stats_update(void)
+{
+#if (TUNER_BENCH_REPORT_ENABLE == ENABLE)
+    uint32_t frames = 0;
+    uint8_t primary = ble_session_primary();
+#endif
+
+    if((tuner_time_us() - stats_window_start) < TUNER_TIME_US_PER_S)
+    {
+        return;
+    }
+
+    link_stats.event_latency_max = tuner_touch_events_latency_max();
+    link_stats_publish();
+
+    tuner_rate.achieved = (uint16_t)(link_stats.frames_completed -\
+                                     tuner_bench.base.frames_completed);
+    tuner_rate.skipped = (uint16_t)tuner_rate.window_skipped;
+    tuner_rate.window_skipped = 0;
+    tuner_control_publish();
+
+#if (TUNER_BENCH_REPORT_ENABLE == ENABLE)
+    frames = link_stats.frames_completed - tuner_bench.base.frames_completed;
+    if(frames > 0u)
+    {
+        printf("BENCH,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%u,%u,%u,%u,%lu\r\n",
+               (unsigned long)frames,
+               (unsigned long)(link_stats.notifications -
+                               tuner_bench.base.notifications),
+               (unsigned long)tuner_bench.bytes,
+               (unsigned long)(link_stats.busy_polls -
+                               tuner_bench.base.busy_polls),
+               (unsigned long)(link_stats.ntf_errors -
+                               tuner_bench.base.ntf_errors),
+               (unsigned long)(tuner_bench.latency_sum / frames),
+               (unsigned long)tuner_bench.latency_max,
+               tuner_link_params(primary)->mtu,
+               tuner_link_params(primary)->tx_octets,
+               tuner_transport_chunk_size(primary),
+               tuner_transport_image_size(),
+               (unsigned long)link_stats.event_latency_max);
+    }
+#endif
+
+    memset(&tuner_bench, 0, sizeof(tuner_bench));
+    tuner_bench.base = link_stats;
+    stats_window_start += TUNER_TIME_US_PER_S;
+}
+
+
+/*******************************************************************************
+* Function Name: link_stats_publish
+********************************************************************************
+*
+* Summary:
+*   Writes the link statistics to the Link_Stats characteristic in the GATT
+*   database, so a read returns values at most one second old, and notifies
+*   them to each client that enabled it, with the link values of its own
+*   connection. A notification is skipped rather than retried when the
+*   stack is busy.
+*
+*******************************************************************************/
+static void link_stats_publish(void)
+{
+    uint8_t buffer[LINK_STATS_SIZE];
+    cy_stc_ble_gatt_handle_value_pair_t value_pair;
+    cy_stc_ble_gatts_handle_value_ntf_t stats_ntf;
+    const ble_session_t *ses = NULL;
+
+    value_pair.attrHandle = CY_BLE_CAPSENSE_TUNER_LINK_STATS_CHAR_HANDLE;
+    value_pair.value.val = buffer;
+    value_pair.value.len = link_stats_pack(ble_session_primary(), buffer);
+    Cy_BLE_GATTS_WriteAttributeValueLocal(&value_pair);
+
+    for(uint8_t i = 0; i < CY_BLE_CONN_COUNT; i++)
+    {
+        ses = &ble_sessions[i];
+
+        /* The value does not fit a notification before the MTU exchange */
+        if((ses->link_stats_notify == true) && (ses->connected == true) &&\
+           (LINK_STATS_SIZE <= (tuner_link_params(i)->mtu - ATT_NTF_HEADER_SIZE)) &&\
+           (Cy_BLE_GATT_GetBusyStatus(ses->conn_handle.attId) ==\
+            CY_BLE_STACK_STATE_FREE))
+        {
+            value_pair.value.len = link_stats_pack(i, buffer);
+            stats_ntf.connHandle = ses->conn_handle;
+            stats_ntf.handleValPair = value_pair;
+            (void)Cy_BLE_GATTS_Notification(&stats_ntf);
+        }
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: link_stats_pack
+********************************************************************************
+*
+* Summary:
+*   Serializes the link statistics in the Link_Stats layout.
+*
+* Parameters:
+*  uint8_t session : Connection whose link values are packed
+*  uint8_t *buffer : Buffer of LINK_STATS_SIZE bytes
+*
+* Return:
+*   Number of bytes written
+*
+*******************************************************************************/
+static uint16_t link_stats_pack(uint8_t session, uint8_t *buffer)
+{
+    const tuner_link_params_t *link = tuner_link_params(session);
+    const uint32_t counters[] =
+    {
+        link_stats.frames_started, link_stats.frames_completed,
+        link_stats.frames_aborted, link_stats.notifications,
+        link_stats.ntf_errors, link_stats.busy_polls
+    };
+    const uint16_t values[] =
+    {
+        link_stats.last_error, link->mtu, link->tx_octets
+    };
+    uint16_t pos = 0;
+
+    for(uint8_t i = 0; i < (sizeof(counters) / sizeof(counters[0])); i++)
+    {
+        for(uint8_t byte = 0; byte < sizeof(uint32_t); byte++)
+        {
+            buffer[pos++] = (uint8_t)(counters[i] >> (byte * BYTE_SHIFT));
+        }
+    }
+
+    for(uint8_t i = 0; i < (sizeof(values) / sizeof(values[0])); i++)
+    {
+        buffer[pos++] = (uint8_t)(values[i] & 0x00FF);
+        buffer[pos++] = (uint8_t)(values[i] >> BYTE_SHIFT);
+    }
+
+    buffer[pos++] = link->tx_phy;
+    buffer[pos++] = link->rx_phy;
+    buffer[pos++] = (uint8_t)(link_stats.connections & 0x00FF);
+    buffer[pos++] = (uint8_t)(link_stats.connections >> BYTE_SHIFT);
+    buffer[pos++] = (uint8_t)(link_stats.disconnections & 0x00FF);
+    buffer[pos++] = (uint8_t)(link_stats.disconnections >> BYTE_SHIFT);
+    memcpy(&buffer[pos], link_stats.disconnect_reasons, LINK_STATS_REASON_COUNT);
+    pos += LINK_STATS_REASON_COUNT;
+
+    for(uint8_t byte = 0; byte < sizeof(uint32_t); byte++)
+    {
+        buffer[pos++] = (uint8_t)(link_stats.event_busy_polls >> (byte * BYTE_SHIFT));
+    }
+    for(uint8_t byte = 0; byte < sizeof(uint32_t); byte++)
+    {
+        buffer[pos++] = (uint8_t)(link_stats.event_latency_max >> (byte * BYTE_SHIFT));
+    }
+
+    return pos;
+}
+
+
+/*******************************************************************************
+* Function Name: ble_write_error_rsp
+********************************************************************************
+*
+* Summary:
+*   Answers a write request with an ATT error response.
+*
+* Parameters:
+*  const cy_stc_ble_gatt_write_param_t *write_req_param : Write request
+*  cy_en_ble_gatt_err_code_t error_code                 : ATT error code
+*
+*******************************************************************************/
+static void ble_write_error_rsp(const cy_stc_ble_gatt_write_param_t *write_req_param,\
+                                cy_en_ble_gatt_err_code_t error_code)
+{
+    cy_stc_ble_gatt_err_param_t err_param;
+
+    err_param.errInfo.opCode = CY_BLE_GATT_WRITE_REQ;
+    err_param.errInfo.attrHandle = write_req_param->handleValPair.attrHandle;
+    err_param.errInfo.errorCode = error_code;
+    err_param.connHandle = write_req_param->connHandle;
+    Cy_BLE_GATTS_ErrorRsp(&err_param);
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_rate_set
+********************************************************************************
+*
+* Summary:
+*   Sets the target tuner frame rate. Frames start at most this often; they
+*   start less often when the scans or the link are slower.
+*
+* Parameters:
+*  uint16_t target : Frames per second, 0 for as fast as the link allows
+*
+*******************************************************************************/
+static void tuner_rate_set(uint16_t target)
+{
+    tuner_rate.target = target;
+    tuner_rate.period = (target == 0u) ? 0u : (TUNER_TIME_US_PER_S / target);
+    tuner_rate.next_frame = tuner_time_us();
+
+    printf("Tuner frame rate target: %u frames/s\r\n", target);
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_rate_due
+********************************************************************************
+*
+* Summary:
+*   Returns true if the frame rate target allows a new frame to start.
+*
+*******************************************************************************/
+static bool tuner_rate_due(void)
+{
+    return ((tuner_rate.target == 0u) ||\
+            ((int32_t)(tuner_time_us() - tuner_rate.next_frame) >= 0));
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_rate_frame_started
+********************************************************************************
+*
+* Summary:
+*   Schedules the next frame one period after the one just started was due,
+*   so that frames starting at scan boundaries do not drift below the
+*   target. Periods the link could not use are not caught up on.
+*
+*******************************************************************************/
+static void tuner_rate_frame_started(void)
+{
+    uint32_t now = tuner_time_us();
+
+    if(tuner_rate.target == 0u)
+    {
+        return;
+    }
+
+    tuner_rate.next_frame += tuner_rate.period;
+    if((int32_t)(now - tuner_rate.next_frame) >= 0)
+    {
+        tuner_rate.next_frame = now + tuner_rate.period;
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_control_publish
+********************************************************************************
+*
+* Summary:
+*   Writes the frame rate target and the rates achieved during the last
+*   second to the Tuner_Control characteristic in the GATT database and
+*   notifies them to each client that enabled it. A notification is
+*   skipped rather than retried when the stack is busy.
+*
+*******************************************************************************/
+static void tuner_control_publish(void)
+{
+    uint8_t buffer[TUNER_CONTROL_SIZE];
+    cy_stc_ble_gatt_handle_value_pair_t value_pair;
+    cy_stc_ble_gatts_handle_value_ntf_t control_ntf;
+    const uint16_t values[] =
+    {
+        tuner_rate.target, tuner_rate.achieved, tuner_rate.skipped
+    };
+
+    for(uint8_t i = 0; i < (sizeof(values) / sizeof(values[0])); i++)
+    {
+        buffer[(2u * i)] = (uint8_t)(values[i] & 0x00FF);
+        buffer[(2u * i) + 1u] = (uint8_t)(values[i] >> BYTE_SHIFT);
+    }
+
+    value_pair.attrHandle = CY_BLE_CAPSENSE_TUNER_TUNER_CONTROL_CHAR_HANDLE;
+    value_pair.value.val = buffer;
+    value_pair.value.len = TUNER_CONTROL_SIZE;
+    Cy_BLE_GATTS_WriteAttributeValueLocal(&value_pair);
+
+    for(uint8_t i = 0; i < CY_BLE_CONN_COUNT; i++)
+    {
+        if((ble_sessions[i].control_notify == true) &&\
+           (ble_sessions[i].connected == true) &&\
+           (Cy_BLE_GATT_GetBusyStatus(ble_sessions[i].conn_handle.attId) ==\
+            CY_BLE_STACK_STATE_FREE))
+        {
+            control_ntf.connHandle = ble_sessions[i].conn_handle;
+            control_ntf.handleValPair = value_pair;
+            (void)Cy_BLE_GATTS_Notification(&control_ntf);
+        }
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_range_set
+********************************************************************************
+*
+* Summary:
+*   Applies a range written to the Tuner_Range characteristic by a GATT
+*   client.
+*
+* Parameters:
+*  uint8_t session     : Session index of the writing client
+*  const uint8_t *data : Written value, offset and length
+*  uint16_t len        : Length of the written value
+*
+* Return:
+*   true if the range lies inside cy_capsense_tuner and fits in one read
+*   response at the ATT MTU of the client
+*
+*******************************************************************************/
+static bool tuner_range_set(uint8_t session, const uint8_t *data, uint16_t len)
+{
+    uint16_t offset = 0;
+    uint16_t range_len = 0;
+
+    if(len != TUNER_RANGE_WRITE_SIZE)
+    {
+        return false;
+    }
+
+    offset = (uint16_t)data[0] | ((uint16_t)data[1] << BYTE_SHIFT);
+    range_len = (uint16_t)data[2] | ((uint16_t)data[3] << BYTE_SHIFT);
+
+    if((range_len == 0u) ||\
+       (range_len > (tuner_link_params(session)->mtu - ATT_READ_RSP_HEADER_SIZE)) ||\
+       (((uint32_t)offset + range_len) > sizeof(cy_capsense_tuner)))
+    {
+        return false;
+    }
+
+    ble_sessions[session].range_offset = offset;
+    ble_sessions[session].range_len = range_len;
+
+    return true;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_range_read
+********************************************************************************
+*
+* Summary:
+*   Called before the stack answers a read request of Tuner_Range. Loads the
+*   range of the client into the value straight from cy_capsense_tuner; the
+*   structure is only updated from the main loop, so the value holds a
+*   single scan. The value is shared by the connections, so it is loaded
+*   again for every request. Until the client writes a range, the value is
+*   the start of the structure, as much as one read response carries.
+*
+* Parameters:
+*  uint8_t session : Session index of the reading client
+*
+*******************************************************************************/
+static void tuner_range_read(uint8_t session)
+{
+    cy_stc_ble_gatt_handle_value_pair_t value_pair;
+    uint16_t range_len = ble_sessions[session].range_len;
+
+    if(range_len == 0u)
+    {
+        range_len = tuner_link_params(session)->mtu - ATT_READ_RSP_HEADER_SIZE;
+        if(range_len > sizeof(cy_capsense_tuner))
+        {
+            range_len = (uint16_t)sizeof(cy_capsense_tuner);
+        }
+    }
+
+    value_pair.attrHandle = CY_BLE_CAPSENSE_TUNER_TUNER_RANGE_CHAR_HANDLE;
+    value_pair.value.val = (uint8_t *)&cy_capsense_tuner + ble_sessions[session].range_offset;
+    value_pair.value.len = range_len;
+    Cy_BLE_GATTS_WriteAttributeValueLocal(&value_pair);
+}
+
+
+/*******************************************************************************
+* Function Name: sensor_stats_publish
+********************************************************************************
+*
+* Summary:
+*   Writes the state and the results of the statistics run to the
+*   Sensor_Stats characteristic in the GATT database and marks its header
+*   for notification to each client that enabled it.
+*
+*******************************************************************************/
+static void sensor_stats_publish(void)
+{
+    cy_stc_ble_gatt_handle_value_pair_t value_pair;
+
+    value_pair.attrHandle = CY_BLE_CAPSENSE_TUNER_SENSOR_STATS_CHAR_HANDLE;
+    value_pair.value.val = sensor_stats_value;
+    value_pair.value.len = tuner_snr_build(sensor_stats_value);
+    Cy_BLE_GATTS_WriteAttributeValueLocal(&value_pair);
+
+    for(uint8_t i = 0; i < CY_BLE_CONN_COUNT; i++)
+    {
+        ble_sessions[i].stats_ntf_pending = ble_sessions[i].stats_notify;
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: sensor_stats_notify
+********************************************************************************
+*
+* Summary:
+*   Notifies the Sensor_Stats header to the clients still waiting for it.
+*   Unlike the periodic values, the header of a finished run is sent only
+*   once, so it waits while the stack is busy instead of being skipped.
+*
+*******************************************************************************/
+static void sensor_stats_notify(void)
+{
+    cy_stc_ble_gatts_handle_value_ntf_t stats_ntf;
+
+    for(uint8_t i = 0; i < CY_BLE_CONN_COUNT; i++)
+    {
+        if((ble_sessions[i].stats_ntf_pending == true) &&\
+           (ble_sessions[i].connected == true) &&\
+           (Cy_BLE_GATT_GetBusyStatus(ble_sessions[i].conn_handle.attId) ==\
+            CY_BLE_STACK_STATE_FREE))
+        {
+            stats_ntf.connHandle = ble_sessions[i].conn_handle;
+            stats_ntf.handleValPair.attrHandle =\
+                    CY_BLE_CAPSENSE_TUNER_SENSOR_STATS_CHAR_HANDLE;
+            stats_ntf.handleValPair.value.val = sensor_stats_value;
+            stats_ntf.handleValPair.value.len = TUNER_SNR_HDR_SIZE;
+            (void)Cy_BLE_GATTS_Notification(&stats_ntf);
+            ble_sessions[i].stats_ntf_pending = false;
         }
     }
 }
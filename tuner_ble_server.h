@@ -45,12 +45,21 @@
 #ifndef TUNER_BLE_SERVER_H_
 #define TUNER_BLE_SERVER_H_
 
+/******************************************************************************
+ * Include header files
+ *****************************************************************************/
+#include <stdbool.h>
+
+
 /******************************************************************************
  * Function Prototypes
  *****************************************************************************/
 void tuner_send_callback(void *context);
 void ble_capsense_tuner_init(void);
 void ble_process_events(void);
+bool ble_event_pending(void);
+void ble_touch_events_send(void);
+bool tuner_frame_in_flight(void);
 
 
 #endif /* BLE_CAPSENSE_TUNER_H_ */
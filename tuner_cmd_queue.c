@@ -0,0 +1,178 @@
+/******************************************************************************
+* File Name: tuner_cmd_queue.c
+*
+* Description: This file contains the queue of parsed Tuner writes and
+*              connection events between the BLE stack event handler, which
+*              fills it, and the CapSense main loop, which drains it at a
+*              scan boundary. It is a bounded single-producer
+*              single-consumer ring: each side writes only its own index, so
+*              neither needs to lock out the other.
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include "cyhal.h"
+#include "tuner_cmd_queue.h"
+
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define CMD_QUEUE_INDEX_MASK         (TUNER_CMD_QUEUE_LENGTH - 1u)
+
+#if ((TUNER_CMD_QUEUE_LENGTH & CMD_QUEUE_INDEX_MASK) != 0u)
+#error "TUNER_CMD_QUEUE_LENGTH must be a power of two"
+#endif
+
+
+/*******************************************************************************
+ * Global variables
+ ******************************************************************************/
+static tuner_cmd_t cmd_queue[TUNER_CMD_QUEUE_LENGTH];
+
+/* Entries written and read since power-up. The write count is only changed
+ * by the producer and the read count only by the consumer; their difference
+ * is the number of entries in the queue */
+static volatile uint32_t cmd_queue_write_count = 0;
+static volatile uint32_t cmd_queue_read_count = 0;
+
+
+/*******************************************************************************
+* Function Name: tuner_cmd_queue_space
+********************************************************************************
+*
+* Summary:
+*   Returns the number of free entries. Called by the producer; the consumer
+*   can only make the result grow until the next call.
+*
+* Return:
+*   Number of entries that can be written and published
+*
+*******************************************************************************/
+uint32_t tuner_cmd_queue_space(void)
+{
+    return TUNER_CMD_QUEUE_LENGTH -\
+           (cmd_queue_write_count - cmd_queue_read_count);
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_cmd_queue_slot
+********************************************************************************
+*
+* Summary:
+*   Returns a free entry for the producer to fill. The entry stays invisible
+*   to the consumer until tuner_cmd_queue_publish() is called, so a packet
+*   that takes several entries is published as a whole or not at all.
+*
+* Parameters:
+*  uint32_t index : Entry after the last published one, below
+*                   tuner_cmd_queue_space()
+*
+* Return:
+*   Entry to fill
+*
+*******************************************************************************/
+tuner_cmd_t *tuner_cmd_queue_slot(uint32_t index)
+{
+    return &cmd_queue[(cmd_queue_write_count + index) & CMD_QUEUE_INDEX_MASK];
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_cmd_queue_publish
+********************************************************************************
+*
+* Summary:
+*   Hands the first count entries filled after the last published one to the
+*   consumer. The barrier makes sure the entries are written before the
+*   consumer can see the new write count.
+*
+* Parameters:
+*  uint32_t count : Number of entries filled
+*
+*******************************************************************************/
+void tuner_cmd_queue_publish(uint32_t count)
+{
+    __DMB();
+    cmd_queue_write_count += count;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_cmd_queue_peek
+********************************************************************************
+*
+* Summary:
+*   Returns the oldest entry, which stays in the queue until
+*   tuner_cmd_queue_pop() is called.
+*
+* Return:
+*   Oldest entry, NULL if the queue is empty
+*
+*******************************************************************************/
+const tuner_cmd_t *tuner_cmd_queue_peek(void)
+{
+    if(cmd_queue_read_count == cmd_queue_write_count)
+    {
+        return NULL;
+    }
+
+    /* Read the entry only after the write count that published it */
+    __DMB();
+    return &cmd_queue[cmd_queue_read_count & CMD_QUEUE_INDEX_MASK];
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_cmd_queue_pop
+********************************************************************************
+*
+* Summary:
+*   Releases the oldest entry to the producer once the consumer is done with
+*   it.
+*
+*******************************************************************************/
+void tuner_cmd_queue_pop(void)
+{
+    __DMB();
+    cmd_queue_read_count++;
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,98 @@
+/******************************************************************************
+* File Name: tuner_cmd_queue.h
+*
+* Description: This file is public interface of tuner_cmd_queue.c
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include guard
+ *****************************************************************************/
+#ifndef TUNER_CMD_QUEUE_H_
+#define TUNER_CMD_QUEUE_H_
+
+/******************************************************************************
+ * Include header files
+ *****************************************************************************/
+#include <stdint.h>
+
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+/* Number of entries; must be a power of two */
+#define TUNER_CMD_QUEUE_LENGTH       (128u)
+
+/* Data bytes of one entry, as many as a single Tuner command packet carries.
+ * Longer writes take several entries */
+#define TUNER_CMD_DATA_SIZE          (4u)
+
+/* Entry types. The connection events reach the main loop in the order of
+ * the writes around them */
+#define TUNER_CMD_WRITE              (0u)   /* offset, size, data */
+#define TUNER_CMD_CONNECT            (1u)   /* session */
+#define TUNER_CMD_DISCONNECT         (2u)   /* session */
+
+
+/******************************************************************************
+ * Data Types
+ *****************************************************************************/
+/* Parsed Tuner write or connection event */
+typedef struct
+{
+    uint8_t type;                       /* TUNER_CMD_* */
+    uint8_t session;                    /* Client of a connection event */
+    uint16_t offset;                    /* Offset in cy_capsense_tuner */
+    uint8_t size;                       /* Number of bytes in data */
+    uint8_t data[TUNER_CMD_DATA_SIZE];  /* In the byte order of the structure */
+} tuner_cmd_t;
+
+
+/******************************************************************************
+ * Function Prototypes
+ *****************************************************************************/
+/* Producer: the BLE stack event handler */
+uint32_t tuner_cmd_queue_space(void);
+tuner_cmd_t *tuner_cmd_queue_slot(uint32_t index);
+void tuner_cmd_queue_publish(uint32_t count);
+
+/* Consumer: the CapSense main loop */
+const tuner_cmd_t *tuner_cmd_queue_peek(void);
+void tuner_cmd_queue_pop(void);
+
+
+#endif /* TUNER_CMD_QUEUE_H_ */
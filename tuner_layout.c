@@ -0,0 +1,439 @@
+/******************************************************************************
+* File Name: tuner_layout.c
+*
+* Description: This file contains the layout map of the CapSense tuner
+*              structure: the offset, size and class of its fields, taken from
+*              the CapSense configuration headers at build time.
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <stddef.h>
+#include "cycfg_capsense.h"
+#include "tuner_layout.h"
+
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define VOLATILE                     (TUNER_LAYOUT_VOLATILE)
+#define WRITABLE                     (TUNER_LAYOUT_WRITABLE)
+#define REINIT                       (TUNER_LAYOUT_REINIT)
+#define COMMAND                      (TUNER_LAYOUT_COMMAND)
+#define STATIC                       (0u)
+
+/* Entry of an element layout: offset and size of a member of type, class */
+#define LAYOUT_FIELD(type, member, cls)\
+    { (uint16_t)offsetof(type, member),\
+      (uint16_t)sizeof(((type *)0)->member), (uint8_t)(cls) },
+
+/* Entry of the structure layout: array member of cy_stc_capsense_tuner_t
+ * and the layout of its elements */
+#define LAYOUT_ARRAY(member, fields)\
+    { (uint16_t)offsetof(cy_stc_capsense_tuner_t, member),\
+      (uint16_t)sizeof(cy_capsense_tuner.member),\
+      (uint16_t)sizeof(cy_capsense_tuner.member[0]),\
+      (fields), (uint8_t)(sizeof(fields) / sizeof((fields)[0])) }
+
+/* The element layouts below list every member of the middleware type in
+ * the order of its declaration, each with the member declared before it.
+ * The assertions fail the build if a member is missing, e.g. after a
+ * middleware update: the gap between two listed members must be padding,
+ * which is shorter than the alignment of the second one and so shorter
+ * than its size. The first member must be at offset 0 and only the tail
+ * padding may follow the last one */
+#define LAYOUT_END(type, member)\
+    (offsetof(type, member) + sizeof(((type *)0)->member))
+
+#define LAYOUT_ASSERT_FIRST(type, member, cls)\
+    _Static_assert(offsetof(type, member) == 0u,\
+                   #type " does not start with " #member);
+#define LAYOUT_ASSERT_NEXT(type, prev, member, cls)\
+    _Static_assert((offsetof(type, member) >= LAYOUT_END(type, prev)) &&\
+                   ((offsetof(type, member) - LAYOUT_END(type, prev)) <\
+                    sizeof(((type *)0)->member)),\
+                   "a member of " #type " between " #prev " and " #member\
+                   " is not listed");
+#define LAYOUT_ASSERT_LAST(type, member)\
+    _Static_assert((sizeof(type) - LAYOUT_END(type, member)) < _Alignof(type),\
+                   "a member of " #type " after " #member " is not listed");
+
+#define COMMON_FIRST(member, cls)\
+    LAYOUT_FIELD(cy_stc_capsense_common_context_t, member, cls)
+#define COMMON_NEXT(prev, member, cls)\
+    LAYOUT_FIELD(cy_stc_capsense_common_context_t, member, cls)
+#define COMMON_ASSERT_FIRST(member, cls)\
+    LAYOUT_ASSERT_FIRST(cy_stc_capsense_common_context_t, member, cls)
+#define COMMON_ASSERT_NEXT(prev, member, cls)\
+    LAYOUT_ASSERT_NEXT(cy_stc_capsense_common_context_t, prev, member, cls)
+
+#define WIDGET_FIRST(member, cls)\
+    LAYOUT_FIELD(cy_stc_capsense_widget_context_t, member, cls)
+#define WIDGET_NEXT(prev, member, cls)\
+    LAYOUT_FIELD(cy_stc_capsense_widget_context_t, member, cls)
+#define WIDGET_ASSERT_FIRST(member, cls)\
+    LAYOUT_ASSERT_FIRST(cy_stc_capsense_widget_context_t, member, cls)
+#define WIDGET_ASSERT_NEXT(prev, member, cls)\
+    LAYOUT_ASSERT_NEXT(cy_stc_capsense_widget_context_t, prev, member, cls)
+
+#define SENSOR_FIRST(member, cls)\
+    LAYOUT_FIELD(cy_stc_capsense_sensor_context_t, member, cls)
+#define SENSOR_NEXT(prev, member, cls)\
+    LAYOUT_FIELD(cy_stc_capsense_sensor_context_t, member, cls)
+#define SENSOR_ASSERT_FIRST(member, cls)\
+    LAYOUT_ASSERT_FIRST(cy_stc_capsense_sensor_context_t, member, cls)
+#define SENSOR_ASSERT_NEXT(prev, member, cls)\
+    LAYOUT_ASSERT_NEXT(cy_stc_capsense_sensor_context_t, prev, member, cls)
+
+/* Common context. The tuner command is cleared by the middleware once it is
+ * executed and takes effect as soon as it is written; the callback pointers must never be written from outside. The
+ * modulator clocks change the raw counts of every widget */
+#define COMMON_LAYOUT(FIRST, NEXT)\
+    FIRST(                         configId,                STATIC)\
+    NEXT(configId,                 tunerCmd,                VOLATILE | WRITABLE | COMMAND)\
+    NEXT(tunerCmd,                 scanCounter,             VOLATILE)\
+    NEXT(scanCounter,              tunerSt,                 VOLATILE)\
+    NEXT(tunerSt,                  initDone,                STATIC)\
+    NEXT(initDone,                 ptrSSCallback,           STATIC)\
+    NEXT(ptrSSCallback,            ptrEOSCallback,          STATIC)\
+    NEXT(ptrEOSCallback,           ptrTunerSendCallback,    STATIC)\
+    NEXT(ptrTunerSendCallback,     ptrTunerReceiveCallback, STATIC)\
+    NEXT(ptrTunerReceiveCallback,  status,                  VOLATILE)\
+    NEXT(status,                   timestampInterval,       STATIC | WRITABLE)\
+    NEXT(timestampInterval,        timestamp,               VOLATILE)\
+    NEXT(timestamp,                modCsdClk,               STATIC | WRITABLE | REINIT)\
+    NEXT(modCsdClk,                modCsxClk,               STATIC | WRITABLE | REINIT)\
+    NEXT(modCsxClk,                tunerCnt,                VOLATILE)
+
+/* Widget context. The status and the gesture and touch results are
+ * updated by every scan. The resolution, the sense clock and the IDACs
+ * change the raw counts. With SmartSense, the middleware sets the
+ * thresholds and the hysteresis from the signal, and calibration sets the
+ * resolution, the sense clocks and the modulator IDACs, so these fields
+ * are volatile even though the tuner may write them */
+#define WIDGET_LAYOUT(FIRST, NEXT)\
+    FIRST(                         fingerCap,               STATIC | WRITABLE)\
+    NEXT(fingerCap,                sigPFC,                  STATIC | WRITABLE)\
+    NEXT(sigPFC,                   resolution,              VOLATILE | WRITABLE | REINIT)\
+    NEXT(resolution,               maxRawCount,             VOLATILE)\
+    NEXT(maxRawCount,              fingerTh,                VOLATILE | WRITABLE)\
+    NEXT(fingerTh,                 proxTh,                  STATIC | WRITABLE)\
+    NEXT(proxTh,                   lowBslnRst,              STATIC | WRITABLE)\
+    NEXT(lowBslnRst,               snsClk,                  VOLATILE | WRITABLE | REINIT)\
+    NEXT(snsClk,                   rowSnsClk,               VOLATILE | WRITABLE | REINIT)\
+    NEXT(rowSnsClk,                gestureDetected,         VOLATILE)\
+    NEXT(gestureDetected,          gestureDirection,        VOLATILE)\
+    NEXT(gestureDirection,         xDelta,                  VOLATILE)\
+    NEXT(xDelta,                   yDelta,                  VOLATILE)\
+    NEXT(yDelta,                   noiseTh,                 VOLATILE | WRITABLE)\
+    NEXT(noiseTh,                  nNoiseTh,                VOLATILE | WRITABLE)\
+    NEXT(nNoiseTh,                 hysteresis,              VOLATILE | WRITABLE)\
+    NEXT(hysteresis,               onDebounce,              STATIC | WRITABLE)\
+    NEXT(onDebounce,               snsClkSource,            VOLATILE | WRITABLE | REINIT)\
+    NEXT(snsClkSource,             idacMod,                 VOLATILE | WRITABLE | REINIT)\
+    NEXT(idacMod,                  idacGainIndex,           VOLATILE | WRITABLE | REINIT)\
+    NEXT(idacGainIndex,            rowIdacMod,              VOLATILE | WRITABLE | REINIT)\
+    NEXT(rowIdacMod,               bslnCoeff,               STATIC | WRITABLE)\
+    NEXT(bslnCoeff,                status,                  VOLATILE)\
+    NEXT(status,                   wdTouch,                 VOLATILE)
+
+/* Sensor context: scan results; only the compensation IDAC is tuned, and
+ * it is also set by calibration */
+#define SENSOR_LAYOUT(FIRST, NEXT)\
+    FIRST(                         raw,                     VOLATILE)\
+    NEXT(raw,                      bsln,                    VOLATILE)\
+    NEXT(bsln,                     diff,                    VOLATILE)\
+    NEXT(diff,                     status,                  VOLATILE)\
+    NEXT(status,                   negBslnRstCnt,           VOLATILE)\
+    NEXT(negBslnRstCnt,            idacComp,                VOLATILE | WRITABLE | REINIT)\
+    NEXT(idacComp,                 bslnExt,                 VOLATILE)
+
+/* Class of the bytes that are not part of a listed field */
+#define UNLISTED_CLASS               (VOLATILE)
+
+
+/*******************************************************************************
+ * Data Types
+ ******************************************************************************/
+/* Field of an element */
+typedef struct
+{
+    uint16_t offset;
+    uint16_t size;
+    uint8_t cls;
+} layout_field_t;
+
+
+/* Array of elements in cy_stc_capsense_tuner_t */
+typedef struct
+{
+    uint16_t offset;
+    uint16_t size;
+    uint16_t element_size;
+    const layout_field_t *fields;
+    uint8_t field_count;
+} layout_array_t;
+
+
+/*******************************************************************************
+ * Layout checks
+ ******************************************************************************/
+COMMON_LAYOUT(COMMON_ASSERT_FIRST, COMMON_ASSERT_NEXT)
+LAYOUT_ASSERT_LAST(cy_stc_capsense_common_context_t, tunerCnt)
+
+WIDGET_LAYOUT(WIDGET_ASSERT_FIRST, WIDGET_ASSERT_NEXT)
+LAYOUT_ASSERT_LAST(cy_stc_capsense_widget_context_t, wdTouch)
+
+SENSOR_LAYOUT(SENSOR_ASSERT_FIRST, SENSOR_ASSERT_NEXT)
+LAYOUT_ASSERT_LAST(cy_stc_capsense_sensor_context_t, bslnExt)
+
+
+/*******************************************************************************
+ * Global variables
+ ******************************************************************************/
+static const layout_field_t common_fields[] =
+{
+    COMMON_LAYOUT(COMMON_FIRST, COMMON_NEXT)
+};
+
+static const layout_field_t widget_fields[] =
+{
+    WIDGET_LAYOUT(WIDGET_FIRST, WIDGET_NEXT)
+};
+
+static const layout_field_t sensor_fields[] =
+{
+    SENSOR_LAYOUT(SENSOR_FIRST, SENSOR_NEXT)
+};
+
+/* The common context is handled as an array of one element. The members
+ * after the sensor contexts depend on the widgets of the configuration
+ * (positions and other results); they are not listed and so are volatile
+ * and read-only */
+static const layout_array_t tuner_layout[] =
+{
+    { (uint16_t)offsetof(cy_stc_capsense_tuner_t, commonContext),
+      (uint16_t)sizeof(cy_capsense_tuner.commonContext),
+      (uint16_t)sizeof(cy_capsense_tuner.commonContext),
+      common_fields,
+      (uint8_t)(sizeof(common_fields) / sizeof(common_fields[0])) },
+    LAYOUT_ARRAY(widgetContext, widget_fields),
+    LAYOUT_ARRAY(sensorContext, sensor_fields),
+};
+
+
+/*******************************************************************************
+* Function Name: tuner_layout_class
+********************************************************************************
+*
+* Summary:
+*   Looks up the field of cy_capsense_tuner a byte belongs to.
+*
+* Parameters:
+*  uint16_t offset       : Offset of the byte in cy_capsense_tuner
+*  uint16_t *field_start : Set to the offset of the field, or of the byte
+*                          itself if it is not part of a listed field
+*  uint16_t *field_size  : Set to the size of the field, 1 if unlisted
+*
+* Return:
+*   Class of the field, TUNER_LAYOUT_* flags
+*
+*******************************************************************************/
+uint8_t tuner_layout_class(uint16_t offset, uint16_t *field_start,
+                           uint16_t *field_size)
+{
+    const layout_array_t *array = NULL;
+    const layout_field_t *field = NULL;
+    uint16_t element_start = 0;
+    uint16_t pos = 0;
+
+    *field_start = offset;
+    *field_size = 1u;
+
+    for(uint8_t i = 0; i < (sizeof(tuner_layout) / sizeof(tuner_layout[0])); i++)
+    {
+        array = &tuner_layout[i];
+        if((offset < array->offset) || (offset >= (array->offset + array->size)))
+        {
+            continue;
+        }
+
+        pos = (offset - array->offset) % array->element_size;
+        element_start = offset - pos;
+
+        for(uint8_t j = 0; j < array->field_count; j++)
+        {
+            field = &array->fields[j];
+            if((pos >= field->offset) && (pos < (field->offset + field->size)))
+            {
+                *field_start = element_start + field->offset;
+                *field_size = field->size;
+                return field->cls;
+            }
+        }
+        break;
+    }
+
+    return UNLISTED_CLASS;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_layout_write_allowed
+********************************************************************************
+*
+* Summary:
+*   Checks a tuner write against the layout. A write has to lie inside a
+*   single writable field; writes that straddle two fields or touch a
+*   read-only byte are refused.
+*
+* Parameters:
+*  uint16_t offset : Offset of the write in cy_capsense_tuner
+*  uint16_t len    : Number of bytes written
+*
+* Return:
+*   true if the write may be applied
+*
+*******************************************************************************/
+bool tuner_layout_write_allowed(uint16_t offset, uint16_t len)
+{
+    uint16_t field_start = 0;
+    uint16_t field_size = 0;
+    uint8_t cls = 0;
+
+    if((len == 0u) || (((uint32_t)offset + len) > sizeof(cy_capsense_tuner)))
+    {
+        return false;
+    }
+
+    cls = tuner_layout_class(offset, &field_start, &field_size);
+
+    return (((cls & TUNER_LAYOUT_WRITABLE) != 0u) &&\
+            (((uint32_t)offset + len) <= ((uint32_t)field_start + field_size)));
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_layout_is_static
+********************************************************************************
+*
+* Summary:
+*   Returns true if every byte of a range of cy_capsense_tuner belongs to a
+*   static field, i.e. the range only changes when the tuner writes it.
+*
+* Parameters:
+*  uint16_t offset : Offset of the range in cy_capsense_tuner
+*  uint16_t len    : Length of the range
+*
+*******************************************************************************/
+bool tuner_layout_is_static(uint16_t offset, uint16_t len)
+{
+    uint32_t end = (uint32_t)offset + len;
+    uint32_t pos = offset;
+    uint16_t field_start = 0;
+    uint16_t field_size = 0;
+
+    while(pos < end)
+    {
+        if((tuner_layout_class((uint16_t)pos, &field_start, &field_size) &\
+            TUNER_LAYOUT_VOLATILE) != 0u)
+        {
+            return false;
+        }
+        pos = (uint32_t)field_start + field_size;
+    }
+
+    return true;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_layout_widget
+********************************************************************************
+*
+* Summary:
+*   Returns the widget a byte of cy_capsense_tuner belongs to: the widget of
+*   a widget context, or the widget that owns a sensor context.
+*
+* Parameters:
+*  uint16_t offset : Offset of the byte in cy_capsense_tuner
+*
+* Return:
+*   Widget index, or TUNER_LAYOUT_NO_WIDGET
+*
+*******************************************************************************/
+uint32_t tuner_layout_widget(uint16_t offset)
+{
+    const cy_stc_capsense_widget_config_t *wd_config = NULL;
+    uint32_t sensor = 0;
+    uint32_t first = 0;
+
+    if((offset >= offsetof(cy_stc_capsense_tuner_t, widgetContext)) &&\
+       (offset < (offsetof(cy_stc_capsense_tuner_t, widgetContext) +\
+                  sizeof(cy_capsense_tuner.widgetContext))))
+    {
+        return (offset - offsetof(cy_stc_capsense_tuner_t, widgetContext)) /\
+               sizeof(cy_capsense_tuner.widgetContext[0]);
+    }
+
+    if((offset >= offsetof(cy_stc_capsense_tuner_t, sensorContext)) &&\
+       (offset < (offsetof(cy_stc_capsense_tuner_t, sensorContext) +\
+                  sizeof(cy_capsense_tuner.sensorContext))))
+    {
+        sensor = (offset - offsetof(cy_stc_capsense_tuner_t, sensorContext)) /\
+                 sizeof(cy_capsense_tuner.sensorContext[0]);
+
+        /* The sensor contexts of a widget follow one another */
+        for(uint32_t widget = 0; widget < CY_CAPSENSE_WIDGET_COUNT; widget++)
+        {
+            wd_config = &cy_capsense_context.ptrWdConfig[widget];
+            first = (uint32_t)(wd_config->ptrSnsContext -\
+                               cy_capsense_tuner.sensorContext);
+            if((sensor >= first) && (sensor < (first + wd_config->numSns)))
+            {
+                return widget;
+            }
+        }
+    }
+
+    return TUNER_LAYOUT_NO_WIDGET;
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,88 @@
+/******************************************************************************
+* File Name: tuner_layout.h
+*
+* Description: This file is public interface of tuner_layout.c
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include guard
+ *****************************************************************************/
+#ifndef TUNER_LAYOUT_H_
+#define TUNER_LAYOUT_H_
+
+/******************************************************************************
+ * Include header files
+ *****************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+/* Field classes. A volatile field can change with every scan; a static one
+ * only changes when the tuner writes it. Only writable fields may be
+ * written by the tuner. Bytes that are not part of a listed field are
+ * volatile and read-only */
+#define TUNER_LAYOUT_VOLATILE        (0x01u)
+#define TUNER_LAYOUT_WRITABLE        (0x02u)
+
+/* Writing the field changes the raw counts of the widget, so its baseline
+ * has to be initialized again; outside the widget and sensor contexts, of
+ * every widget */
+#define TUNER_LAYOUT_REINIT          (0x04u)
+
+/* The field is the tuner command. The middleware polls it while the tuner
+ * is suspended, so a write to it cannot wait for the frame boundary */
+#define TUNER_LAYOUT_COMMAND         (0x08u)
+
+/* Returned by tuner_layout_widget() outside the widget and sensor contexts */
+#define TUNER_LAYOUT_NO_WIDGET       (0xFFFFFFFFu)
+
+
+/******************************************************************************
+ * Function Prototypes
+ *****************************************************************************/
+uint8_t tuner_layout_class(uint16_t offset, uint16_t *field_start,
+                           uint16_t *field_size);
+bool tuner_layout_write_allowed(uint16_t offset, uint16_t len);
+bool tuner_layout_is_static(uint16_t offset, uint16_t len);
+uint32_t tuner_layout_widget(uint16_t offset);
+
+
+#endif /* TUNER_LAYOUT_H_ */
@@ -0,0 +1,590 @@
+/******************************************************************************
+* File Name: tuner_link.c
+*
+* Description: This file contains the link manager that negotiates the data
+*              length, the PHY and the connection interval of each BLE
+*              connection for the highest tuner throughput the peer accepts,
+*              and keeps the tuner transport informed of the link parameters in
+*              force.
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <string.h>
+#include <stdio.h>
+#include "cyhal.h"
+#include "cycfg_ble.h"
+#include "tuner_link.h"
+#include "tuner_transport.h"
+#include "tuner_time.h"
+
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define ENABLE                       (1u)
+#define DISABLE                      (0u)
+#define DEBUG_LINK_ENABLE            (DISABLE)
+
+#if DEBUG_LINK_ENABLE
+#define DEBUG_PRINTF                 (printf)
+#else
+#define DEBUG_PRINTF(...)
+#endif
+
+#define SUCCESS                      (0u)
+
+/* Largest LL payload and the time it takes on the 1M PHY */
+#define LINK_MAX_TX_OCTETS           (251u)
+#define LINK_MAX_TX_TIME_US          (2120u)
+
+/* Connection intervals requested in turn, in 1.25 ms units: 7.5 ms, then
+ * 15 ms (the shortest some phones accept), then 30 ms */
+#define LINK_INTERVAL_COUNT          (3u)
+#define LINK_INTERVAL_7_5_MS         (6u)
+#define LINK_INTERVAL_15_MS          (12u)
+#define LINK_INTERVAL_30_MS          (24u)
+#define LINK_SLAVE_LATENCY           (0u)
+#define LINK_SUPERVISION_TIMEOUT     (400u)     /* 10 ms units */
+#define LINK_CONN_PARAM_ACCEPTED     (0u)
+#define INTERVAL_UNIT_US             (1250u)
+
+/* A request the stack refused is retried after LINK_RETRY_MS, at most
+ * LINK_MAX_RETRIES times. A procedure the peer does not answer within
+ * LINK_STEP_TIMEOUT_MS keeps the values in force */
+#define LINK_RETRY_MS                (100u)
+#define LINK_MAX_RETRIES             (5u)
+#define LINK_STEP_TIMEOUT_MS         (2000u)
+
+/* Returned when no link matches */
+#define NO_LINK                      (0xFFu)
+
+
+/*******************************************************************************
+ * Data Types
+ ******************************************************************************/
+/* Negotiation steps, run one at a time so that the LL procedures do not
+ * collide */
+typedef enum
+{
+    LINK_STEP_DATA_LENGTH,      /* Data length extension */
+    LINK_STEP_PHY,              /* 2M PHY, else stay on 1M */
+    LINK_STEP_CONN_INTERVAL,    /* Shortest connection interval accepted */
+    LINK_STEP_DONE
+} tuner_link_step_t;
+
+
+/* Negotiation state of one connection */
+typedef struct
+{
+    bool active;
+    uint8_t bd_handle;
+    tuner_link_step_t step;
+    bool requested;             /* The stack accepted the request of the step */
+    uint8_t retries;            /* Requests of the step refused by the stack */
+    uint8_t interval_index;     /* Next entry of link_intervals to request */
+    uint32_t step_start;        /* Time base value at the last request */
+    tuner_link_params_t params;
+} tuner_link_t;
+
+
+/*******************************************************************************
+ * Global variables
+ ******************************************************************************/
+static tuner_link_t tuner_links[CY_BLE_CONN_COUNT];
+
+static const uint16_t link_intervals[LINK_INTERVAL_COUNT] =
+{
+    LINK_INTERVAL_7_5_MS, LINK_INTERVAL_15_MS, LINK_INTERVAL_30_MS
+};
+
+
+/*******************************************************************************
+ * Function Prototypes
+*******************************************************************************/
+static uint8_t tuner_link_find(uint8_t bd_handle);
+static bool tuner_link_step_needed(const tuner_link_t *lnk);
+static cy_en_ble_api_result_t tuner_link_request(tuner_link_t *lnk);
+static void tuner_link_advance(uint8_t link);
+static void tuner_link_update_transport(uint8_t link);
+
+
+/*******************************************************************************
+* Function Name: tuner_link_start
+********************************************************************************
+*
+* Summary:
+*   Starts the negotiation on a new connection. The link parameters start
+*   at their defaults and are handed to the tuner transport session with
+*   the same index.
+*
+* Parameters:
+*  uint8_t link           : Index of the connection, below CY_BLE_CONN_COUNT
+*  uint8_t bd_handle      : BD handle of the connection
+*  uint16_t conn_interval : Connection interval chosen by the central
+*
+*******************************************************************************/
+void tuner_link_start(uint8_t link, uint8_t bd_handle, uint16_t conn_interval)
+{
+    tuner_link_t *lnk = &tuner_links[link];
+
+    memset(lnk, 0, sizeof(tuner_link_t));
+    lnk->active = true;
+    lnk->bd_handle = bd_handle;
+    lnk->step = LINK_STEP_DATA_LENGTH;
+    lnk->step_start = tuner_time_us() - (LINK_RETRY_MS * TUNER_TIME_US_PER_MS);
+    lnk->params.mtu = DEFAULT_ATT_MTU;
+    lnk->params.tx_octets = DEFAULT_LL_TX_OCTETS;
+    lnk->params.conn_interval = conn_interval;
+    lnk->params.tx_phy = CY_BLE_PHY_MASK_LE_1M;
+    lnk->params.rx_phy = CY_BLE_PHY_MASK_LE_1M;
+
+    tuner_link_update_transport(link);
+
+    /* The central may already have chosen the PHY */
+    (void)Cy_BLE_GetPhy(bd_handle);
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_link_stop
+********************************************************************************
+*
+* Summary:
+*   Stops the negotiation of a connection that went away.
+*
+* Parameters:
+*  uint8_t link : Index of the connection
+*
+*******************************************************************************/
+void tuner_link_stop(uint8_t link)
+{
+    tuner_links[link].active = false;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_link_event
+********************************************************************************
+*
+* Summary:
+*   Called with every BLE stack event. Keeps the link parameters of each
+*   connection up to date, whichever side started the procedure, and moves
+*   the negotiation on when the peer answered. A refused connection
+*   interval falls back to the next longer one.
+*
+* Parameters:
+*  uint32_t event   : Event from the BLE stack
+*  void* eventParam : Pointer to the value of event specific parameters
+*
+*******************************************************************************/
+void tuner_link_event(uint32_t event, void *eventParam)
+{
+    uint8_t link = NO_LINK;
+    tuner_link_t *lnk = NULL;
+
+    switch(event)
+    {
+    case CY_BLE_EVT_GATTS_XCNHG_MTU_REQ:
+    {
+        cy_stc_ble_gatt_xchg_mtu_param_t *mtu_param =\
+                (cy_stc_ble_gatt_xchg_mtu_param_t *)eventParam;
+
+        link = tuner_link_find(mtu_param->connHandle.bdHandle);
+        if(link != NO_LINK)
+        {
+            tuner_links[link].params.mtu = (mtu_param->mtu < CY_BLE_GATT_MTU) ?\
+                                           mtu_param->mtu : CY_BLE_GATT_MTU;
+            DEBUG_PRINTF("Link %u: MTU %u\r\n", link, tuner_links[link].params.mtu);
+            tuner_link_update_transport(link);
+        }
+        break;
+    }
+
+    case CY_BLE_EVT_DATA_LENGTH_CHANGE:
+    {
+        cy_stc_ble_data_length_param_t *dle_param =\
+                (cy_stc_ble_data_length_param_t *)eventParam;
+
+        link = tuner_link_find(dle_param->bdHandle);
+        if(link != NO_LINK)
+        {
+            lnk = &tuner_links[link];
+            lnk->params.tx_octets = dle_param->connMaxTxOctets;
+            DEBUG_PRINTF("Link %u: data length %u\r\n", link,\
+                         lnk->params.tx_octets);
+            tuner_link_update_transport(link);
+
+            if((lnk->step == LINK_STEP_DATA_LENGTH) && (lnk->requested == true))
+            {
+                tuner_link_advance(link);
+            }
+        }
+        break;
+    }
+
+    case CY_BLE_EVT_PHY_UPDATE_COMPLETE:
+    case CY_BLE_EVT_GET_PHY_COMPLETE:
+    {
+        cy_stc_ble_events_param_generic_t *param =\
+                (cy_stc_ble_events_param_generic_t *)eventParam;
+        cy_stc_ble_phy_param_t *phyparam = NULL;
+
+        if(param->status != SUCCESS)
+        {
+            /* The request times out and the link stays on its PHY */
+            break;
+        }
+
+        phyparam = (cy_stc_ble_phy_param_t *)param->eventParams;
+        link = tuner_link_find(phyparam->bdHandle);
+        if(link != NO_LINK)
+        {
+            lnk = &tuner_links[link];
+            lnk->params.tx_phy = phyparam->txPhyMask;
+            lnk->params.rx_phy = phyparam->rxPhyMask;
+            DEBUG_PRINTF("Link %u: TxPhy 0x%02X RxPhy 0x%02X\r\n", link,\
+                         phyparam->txPhyMask, phyparam->rxPhyMask);
+
+            /* The peer answered; 1M is kept if it did not take 2M */
+            if((event == CY_BLE_EVT_PHY_UPDATE_COMPLETE) &&\
+               (lnk->step == LINK_STEP_PHY) && (lnk->requested == true))
+            {
+                tuner_link_advance(link);
+            }
+        }
+        break;
+    }
+
+    case CY_BLE_EVT_L2CAP_CONN_PARAM_UPDATE_RSP:
+    {
+        cy_stc_ble_l2cap_conn_update_rsp_param_t *rsp_param =\
+                (cy_stc_ble_l2cap_conn_update_rsp_param_t *)eventParam;
+
+        link = tuner_link_find(rsp_param->bdHandle);
+        if(link != NO_LINK)
+        {
+            lnk = &tuner_links[link];
+            if((lnk->step == LINK_STEP_CONN_INTERVAL) &&\
+               (rsp_param->result != LINK_CONN_PARAM_ACCEPTED))
+            {
+                /* Refused; try the next longer interval */
+                DEBUG_PRINTF("Link %u: interval %u refused\r\n", link,\
+                             link_intervals[lnk->interval_index]);
+                lnk->interval_index++;
+                lnk->requested = false;
+                lnk->retries = 0;
+            }
+        }
+        break;
+    }
+
+    case CY_BLE_EVT_GAP_CONNECTION_UPDATE_COMPLETE:
+    {
+        cy_stc_ble_gap_conn_param_updated_in_controller_t *upd_param =\
+                (cy_stc_ble_gap_conn_param_updated_in_controller_t *)eventParam;
+
+        link = tuner_link_find(upd_param->bdHandle);
+        if((link != NO_LINK) && (upd_param->status == SUCCESS))
+        {
+            lnk = &tuner_links[link];
+            lnk->params.conn_interval = upd_param->connIntv;
+            DEBUG_PRINTF("Link %u: interval %u\r\n", link, upd_param->connIntv);
+
+            if((lnk->step == LINK_STEP_CONN_INTERVAL) && (lnk->requested == true))
+            {
+                tuner_link_advance(link);
+            }
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_link_process
+********************************************************************************
+*
+* Summary:
+*   Called from the main loop. Sends the request of the current step of
+*   each connection, retries it if the stack refused it, and gives up on a
+*   step the peer does not answer.
+*
+*******************************************************************************/
+void tuner_link_process(void)
+{
+    tuner_link_t *lnk = NULL;
+    uint32_t elapsed = 0;
+
+    for(uint8_t link = 0; link < CY_BLE_CONN_COUNT; link++)
+    {
+        lnk = &tuner_links[link];
+        if((lnk->active == false) || (lnk->step == LINK_STEP_DONE))
+        {
+            continue;
+        }
+
+        elapsed = tuner_time_us() - lnk->step_start;
+
+        if(lnk->requested == true)
+        {
+            if(elapsed >= (LINK_STEP_TIMEOUT_MS * TUNER_TIME_US_PER_MS))
+            {
+                DEBUG_PRINTF("Link %u: step %u timed out\r\n", link, lnk->step);
+                tuner_link_advance(link);
+            }
+        }
+        else if((tuner_link_step_needed(lnk) == false) ||\
+                (lnk->retries >= LINK_MAX_RETRIES))
+        {
+            tuner_link_advance(link);
+        }
+        else if(elapsed >= (LINK_RETRY_MS * TUNER_TIME_US_PER_MS))
+        {
+            lnk->step_start = tuner_time_us();
+            if(tuner_link_request(lnk) == CY_BLE_SUCCESS)
+            {
+                lnk->requested = true;
+            }
+            else
+            {
+                lnk->retries++;
+            }
+        }
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_link_params
+********************************************************************************
+*
+* Summary:
+*   Returns the link parameters in force on a connection.
+*
+* Parameters:
+*  uint8_t link : Index of the connection
+*
+*******************************************************************************/
+const tuner_link_params_t *tuner_link_params(uint8_t link)
+{
+    return &tuner_links[link].params;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_link_find
+********************************************************************************
+*
+* Summary:
+*   Returns the index of the connection with the given BD handle, NO_LINK
+*   if there is none.
+*
+*******************************************************************************/
+static uint8_t tuner_link_find(uint8_t bd_handle)
+{
+    for(uint8_t link = 0; link < CY_BLE_CONN_COUNT; link++)
+    {
+        if((tuner_links[link].active == true) &&\
+           (tuner_links[link].bd_handle == bd_handle))
+        {
+            return link;
+        }
+    }
+
+    return NO_LINK;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_link_step_needed
+********************************************************************************
+*
+* Summary:
+*   Returns false if the current step has nothing left to gain: the peer
+*   already set the value, or every connection interval was refused.
+*
+*******************************************************************************/
+static bool tuner_link_step_needed(const tuner_link_t *lnk)
+{
+    bool needed = false;
+
+    switch(lnk->step)
+    {
+    case LINK_STEP_DATA_LENGTH:
+        needed = (lnk->params.tx_octets < LINK_MAX_TX_OCTETS);
+        break;
+
+    case LINK_STEP_PHY:
+        needed = ((lnk->params.tx_phy != CY_BLE_PHY_MASK_LE_2M) ||\
+                  (lnk->params.rx_phy != CY_BLE_PHY_MASK_LE_2M));
+        break;
+
+    case LINK_STEP_CONN_INTERVAL:
+        needed = ((lnk->interval_index < LINK_INTERVAL_COUNT) &&\
+                  (lnk->params.conn_interval >\
+                   link_intervals[lnk->interval_index]));
+        break;
+
+    default:
+        break;
+    }
+
+    return needed;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_link_request
+********************************************************************************
+*
+* Summary:
+*   Sends the request of the current step to the BLE stack.
+*
+* Return:
+*   Result of the BLE stack API
+*
+*******************************************************************************/
+static cy_en_ble_api_result_t tuner_link_request(tuner_link_t *lnk)
+{
+    cy_en_ble_api_result_t api_result = CY_BLE_SUCCESS;
+
+    switch(lnk->step)
+    {
+    case LINK_STEP_DATA_LENGTH:
+    {
+        cy_stc_ble_set_data_length_info_t dle_param;
+
+        dle_param.bdHandle = lnk->bd_handle;
+        dle_param.connMaxTxOctets = LINK_MAX_TX_OCTETS;
+        dle_param.connMaxTxTime = LINK_MAX_TX_TIME_US;
+        api_result = Cy_BLE_SetDataLength(&dle_param);
+        break;
+    }
+
+    case LINK_STEP_PHY:
+    {
+        cy_stc_ble_set_phy_info_t phy_param;
+
+        phy_param.bdHandle = lnk->bd_handle;
+        phy_param.allPhyMask = CY_BLE_PHY_NO_PREF_MASK_NONE;
+        phy_param.txPhyMask = CY_BLE_PHY_MASK_LE_2M;
+        phy_param.rxPhyMask = CY_BLE_PHY_MASK_LE_2M;
+        phy_param.phyOption = 0u;
+        api_result = Cy_BLE_SetPhy(&phy_param);
+        break;
+    }
+
+    case LINK_STEP_CONN_INTERVAL:
+    {
+        cy_stc_ble_gap_conn_update_param_info_t conn_param;
+
+        conn_param.bdHandle = lnk->bd_handle;
+        conn_param.connIntvMin = link_intervals[lnk->interval_index];
+        conn_param.connIntvMax = link_intervals[lnk->interval_index];
+        conn_param.connLatency = LINK_SLAVE_LATENCY;
+        conn_param.supervisionTO = LINK_SUPERVISION_TIMEOUT;
+        api_result = Cy_BLE_L2CAP_LeConnectionParamUpdateRequest(&conn_param);
+        break;
+    }
+
+    default:
+        break;
+    }
+
+    DEBUG_PRINTF("Link request, step %u: 0x%X\r\n", lnk->step, api_result);
+
+    return api_result;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_link_advance
+********************************************************************************
+*
+* Summary:
+*   Moves a connection to its next negotiation step and prints the link
+*   parameters once the last step is over.
+*
+*******************************************************************************/
+static void tuner_link_advance(uint8_t link)
+{
+    tuner_link_t *lnk = &tuner_links[link];
+    uint32_t interval_us = 0;
+
+    lnk->step++;
+    lnk->requested = false;
+    lnk->retries = 0;
+    lnk->step_start = tuner_time_us() - (LINK_RETRY_MS * TUNER_TIME_US_PER_MS);
+
+    if(lnk->step == LINK_STEP_DONE)
+    {
+        interval_us = (uint32_t)lnk->params.conn_interval * INTERVAL_UNIT_US;
+        printf("GATT Client %u link: interval %lu.%02lu ms, data length %u, "\
+               "%s PHY, MTU %u\r\n",\
+               link, (unsigned long)(interval_us / 1000u),\
+               (unsigned long)((interval_us % 1000u) / 10u),\
+               lnk->params.tx_octets,\
+               (lnk->params.tx_phy == CY_BLE_PHY_MASK_LE_2M) ? "2M" : "1M",\
+               lnk->params.mtu);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_link_update_transport
+********************************************************************************
+*
+* Summary:
+*   Hands the ATT MTU and the data length in force to the tuner transport,
+*   which sizes the notification packets of the connection from them.
+*
+*******************************************************************************/
+static void tuner_link_update_transport(uint8_t link)
+{
+    tuner_transport_set_link(link, tuner_links[link].params.mtu,\
+                             tuner_links[link].params.tx_octets);
+}
+
+
+/* [] END OF FILE */
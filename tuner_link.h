@@ -0,0 +1,79 @@
+/******************************************************************************
+* File Name: tuner_link.h
+*
+* Description: This file is public interface of tuner_link.c
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include guard
+ *****************************************************************************/
+#ifndef TUNER_LINK_H_
+#define TUNER_LINK_H_
+
+/******************************************************************************
+ * Include header files
+ *****************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/******************************************************************************
+ * Data Types
+ *****************************************************************************/
+/* Link parameters in force on one connection */
+typedef struct
+{
+    uint16_t mtu;               /* ATT MTU */
+    uint16_t tx_octets;         /* Maximum LL transmit payload */
+    uint16_t conn_interval;     /* Connection interval, 1.25 ms units */
+    uint8_t tx_phy;             /* Transmit PHY, CY_BLE_PHY_MASK_* */
+    uint8_t rx_phy;             /* Receive PHY, CY_BLE_PHY_MASK_* */
+} tuner_link_params_t;
+
+
+/******************************************************************************
+ * Function Prototypes
+ *****************************************************************************/
+void tuner_link_start(uint8_t link, uint8_t bd_handle, uint16_t conn_interval);
+void tuner_link_stop(uint8_t link);
+void tuner_link_event(uint32_t event, void *eventParam);
+void tuner_link_process(void);
+const tuner_link_params_t *tuner_link_params(uint8_t link);
+
+
+#endif /* TUNER_LINK_H_ */
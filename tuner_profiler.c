@@ -0,0 +1,247 @@
+/******************************************************************************
+* File Name: tuner_profiler.c
+*
+* Description: This file contains a cycle counter based profiler that keeps
+*              min/max/mean and a log2 histogram of the time spent in each
+*              phase of the main loop.
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <string.h>
+#include <stdio.h>
+#include "cyhal.h"
+#include "tuner_profiler.h"
+
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Seconds between two reports; the statistics restart after each report */
+#define PROFILER_REPORT_PERIOD_S     (10u)
+
+/* Histogram bucket i counts the samples of 2^(i + PROFILER_HIST_MIN_LOG2)
+ * up to 2^(i + PROFILER_HIST_MIN_LOG2 + 1) - 1 cycles; the first and the
+ * last bucket also take the shorter and the longer samples */
+#define PROFILER_HIST_BUCKETS        (16u)
+#define PROFILER_HIST_MIN_LOG2       (8u)
+#define MSB_BIT_INDEX                (31u)
+
+
+/*******************************************************************************
+ * Data Types
+ ******************************************************************************/
+/* Statistics of one phase */
+typedef struct
+{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t hist[PROFILER_HIST_BUCKETS];
+} profiler_stats_t;
+
+
+/*******************************************************************************
+ * Global variables
+ ******************************************************************************/
+#if (PROFILER_ENABLE == PROFILER_ON)
+static profiler_stats_t profiler_stats[PROFILER_PHASE_COUNT];
+
+/* Time base value at the start of the current report period */
+static uint32_t profiler_period_start = 0;
+static uint32_t profiler_periods = 0;
+
+static const char * const profiler_phase_names[PROFILER_PHASE_COUNT] =
+{
+    "scan", "process", "run_tuner", "frame_start", "notify", "ble_events",
+    "frame_gap"
+};
+#endif
+
+
+/*******************************************************************************
+ * Function Prototypes
+*******************************************************************************/
+#if (PROFILER_ENABLE == PROFILER_ON)
+static void profiler_reset(void);
+#endif
+
+
+/*******************************************************************************
+* Function Name: profiler_init
+********************************************************************************
+* Summary:
+*  Starts the CPU cycle counter used to time the phases. The report period
+*  runs on the time base of tuner_time.c, which must be started first.
+*
+*******************************************************************************/
+void profiler_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0u;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+#if (PROFILER_ENABLE == PROFILER_ON)
+    profiler_reset();
+    profiler_period_start = tuner_time_us();
+#endif
+}
+
+
+/*******************************************************************************
+* Function Name: profiler_record
+********************************************************************************
+* Summary:
+*  Adds one sample to the statistics of a phase. Use PROFILER_STOP() rather
+*  than calling this directly, so that the call is compiled out with the
+*  profiler.
+*
+* Parameters:
+*  profiler_phase_t phase : Phase the sample belongs to
+*  uint32_t cycles        : Duration of the phase in CPU cycles
+*
+*******************************************************************************/
+void profiler_record(profiler_phase_t phase, uint32_t cycles)
+{
+#if (PROFILER_ENABLE == PROFILER_ON)
+    profiler_stats_t *stats = &profiler_stats[phase];
+    uint32_t bucket = 0;
+
+    if(cycles >= (1u << PROFILER_HIST_MIN_LOG2))
+    {
+        bucket = (MSB_BIT_INDEX - __CLZ(cycles)) - PROFILER_HIST_MIN_LOG2;
+        if(bucket >= PROFILER_HIST_BUCKETS)
+        {
+            bucket = PROFILER_HIST_BUCKETS - 1u;
+        }
+    }
+
+    stats->count++;
+    stats->sum += cycles;
+    stats->hist[bucket]++;
+
+    if(cycles < stats->min)
+    {
+        stats->min = cycles;
+    }
+
+    if(cycles > stats->max)
+    {
+        stats->max = cycles;
+    }
+#else
+    (void)phase;
+    (void)cycles;
+#endif
+}
+
+
+/*******************************************************************************
+* Function Name: profiler_update
+********************************************************************************
+* Summary:
+*  Called from the main loop. Every PROFILER_REPORT_PERIOD_S seconds, prints
+*  one line per phase over the debug UART and restarts the statistics:
+*  PROF,<period>,<phase>,<count>,<min>,<mean>,<max>,<histogram buckets...>
+*  All times are in CPU cycles.
+*
+*******************************************************************************/
+void profiler_update(void)
+{
+#if (PROFILER_ENABLE == PROFILER_ON)
+    profiler_stats_t *stats = NULL;
+
+    if((tuner_time_us() - profiler_period_start) <
+       (TUNER_TIME_US_PER_S * PROFILER_REPORT_PERIOD_S))
+    {
+        return;
+    }
+
+    for(uint32_t phase = 0; phase < PROFILER_PHASE_COUNT; phase++)
+    {
+        stats = &profiler_stats[phase];
+        if(stats->count == 0u)
+        {
+            continue;
+        }
+
+        printf("PROF,%lu,%s,%lu,%lu,%lu,%lu", (unsigned long)profiler_periods,
+               profiler_phase_names[phase], (unsigned long)stats->count,
+               (unsigned long)stats->min,
+               (unsigned long)(stats->sum / stats->count),
+               (unsigned long)stats->max);
+
+        for(uint32_t bucket = 0; bucket < PROFILER_HIST_BUCKETS; bucket++)
+        {
+            printf(",%lu", (unsigned long)stats->hist[bucket]);
+        }
+        printf("\r\n");
+    }
+
+    profiler_reset();
+    profiler_periods++;
+
+    /* Report time is not part of the next period */
+    profiler_period_start = tuner_time_us();
+#endif
+}
+
+
+#if (PROFILER_ENABLE == PROFILER_ON)
+/*******************************************************************************
+* Function Name: profiler_reset
+********************************************************************************
+* Summary:
+*  Clears the statistics of every phase.
+*
+*******************************************************************************/
+static void profiler_reset(void)
+{
+    memset(profiler_stats, 0, sizeof(profiler_stats));
+
+    for(uint32_t phase = 0; phase < PROFILER_PHASE_COUNT; phase++)
+    {
+        profiler_stats[phase].min = UINT32_MAX;
+    }
+}
+#endif
+
+
+/* [] END OF FILE */
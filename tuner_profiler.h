@@ -0,0 +1,114 @@
+/******************************************************************************
+* File Name: tuner_profiler.h
+*
+* Description: This file is public interface of tuner_profiler.c
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include guard
+ *****************************************************************************/
+#ifndef TUNER_PROFILER_H_
+#define TUNER_PROFILER_H_
+
+/******************************************************************************
+ * Include header files
+ *****************************************************************************/
+#include "cyhal.h"
+#include "tuner_time.h"
+
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+/* Values of PROFILER_ENABLE. The header is included by files that define
+ * their own ENABLE and DISABLE, so the profiler uses names of its own */
+#define PROFILER_ON                  (1u)
+#define PROFILER_OFF                 (0u)
+
+/* Time the phases of the main loop and print the results over the debug
+ * UART. When disabled, the PROFILER_START and PROFILER_STOP macros compile
+ * to nothing */
+#define PROFILER_ENABLE              (PROFILER_OFF)
+
+/* The cycle counter stops while the CPU sleeps. Phases that can span a sleep
+ * use the _US variants, which read the time base and record the duration
+ * converted to CPU cycles */
+#define PROFILER_CYCLES_PER_US       (SystemCoreClock / TUNER_TIME_US_PER_S)
+
+#if (PROFILER_ENABLE == PROFILER_ON)
+#define PROFILER_START(start)        ((start) = DWT->CYCCNT)
+#define PROFILER_STOP(phase, start)  (profiler_record((phase),\
+                                                      DWT->CYCCNT - (start)))
+#define PROFILER_START_US(start)     ((start) = tuner_time_us())
+#define PROFILER_STOP_US(phase, start) (profiler_record((phase),\
+                                        (tuner_time_us() - (start)) *\
+                                        PROFILER_CYCLES_PER_US))
+#else
+#define PROFILER_START(start)        ((void)(start))
+#define PROFILER_STOP(phase, start)  ((void)(start))
+#define PROFILER_START_US(start)     ((void)(start))
+#define PROFILER_STOP_US(phase, start) ((void)(start))
+#endif
+
+
+/******************************************************************************
+ * Data Types
+ *****************************************************************************/
+/* Phases timed by the profiler */
+typedef enum
+{
+    PROFILER_PHASE_SCAN,        /* Scan of a widget, start to completion seen */
+    PROFILER_PHASE_PROCESS,     /* Cy_CapSense_ProcessWidget() */
+    PROFILER_PHASE_RUN_TUNER,   /* Cy_CapSense_RunTuner(), frame start included */
+    PROFILER_PHASE_FRAME_START, /* Snapshot, change detection and encoding */
+    PROFILER_PHASE_NOTIFY,      /* Handing frame packets to the BLE stack */
+    PROFILER_PHASE_BLE_EVENTS,  /* Cy_BLE_ProcessEvents() */
+    PROFILER_PHASE_FRAME_GAP,   /* Last scan complete to first scan started */
+    PROFILER_PHASE_COUNT
+} profiler_phase_t;
+
+
+/******************************************************************************
+ * Function Prototypes
+ *****************************************************************************/
+void profiler_init(void);
+void profiler_record(profiler_phase_t phase, uint32_t cycles);
+void profiler_update(void);
+
+
+#endif /* TUNER_PROFILER_H_ */
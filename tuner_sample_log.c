@@ -0,0 +1,446 @@
+/******************************************************************************
+* File Name: tuner_sample_log.c
+*
+* Description: This file contains the per-scan sample log. Selected sensor
+*              values are recorded after every complete scan into a RAM ring
+*              buffer and drained to the GATT clients in tightly packed
+*              notification packets, so no scan is lost while the buffer has
+*              room.
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <string.h>
+#include "cycfg_capsense.h"
+#include "tuner_sample_log.h"
+#include "tuner_transport.h"
+
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* RAM for the records; the depth of the log is this divided by the record
+ * size of the current selection */
+#define SAMPLE_LOG_SIZE              (8192u)
+
+/* Tuner_Samples write selecting what is recorded:
+ * Field mask, SAMPLE_FIELD_* (1 byte), 0 to stop recording
+ * First sensor (1 byte)
+ * Number of sensors (1 byte) */
+#define SAMPLE_CONFIG_SIZE           (3u)
+#define SAMPLE_CONFIG_FIELDS_IDX     (0u)
+#define SAMPLE_CONFIG_FIRST_IDX      (1u)
+#define SAMPLE_CONFIG_COUNT_IDX      (2u)
+
+/* Values of a sensor that can be recorded, in record order */
+#define SAMPLE_FIELD_RAW             (0x01u)
+#define SAMPLE_FIELD_DIFF            (0x02u)
+#define SAMPLE_FIELD_BSLN            (0x04u)
+#define SAMPLE_FIELD_ALL             (0x07u)
+
+/* Sample packet header: the selection the records were made with and the
+ * number of records that follow */
+#define SAMPLE_PKT_HDR_SIZE          (4u)
+#define SAMPLE_PKT_FIELDS_IDX        (0u)
+#define SAMPLE_PKT_FIRST_IDX         (1u)
+#define SAMPLE_PKT_COUNT_IDX         (2u)
+#define SAMPLE_PKT_RECORDS_IDX       (3u)
+#define SAMPLE_PKT_MAX_RECORDS       (255u)
+
+/* Record: scan sequence number (2 bytes) followed by the selected values
+ * (2 bytes each), sensor by sensor, all LSB first */
+#define SAMPLE_SEQ_SIZE              (2u)
+#define SAMPLE_VALUE_SIZE            (2u)
+#define BYTE_SHIFT                   (8u)
+#define LSB_MASK                     (0x00FFu)
+
+
+/*******************************************************************************
+ * Data Types
+ ******************************************************************************/
+/* Read position of one GATT client */
+typedef struct
+{
+    bool active;                /* Tuner_Samples notifications enabled */
+    uint32_t read_count;        /* Records sent to the client */
+    uint8_t pending;            /* Records in the packet last built */
+} sample_reader_t;
+
+
+/*******************************************************************************
+ * Global variables
+ ******************************************************************************/
+static uint8_t sample_log[SAMPLE_LOG_SIZE];
+static sample_reader_t sample_readers[TUNER_MAX_SESSIONS];
+
+/* Current selection, the size of one record and the number of records the
+ * log holds */
+static uint8_t sample_fields = 0;
+static uint8_t sample_first = 0;
+static uint8_t sample_count = 0;
+static uint16_t sample_record_size = 0;
+static uint16_t sample_depth = 0;
+
+/* Records written since power-up and the sequence number of the next scan.
+ * The sequence number also counts the scans that found the log full, so
+ * a GATT client sees every lost scan as a gap */
+static uint32_t sample_write_count = 0;
+static uint16_t sample_seq = 0;
+
+
+/*******************************************************************************
+ * Function Prototypes
+*******************************************************************************/
+static uint32_t sample_log_oldest(void);
+
+
+/*******************************************************************************
+* Function Name: tuner_sample_log_configure
+********************************************************************************
+*
+* Summary:
+*   Applies a selection written to the Tuner_Samples characteristic. The log
+*   is emptied for all GATT clients; the sequence numbers keep counting.
+*
+* Parameters:
+*  const uint8_t *data : Written value
+*  uint16_t len        : Length of the written value
+*  uint16_t max_len    : Smallest of the largest sample packets of the
+*                        writing client and of the subscribed clients; a
+*                        record has to fit in one packet
+*
+* Return:
+*   true if the selection is valid and was applied
+*
+*******************************************************************************/
+bool tuner_sample_log_configure(const uint8_t *data, uint16_t len,
+                                uint16_t max_len)
+{
+    uint8_t fields = 0;
+    uint8_t first = 0;
+    uint8_t count = 0;
+    uint8_t values_per_sensor = 0;
+    uint16_t record_size = 0;
+
+    if(len != SAMPLE_CONFIG_SIZE)
+    {
+        return false;
+    }
+
+    fields = data[SAMPLE_CONFIG_FIELDS_IDX];
+    first = data[SAMPLE_CONFIG_FIRST_IDX];
+    count = data[SAMPLE_CONFIG_COUNT_IDX];
+
+    if((fields & (uint8_t)~SAMPLE_FIELD_ALL) != 0u)
+    {
+        return false;
+    }
+
+    if((fields != 0u) && ((count == 0u) ||\
+       (((uint32_t)first + count) > CY_CAPSENSE_SENSOR_COUNT)))
+    {
+        return false;
+    }
+
+    for(uint8_t bit = SAMPLE_FIELD_RAW; bit <= SAMPLE_FIELD_BSLN; bit <<= 1u)
+    {
+        if((fields & bit) != 0u)
+        {
+            values_per_sensor++;
+        }
+    }
+
+    record_size = SAMPLE_SEQ_SIZE +\
+                  ((uint16_t)count * values_per_sensor * SAMPLE_VALUE_SIZE);
+    if((fields != 0u) && ((SAMPLE_PKT_HDR_SIZE + record_size) > max_len))
+    {
+        return false;
+    }
+
+    sample_fields = fields;
+    sample_first = first;
+    sample_count = count;
+    sample_record_size = record_size;
+    sample_depth = (fields == 0u) ? 0u : (SAMPLE_LOG_SIZE / record_size);
+
+    for(uint8_t i = 0; i < TUNER_MAX_SESSIONS; i++)
+    {
+        sample_readers[i].read_count = sample_write_count;
+        sample_readers[i].pending = 0;
+    }
+
+    return true;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_sample_log_subscribe
+********************************************************************************
+*
+* Summary:
+*   Starts draining the log to a GATT client that enabled the Tuner_Samples
+*   notifications. The client gets the scans recorded from now on.
+*
+* Parameters:
+*  uint8_t session : Session index, below TUNER_MAX_SESSIONS
+*
+*******************************************************************************/
+void tuner_sample_log_subscribe(uint8_t session)
+{
+    sample_readers[session].active = true;
+    sample_readers[session].read_count = sample_write_count;
+    sample_readers[session].pending = 0;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_sample_log_unsubscribe
+********************************************************************************
+*
+* Summary:
+*   Stops draining the log to a GATT client. The records it has not been sent
+*   no longer hold up the other clients.
+*
+* Parameters:
+*  uint8_t session : Session index
+*
+*******************************************************************************/
+void tuner_sample_log_unsubscribe(uint8_t session)
+{
+    sample_readers[session].active = false;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_sample_log_record
+********************************************************************************
+*
+* Summary:
+*   Called after every complete scan, once the results of all widgets are
+*   processed. Appends the selected values of the selected sensors to the
+*   log. Nothing is recorded while no selection is made or no GATT client
+*   drains the log. A scan that finds the log full is dropped; only its
+*   sequence number is used up.
+*
+*******************************************************************************/
+void tuner_sample_log_record(void)
+{
+    const cy_stc_capsense_sensor_context_t *sns = NULL;
+    uint8_t *record = NULL;
+    uint16_t value = 0;
+    uint16_t idx = 0;
+    uint8_t field = 0;
+    uint16_t seq = sample_seq;
+    bool active = false;
+
+    if(sample_fields == 0u)
+    {
+        return;
+    }
+
+    for(uint8_t i = 0; i < TUNER_MAX_SESSIONS; i++)
+    {
+        active = active || sample_readers[i].active;
+    }
+
+    if(active == false)
+    {
+        return;
+    }
+
+    sample_seq++;
+
+    if((sample_write_count - sample_log_oldest()) >= sample_depth)
+    {
+        return;
+    }
+
+    record = &sample_log[(sample_write_count % sample_depth) *\
+                         sample_record_size];
+    record[idx++] = (uint8_t)(seq & LSB_MASK);
+    record[idx++] = (uint8_t)(seq >> BYTE_SHIFT);
+
+    for(uint8_t i = 0; i < sample_count; i++)
+    {
+        sns = &cy_capsense_tuner.sensorContext[sample_first + i];
+
+        for(field = SAMPLE_FIELD_RAW; field <= SAMPLE_FIELD_BSLN; field <<= 1u)
+        {
+            if((sample_fields & field) == 0u)
+            {
+                continue;
+            }
+
+            value = (field == SAMPLE_FIELD_RAW) ? sns->raw :
+                    (field == SAMPLE_FIELD_DIFF) ? sns->diff : sns->bsln;
+            record[idx++] = (uint8_t)(value & LSB_MASK);
+            record[idx++] = (uint8_t)(value >> BYTE_SHIFT);
+        }
+    }
+
+    sample_write_count++;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_sample_log_build
+********************************************************************************
+*
+* Summary:
+*   Builds the next sample packet of a GATT client: a 4-byte header (field
+*   mask, first sensor, number of sensors, number of records) followed by
+*   as many whole records as fit, back to back. The records stay in the log
+*   until tuner_sample_log_sent() is called, so a packet the BLE stack did
+*   not accept is built again on the next call. A client whose packets
+*   cannot carry one record, e.g. one that subscribed with a smaller MTU
+*   after the selection was made, is skipped: its records are released so
+*   that it does not hold up the log for the other clients.
+*
+* Parameters:
+*  uint8_t session  : Session index
+*  uint8_t *buffer  : Buffer of at least max_len bytes
+*  uint16_t max_len : Largest packet the connection carries
+*
+* Return:
+*   Length of the packet, 0 if there is nothing to send
+*
+*******************************************************************************/
+uint16_t tuner_sample_log_build(uint8_t session, uint8_t *buffer,
+                                uint16_t max_len)
+{
+    sample_reader_t *reader = &sample_readers[session];
+    uint32_t available = 0;
+    uint32_t fit = 0;
+    uint32_t slot = 0;
+    uint16_t len = SAMPLE_PKT_HDR_SIZE;
+
+    reader->pending = 0;
+
+    if((reader->active == false) || (sample_fields == 0u))
+    {
+        return 0u;
+    }
+
+    if(max_len < (SAMPLE_PKT_HDR_SIZE + sample_record_size))
+    {
+        reader->read_count = sample_write_count;
+        return 0u;
+    }
+
+    available = sample_write_count - reader->read_count;
+    fit = (uint32_t)(max_len - SAMPLE_PKT_HDR_SIZE) / sample_record_size;
+    if(fit > SAMPLE_PKT_MAX_RECORDS)
+    {
+        fit = SAMPLE_PKT_MAX_RECORDS;
+    }
+    if(available > fit)
+    {
+        available = fit;
+    }
+
+    if(available == 0u)
+    {
+        return 0u;
+    }
+
+    buffer[SAMPLE_PKT_FIELDS_IDX] = sample_fields;
+    buffer[SAMPLE_PKT_FIRST_IDX] = sample_first;
+    buffer[SAMPLE_PKT_COUNT_IDX] = sample_count;
+    buffer[SAMPLE_PKT_RECORDS_IDX] = (uint8_t)available;
+
+    for(uint32_t i = 0; i < available; i++)
+    {
+        slot = (reader->read_count + i) % sample_depth;
+        memcpy(&buffer[len], &sample_log[slot * sample_record_size],
+               sample_record_size);
+        len += sample_record_size;
+    }
+
+    reader->pending = (uint8_t)available;
+
+    return len;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_sample_log_sent
+********************************************************************************
+*
+* Summary:
+*   Called once the BLE stack accepted the packet last built for a GATT
+*   client; frees its records for that client.
+*
+* Parameters:
+*  uint8_t session : Session index
+*
+*******************************************************************************/
+void tuner_sample_log_sent(uint8_t session)
+{
+    sample_readers[session].read_count += sample_readers[session].pending;
+    sample_readers[session].pending = 0;
+}
+
+
+/*******************************************************************************
+* Function Name: sample_log_oldest
+********************************************************************************
+*
+* Summary:
+*   Returns the number of the oldest record still needed by a GATT client,
+*   which bounds the free room in the log.
+*
+*******************************************************************************/
+static uint32_t sample_log_oldest(void)
+{
+    uint32_t oldest = sample_write_count;
+
+    for(uint8_t i = 0; i < TUNER_MAX_SESSIONS; i++)
+    {
+        if((sample_readers[i].active == true) &&\
+           ((sample_write_count - sample_readers[i].read_count) >
+            (sample_write_count - oldest)))
+        {
+            oldest = sample_readers[i].read_count;
+        }
+    }
+
+    return oldest;
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,76 @@
+/******************************************************************************
+* File Name: tuner_sample_log.h
+*
+* Description: This file is public interface of tuner_sample_log.c
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include guard
+ *****************************************************************************/
+#ifndef TUNER_SAMPLE_LOG_H_
+#define TUNER_SAMPLE_LOG_H_
+
+/******************************************************************************
+ * Include header files
+ *****************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+/* Length of the Tuner_Samples characteristic in the GATT database; upper
+ * limit of the sample packet size */
+#define TUNER_SAMPLE_PKT_MAX_SIZE    (492u)
+
+
+/******************************************************************************
+ * Function Prototypes
+ *****************************************************************************/
+bool tuner_sample_log_configure(const uint8_t *data, uint16_t len,
+                                uint16_t max_len);
+void tuner_sample_log_subscribe(uint8_t session);
+void tuner_sample_log_unsubscribe(uint8_t session);
+void tuner_sample_log_record(void);
+uint16_t tuner_sample_log_build(uint8_t session, uint8_t *buffer,
+                                uint16_t max_len);
+void tuner_sample_log_sent(uint8_t session);
+
+
+#endif /* TUNER_SAMPLE_LOG_H_ */
@@ -0,0 +1,353 @@
+/******************************************************************************
+* File Name: tuner_snr.c
+*
+* Description: This file contains the on-device noise and signal statistics.
+*              Over a number of scans chosen by the GATT client, it keeps the
+*              minimum, maximum, mean and variance of the raw count of every
+*              sensor, either while the sensor is not touched or while it is.
+*              Only running sums are kept, so no sample is stored and only the
+*              results are sent.
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <string.h>
+#include "cycfg_capsense.h"
+#include "tuner_snr.h"
+
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#if (TUNER_SNR_VALUE_SIZE > TUNER_SNR_VALUE_MAX_SIZE)
+#error "Sensor_Stats is too short for the sensors of this configuration"
+#endif
+
+/* Sensor_Stats write starting a run:
+ * Phase, TUNER_SNR_PHASE_* (1 byte)
+ * Number of scans (2 bytes, LSB first), at least 1 */
+#define SNR_START_SIZE               (3u)
+#define SNR_START_PHASE_IDX          (0u)
+#define SNR_START_SCANS_LSB_IDX      (1u)
+#define SNR_START_SCANS_MSB_IDX      (2u)
+
+#define SNR_HDR_PHASE_IDX            (0u)
+#define SNR_HDR_STATE_IDX            (1u)
+#define SNR_HDR_SCANS_LSB_IDX        (2u)
+#define SNR_HDR_SCANS_MSB_IDX        (3u)
+#define SNR_HDR_DONE_IDX             (4u)
+
+#define SNR_REC_COUNT_IDX            (0u)
+#define SNR_REC_MIN_IDX              (2u)
+#define SNR_REC_MAX_IDX              (4u)
+#define SNR_REC_MEAN_IDX             (6u)
+#define SNR_REC_VARIANCE_IDX         (10u)
+
+/* Fractional bits of the mean and the variance */
+#define SNR_FRAC_BITS                (8u)
+#define BYTE_SHIFT                   (8u)
+#define LSB_MASK                     (0x00FFu)
+
+
+/*******************************************************************************
+ * Data Types
+ ******************************************************************************/
+/* Running sums of one sensor. A raw count fits 16 bits and a run is at most
+ * 65535 scans, so the sum fits 32 bits and the sum of squares 48 bits */
+typedef struct
+{
+    uint16_t count;
+    uint16_t min;
+    uint16_t max;
+    uint32_t sum;
+    uint64_t sum_sq;
+} snr_acc_t;
+
+
+/*******************************************************************************
+ * Global variables
+ ******************************************************************************/
+/* Running sums of each phase. A run only clears the sums of its own phase,
+ * so the untouched results survive the touched run that follows */
+static snr_acc_t snr_acc[TUNER_SNR_PHASE_COUNT][CY_CAPSENSE_SENSOR_COUNT];
+
+/* Run in progress or last run */
+static uint8_t snr_phase = TUNER_SNR_PHASE_UNTOUCHED;
+static uint8_t snr_state = TUNER_SNR_STATE_IDLE;
+static uint16_t snr_scans = 0;
+static uint16_t snr_scans_done = 0;
+
+/* TUNER_SNR_DONE_* of the phases whose last run finished */
+static uint8_t snr_done = 0;
+
+static const uint8_t snr_done_mask[TUNER_SNR_PHASE_COUNT] =
+{
+    TUNER_SNR_DONE_UNTOUCHED,
+    TUNER_SNR_DONE_TOUCHED
+};
+
+/* Set when a run finishes, until the results are taken */
+static bool snr_finished = false;
+
+
+/*******************************************************************************
+ * Function Prototypes
+*******************************************************************************/
+static void snr_put_u16(uint8_t *buffer, uint16_t value);
+static void snr_put_u32(uint8_t *buffer, uint32_t value);
+
+
+/*******************************************************************************
+* Function Name: tuner_snr_start
+********************************************************************************
+*
+* Summary:
+*   Starts a run written to the Sensor_Stats characteristic. The results
+*   of the phase are cleared; those of the other phase are kept, unless
+*   its run was still in progress, which is dropped.
+*
+* Parameters:
+*  const uint8_t *data : Written value, phase and number of scans
+*  uint16_t len        : Length of the written value
+*
+* Return:
+*   true if the run was started
+*
+*******************************************************************************/
+bool tuner_snr_start(const uint8_t *data, uint16_t len)
+{
+    uint16_t scans = 0;
+    uint8_t phase = 0;
+
+    if(len != SNR_START_SIZE)
+    {
+        return false;
+    }
+
+    scans = (uint16_t)data[SNR_START_SCANS_LSB_IDX] |\
+            ((uint16_t)data[SNR_START_SCANS_MSB_IDX] << BYTE_SHIFT);
+
+    phase = data[SNR_START_PHASE_IDX];
+
+    if((phase >= TUNER_SNR_PHASE_COUNT) || (scans == 0u))
+    {
+        return false;
+    }
+
+    if(snr_state == TUNER_SNR_STATE_RUNNING)
+    {
+        memset(snr_acc[snr_phase], 0, sizeof(snr_acc[snr_phase]));
+    }
+
+    memset(snr_acc[phase], 0, sizeof(snr_acc[phase]));
+    snr_done &= (uint8_t)~snr_done_mask[phase];
+    snr_phase = phase;
+    snr_scans = scans;
+    snr_scans_done = 0;
+    snr_state = TUNER_SNR_STATE_RUNNING;
+    snr_finished = false;
+
+    return true;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_snr_update
+********************************************************************************
+*
+* Summary:
+*   Adds the raw counts of the scan just processed to the running sums.
+*   A sensor only counts in the scans where its status matches the phase:
+*   not active for the untouched phase, active for the touched one. Called
+*   once every widget is processed.
+*
+*******************************************************************************/
+void tuner_snr_update(void)
+{
+    const cy_stc_capsense_sensor_context_t *sns = cy_capsense_tuner.sensorContext;
+    snr_acc_t *acc = NULL;
+    bool active = false;
+
+    if(snr_state != TUNER_SNR_STATE_RUNNING)
+    {
+        return;
+    }
+
+    for(uint32_t i = 0; i < CY_CAPSENSE_SENSOR_COUNT; i++)
+    {
+        active = (sns[i].status != 0u);
+        if(active != (snr_phase == TUNER_SNR_PHASE_TOUCHED))
+        {
+            continue;
+        }
+
+        acc = &snr_acc[snr_phase][i];
+        if((acc->count == 0u) || (sns[i].raw < acc->min))
+        {
+            acc->min = sns[i].raw;
+        }
+        if((acc->count == 0u) || (sns[i].raw > acc->max))
+        {
+            acc->max = sns[i].raw;
+        }
+        acc->count++;
+        acc->sum += sns[i].raw;
+        acc->sum_sq += (uint64_t)sns[i].raw * sns[i].raw;
+    }
+
+    snr_scans_done++;
+    if(snr_scans_done == snr_scans)
+    {
+        snr_state = TUNER_SNR_STATE_DONE;
+        snr_done |= snr_done_mask[snr_phase];
+        snr_finished = true;
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_snr_finished
+********************************************************************************
+*
+* Summary:
+*   Returns true once after a run finishes, so the results are sent only
+*   once.
+*
+*******************************************************************************/
+bool tuner_snr_finished(void)
+{
+    bool finished = snr_finished;
+
+    snr_finished = false;
+
+    return finished;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_snr_build
+********************************************************************************
+*
+* Summary:
+*   Builds the Sensor_Stats value from the running sums of both phases.
+*   The mean and the population variance are computed from the sums only
+*   here, with integer arithmetic; a sensor that was never counted in a
+*   phase reports zeros for it.
+*
+* Parameters:
+*  uint8_t *buffer : Buffer of TUNER_SNR_VALUE_SIZE bytes
+*
+* Return:
+*   Length of the value
+*
+*******************************************************************************/
+uint16_t tuner_snr_build(uint8_t *buffer)
+{
+    uint8_t *record = &buffer[TUNER_SNR_HDR_SIZE];
+    const snr_acc_t *acc = NULL;
+    uint64_t mean = 0;
+    uint64_t m2 = 0;
+    uint64_t variance = 0;
+
+    buffer[SNR_HDR_PHASE_IDX] = snr_phase;
+    buffer[SNR_HDR_STATE_IDX] = snr_state;
+    snr_put_u16(&buffer[SNR_HDR_SCANS_LSB_IDX], snr_scans_done);
+    buffer[SNR_HDR_DONE_IDX] = snr_done;
+
+    for(uint32_t i = 0; i < (TUNER_SNR_PHASE_COUNT * CY_CAPSENSE_SENSOR_COUNT); i++)
+    {
+        acc = &snr_acc[i / CY_CAPSENSE_SENSOR_COUNT][i % CY_CAPSENSE_SENSOR_COUNT];
+        mean = 0;
+        variance = 0;
+
+        if(acc->count > 0u)
+        {
+            mean = ((uint64_t)acc->sum << SNR_FRAC_BITS) / acc->count;
+
+            /* Sum of the squared deviations from the mean */
+            m2 = acc->sum_sq - (((uint64_t)acc->sum * acc->sum) / acc->count);
+            variance = (m2 << SNR_FRAC_BITS) / acc->count;
+            if(variance > UINT32_MAX)
+            {
+                variance = UINT32_MAX;
+            }
+        }
+
+        snr_put_u16(&record[SNR_REC_COUNT_IDX], acc->count);
+        snr_put_u16(&record[SNR_REC_MIN_IDX], acc->min);
+        snr_put_u16(&record[SNR_REC_MAX_IDX], acc->max);
+        snr_put_u32(&record[SNR_REC_MEAN_IDX], (uint32_t)mean);
+        snr_put_u32(&record[SNR_REC_VARIANCE_IDX], (uint32_t)variance);
+        record += TUNER_SNR_RECORD_SIZE;
+    }
+
+    return TUNER_SNR_VALUE_SIZE;
+}
+
+
+/*******************************************************************************
+* Function Name: snr_put_u16
+********************************************************************************
+*
+* Summary:
+*   Stores a 16-bit value LSB first.
+*
+*******************************************************************************/
+static void snr_put_u16(uint8_t *buffer, uint16_t value)
+{
+    buffer[0] = (uint8_t)(value & LSB_MASK);
+    buffer[1] = (uint8_t)(value >> BYTE_SHIFT);
+}
+
+
+/*******************************************************************************
+* Function Name: snr_put_u32
+********************************************************************************
+*
+* Summary:
+*   Stores a 32-bit value LSB first.
+*
+*******************************************************************************/
+static void snr_put_u32(uint8_t *buffer, uint32_t value)
+{
+    snr_put_u16(&buffer[0], (uint16_t)(value & 0xFFFFu));
+    snr_put_u16(&buffer[2], (uint16_t)(value >> 16u));
+}
+
+
+/* [] END OF FILE */
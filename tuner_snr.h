@@ -0,0 +1,99 @@
+/******************************************************************************
+* File Name: tuner_snr.h
+*
+* Description: This file is public interface of tuner_snr.c
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include guard
+ *****************************************************************************/
+#ifndef TUNER_SNR_H_
+#define TUNER_SNR_H_
+
+/******************************************************************************
+ * Include header files
+ *****************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "cycfg_capsense.h"
+
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+/* Sensor_Stats value: header, then one record per sensor for the untouched
+ * phase, then one record per sensor for the touched phase, all LSB first.
+ * Header: phase (1 byte), TUNER_SNR_STATE_* (1 byte) and scans done
+ * (2 bytes) of the last run started, TUNER_SNR_DONE_* of the phases whose
+ * last run finished (1 byte)
+ * Record: scans counted in the phase (2 bytes), minimum (2 bytes),
+ * maximum (2 bytes), mean (4 bytes) and variance (4 bytes) of the raw
+ * count. Mean and variance have 8 fractional bits */
+#define TUNER_SNR_HDR_SIZE           (5u)
+#define TUNER_SNR_RECORD_SIZE        (14u)
+#define TUNER_SNR_VALUE_SIZE         (TUNER_SNR_HDR_SIZE +\
+                                      (TUNER_SNR_PHASE_COUNT *\
+                                       CY_CAPSENSE_SENSOR_COUNT *\
+                                       TUNER_SNR_RECORD_SIZE))
+
+/* Length of the Sensor_Stats characteristic in the GATT database */
+#define TUNER_SNR_VALUE_MAX_SIZE     (512u)
+
+#define TUNER_SNR_PHASE_UNTOUCHED    (0u)
+#define TUNER_SNR_PHASE_TOUCHED      (1u)
+#define TUNER_SNR_PHASE_COUNT        (2u)
+
+/* Phases done; with both, the value holds the noise and the signal */
+#define TUNER_SNR_DONE_UNTOUCHED     (0x01u)
+#define TUNER_SNR_DONE_TOUCHED       (0x02u)
+
+#define TUNER_SNR_STATE_IDLE         (0u)
+#define TUNER_SNR_STATE_RUNNING      (1u)
+#define TUNER_SNR_STATE_DONE         (2u)
+
+
+/******************************************************************************
+ * Function Prototypes
+ *****************************************************************************/
+bool tuner_snr_start(const uint8_t *data, uint16_t len);
+void tuner_snr_update(void);
+bool tuner_snr_finished(void);
+uint16_t tuner_snr_build(uint8_t *buffer);
+
+
+#endif /* TUNER_SNR_H_ */
@@ -0,0 +1,169 @@
+/******************************************************************************
+* File Name: tuner_summary.c
+*
+* Description: This file contains the summary image of the CapSense results.
+*              After every complete scan, it packs the difference count, a
+*              noise estimate and the status of each sensor, and the status of
+*              each widget, into a few bytes that can be streamed instead of
+*              the whole tuner structure.
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <stdbool.h>
+#include "cycfg_capsense.h"
+#include "tuner_summary.h"
+
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define SUMMARY_SNS_DIFF_LSB_IDX     (0u)
+#define SUMMARY_SNS_DIFF_MSB_IDX     (1u)
+#define SUMMARY_SNS_NOISE_LSB_IDX    (2u)
+#define SUMMARY_SNS_NOISE_MSB_IDX    (3u)
+#define SUMMARY_SNS_STATUS_IDX       (4u)
+#define BYTE_SHIFT                   (8u)
+#define LSB_MASK                     (0x00FFu)
+
+/* The noise estimate is the mean change of the raw count from one scan to
+ * the next while the sensor is not active, averaged over about
+ * 2^SUMMARY_NOISE_SHIFT scans. It is kept with SUMMARY_NOISE_FRAC_BITS
+ * fractional bits; larger changes are clipped so that it fits 2 bytes */
+#define SUMMARY_NOISE_SHIFT          (3u)
+#define SUMMARY_NOISE_FRAC_BITS      (4u)
+#define SUMMARY_NOISE_MAX_STEP       (0x0FFFu)
+
+
+/*******************************************************************************
+ * Global variables
+ ******************************************************************************/
+static uint8_t summary_image[TUNER_SUMMARY_SIZE];
+
+/* Raw counts of the previous scan and the noise estimates */
+static uint16_t summary_prev_raw[CY_CAPSENSE_SENSOR_COUNT];
+static uint16_t summary_noise[CY_CAPSENSE_SENSOR_COUNT];
+static bool summary_prev_valid = false;
+
+
+/*******************************************************************************
+* Function Name: tuner_summary_update
+********************************************************************************
+*
+* Summary:
+*   Updates the noise estimates and packs the summary image from the results
+*   of the scan just processed. Called once every widget is processed and
+*   before the tuner takes its snapshot.
+*
+*******************************************************************************/
+void tuner_summary_update(void)
+{
+    const cy_stc_capsense_sensor_context_t *sns = cy_capsense_tuner.sensorContext;
+    uint8_t *record = summary_image;
+    uint32_t step = 0;
+    int32_t noise = 0;
+
+    for(uint32_t wd = 0; wd < CY_CAPSENSE_WIDGET_COUNT; wd++)
+    {
+        *record = cy_capsense_tuner.widgetContext[wd].status;
+        record += TUNER_SUMMARY_WD_RECORD_SIZE;
+    }
+
+    for(uint32_t i = 0; i < CY_CAPSENSE_SENSOR_COUNT; i++)
+    {
+        /* A touch moves the raw count on purpose; keep the estimate */
+        if((summary_prev_valid == true) && (sns[i].status == 0u))
+        {
+            step = (sns[i].raw > summary_prev_raw[i]) ?\
+                   (uint32_t)(sns[i].raw - summary_prev_raw[i]) :\
+                   (uint32_t)(summary_prev_raw[i] - sns[i].raw);
+            if(step > SUMMARY_NOISE_MAX_STEP)
+            {
+                step = SUMMARY_NOISE_MAX_STEP;
+            }
+
+            noise = (int32_t)summary_noise[i];
+            noise += ((int32_t)(step << SUMMARY_NOISE_FRAC_BITS) - noise) >>\
+                     SUMMARY_NOISE_SHIFT;
+            summary_noise[i] = (uint16_t)noise;
+        }
+        summary_prev_raw[i] = sns[i].raw;
+
+        record[SUMMARY_SNS_DIFF_LSB_IDX] = (uint8_t)(sns[i].diff & LSB_MASK);
+        record[SUMMARY_SNS_DIFF_MSB_IDX] = (uint8_t)(sns[i].diff >> BYTE_SHIFT);
+        record[SUMMARY_SNS_NOISE_LSB_IDX] = (uint8_t)(summary_noise[i] & LSB_MASK);
+        record[SUMMARY_SNS_NOISE_MSB_IDX] = (uint8_t)(summary_noise[i] >> BYTE_SHIFT);
+        record[SUMMARY_SNS_STATUS_IDX] = sns[i].status;
+        record += TUNER_SUMMARY_SNS_RECORD_SIZE;
+    }
+
+    summary_prev_valid = true;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_summary_restart
+********************************************************************************
+*
+* Summary:
+*   Called instead of tuner_summary_update() for a scan that is not
+*   summarized. The next update does not take the step from the raw counts
+*   of an older scan as noise.
+*
+*******************************************************************************/
+void tuner_summary_restart(void)
+{
+    summary_prev_valid = false;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_summary_image
+********************************************************************************
+*
+* Summary:
+*   Returns the summary image of the last scan, TUNER_SUMMARY_SIZE bytes.
+*
+*******************************************************************************/
+const uint8_t *tuner_summary_image(void)
+{
+    return summary_image;
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,79 @@
+/******************************************************************************
+* File Name: tuner_summary.h
+*
+* Description: This file is public interface of tuner_summary.c
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include guard
+ *****************************************************************************/
+#ifndef TUNER_SUMMARY_H_
+#define TUNER_SUMMARY_H_
+
+/******************************************************************************
+ * Include header files
+ *****************************************************************************/
+#include <stdint.h>
+#include "cycfg_capsense.h"
+
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+/* Summary image: one record per widget followed by one record per sensor,
+ * both in the order of cy_capsense_tuner.
+ * Widget record: status (1 byte)
+ * Sensor record: difference count (2 bytes), noise estimate (2 bytes) and
+ * status (1 byte), all LSB first. The noise estimate is in 1/16 counts */
+#define TUNER_SUMMARY_WD_RECORD_SIZE     (1u)
+#define TUNER_SUMMARY_SNS_RECORD_SIZE    (5u)
+#define TUNER_SUMMARY_SIZE               ((CY_CAPSENSE_WIDGET_COUNT *\
+                                           TUNER_SUMMARY_WD_RECORD_SIZE) +\
+                                          (CY_CAPSENSE_SENSOR_COUNT *\
+                                           TUNER_SUMMARY_SNS_RECORD_SIZE))
+
+
+/******************************************************************************
+ * Function Prototypes
+ *****************************************************************************/
+void tuner_summary_update(void);
+void tuner_summary_restart(void);
+const uint8_t *tuner_summary_image(void);
+
+
+#endif /* TUNER_SUMMARY_H_ */
@@ -0,0 +1,133 @@
+/******************************************************************************
+* File Name: tuner_time.c
+*
+* Description: This file contains the microsecond time base of the application.
+*              Unlike the CPU cycle counter, it keeps counting while the CPU
+*              sleeps.
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include "cyhal.h"
+#include "tuner_time.h"
+
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define TUNER_TIME_FREQUENCY_HZ      (1000000u)
+#define TUNER_TIME_PERIOD            (0xFFFFFFFFu)
+
+
+/*******************************************************************************
+ * Global variables
+ ******************************************************************************/
+/* Free running TCPWM counter. The TCPWM keeps its clock in CPU Sleep, so
+ * the time base also covers the time the main loop spends sleeping, which
+ * the DWT cycle counter does not */
+static cyhal_timer_t tuner_timer;
+
+
+/*******************************************************************************
+* Function Name: tuner_time_init
+********************************************************************************
+* Summary:
+*  Starts the time base. The counter runs up at 1 MHz over the full 32-bit
+*  range, so the differences of two readings are correct across the
+*  wrap-around as long as they are less than about 71 minutes apart.
+*
+*******************************************************************************/
+void tuner_time_init(void)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    const cyhal_timer_cfg_t timer_cfg =
+    {
+        .compare_value = 0u,
+        .period = TUNER_TIME_PERIOD,
+        .direction = CYHAL_TIMER_DIR_UP,
+        .is_compare = false,
+        .is_continuous = true,
+        .value = 0u
+    };
+
+    /* The first free counter of the device is a 32-bit one */
+    result = cyhal_timer_init(&tuner_timer, NC, NULL);
+
+    if(CY_RSLT_SUCCESS == result)
+    {
+        result = cyhal_timer_configure(&tuner_timer, &timer_cfg);
+    }
+
+    if(CY_RSLT_SUCCESS == result)
+    {
+        result = cyhal_timer_set_frequency(&tuner_timer,
+                                           TUNER_TIME_FREQUENCY_HZ);
+    }
+
+    if(CY_RSLT_SUCCESS == result)
+    {
+        result = cyhal_timer_start(&tuner_timer);
+    }
+
+    /* Halt the CPU if the time base could not be started */
+    CY_ASSERT(result == CY_RSLT_SUCCESS);
+
+    /* To avoid compiler warning*/
+    (void) result;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_time_us
+********************************************************************************
+* Summary:
+*  Returns the current value of the time base.
+*
+* Return:
+*  uint32_t : Microseconds since tuner_time_init(), modulo 2^32
+*
+*******************************************************************************/
+uint32_t tuner_time_us(void)
+{
+    return cyhal_timer_read(&tuner_timer);
+}
+
+
+/* [] END OF FILE */
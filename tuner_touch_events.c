@@ -0,0 +1,331 @@
+/******************************************************************************
+* File Name: tuner_touch_events.c
+*
+* Description: This file contains the touch events: a change of the status of a
+*              widget is queued as soon as the widget is processed and is sent
+*              to the GATT clients ahead of the bulk tuner data, so it does not
+*              wait for a frame or for the sample log.
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include "cycfg_capsense.h"
+#include "tuner_touch_events.h"
+#include "tuner_transport.h"
+#include "tuner_time.h"
+
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Events kept for the GATT clients; a client that falls further behind
+ * loses the oldest ones, which shows as a gap in the sequence numbers */
+#define TOUCH_EVENT_QUEUE_LENGTH     (32u)
+
+/* Event record, all LSB first:
+ * Sequence number (2 bytes)
+ * Widget index (1 byte)
+ * New widget status (1 byte)
+ * Time from the processing of the widget to the hand-off of the packet to
+ * the BLE stack in microseconds, TOUCH_EVENT_DELAY_MAX if longer (2 bytes) */
+#define TOUCH_EVENT_RECORD_SIZE      (6u)
+#define TOUCH_EVENT_SEQ_LSB_IDX      (0u)
+#define TOUCH_EVENT_SEQ_MSB_IDX      (1u)
+#define TOUCH_EVENT_WIDGET_IDX       (2u)
+#define TOUCH_EVENT_STATUS_IDX       (3u)
+#define TOUCH_EVENT_DELAY_LSB_IDX    (4u)
+#define TOUCH_EVENT_DELAY_MSB_IDX    (5u)
+#define TOUCH_EVENT_DELAY_MAX        (0xFFFFu)
+#define BYTE_SHIFT                   (8u)
+#define LSB_MASK                     (0x00FFu)
+
+
+/*******************************************************************************
+ * Data Types
+ ******************************************************************************/
+/* Queued status change */
+typedef struct
+{
+    uint32_t time;              /* Time base value when it was queued */
+    uint16_t seq;
+    uint8_t widget;
+    uint8_t status;
+} touch_event_t;
+
+
+/* Read position of one GATT client */
+typedef struct
+{
+    bool active;                /* Touch_Events notifications enabled */
+    uint32_t read_count;        /* Events sent to the client */
+    uint8_t pending;            /* Events in the packet last built */
+} touch_reader_t;
+
+
+/*******************************************************************************
+ * Global variables
+ ******************************************************************************/
+static touch_event_t touch_events[TOUCH_EVENT_QUEUE_LENGTH];
+static touch_reader_t touch_readers[TUNER_MAX_SESSIONS];
+
+/* Events queued since power-up */
+static uint32_t touch_write_count = 0;
+
+/* Widget status of the last event of each widget */
+static uint8_t touch_status[CY_CAPSENSE_WIDGET_COUNT];
+
+/* Longest time an event waited for the BLE stack since the last call of
+ * tuner_touch_events_latency_max() */
+static uint32_t touch_latency_max = 0;
+
+
+/*******************************************************************************
+* Function Name: tuner_touch_events_subscribe
+********************************************************************************
+*
+* Summary:
+*   Starts sending the events to a GATT client that enabled the Touch_Events
+*   notifications. The client starts with the next event.
+*
+* Parameters:
+*  uint8_t session : Session index
+*
+*******************************************************************************/
+void tuner_touch_events_subscribe(uint8_t session)
+{
+    touch_readers[session].active = true;
+    touch_readers[session].read_count = touch_write_count;
+    touch_readers[session].pending = 0;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_touch_events_unsubscribe
+********************************************************************************
+*
+* Summary:
+*   Stops sending the events to a GATT client.
+*
+* Parameters:
+*  uint8_t session : Session index
+*
+*******************************************************************************/
+void tuner_touch_events_unsubscribe(uint8_t session)
+{
+    touch_readers[session].active = false;
+    touch_readers[session].pending = 0;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_touch_events_update
+********************************************************************************
+*
+* Summary:
+*   Queues an event if the status of a widget changed. Called right after
+*   the widget is processed, before the other widgets of the frame.
+*
+* Parameters:
+*  uint32_t widget : Index of the widget just processed
+*
+* Return:
+*   true if an event was queued
+*
+*******************************************************************************/
+bool tuner_touch_events_update(uint32_t widget)
+{
+    uint8_t status = cy_capsense_tuner.widgetContext[widget].status;
+    touch_event_t *event = NULL;
+
+    if(status == touch_status[widget])
+    {
+        return false;
+    }
+
+    touch_status[widget] = status;
+
+    event = &touch_events[touch_write_count % TOUCH_EVENT_QUEUE_LENGTH];
+    event->time = tuner_time_us();
+    event->seq = (uint16_t)touch_write_count;
+    event->widget = (uint8_t)widget;
+    event->status = status;
+    touch_write_count++;
+
+    return true;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_touch_events_pending
+********************************************************************************
+*
+* Summary:
+*   Returns true if a GATT client has events that were not sent yet.
+*
+* Parameters:
+*  uint8_t session : Session index
+*
+*******************************************************************************/
+bool tuner_touch_events_pending(uint8_t session)
+{
+    return ((touch_readers[session].active == true) &&\
+            (touch_readers[session].read_count != touch_write_count));
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_touch_events_build
+********************************************************************************
+*
+* Summary:
+*   Builds the next event packet of a GATT client from its oldest unsent
+*   events, as many as fit in max_len bytes. Each record carries the time the
+*   event has waited so far; the packet is built right before it is handed
+*   to the BLE stack. The events stay queued until
+*   tuner_touch_events_sent() is called.
+*
+* Parameters:
+*  uint8_t session : Session index
+*  uint8_t *buffer : Buffer of at least max_len bytes
+*  uint16_t max_len: Largest packet the connection carries
+*
+* Return:
+*   Length of the packet, 0 if there is nothing to send
+*
+*******************************************************************************/
+uint16_t tuner_touch_events_build(uint8_t session, uint8_t *buffer,
+                                  uint16_t max_len)
+{
+    touch_reader_t *reader = &touch_readers[session];
+    const touch_event_t *event = NULL;
+    uint32_t now = tuner_time_us();
+    uint32_t available = 0;
+    uint32_t delay = 0;
+    uint16_t len = 0;
+
+    reader->pending = 0;
+
+    if(reader->active == false)
+    {
+        return 0u;
+    }
+
+    /* Drop what the queue no longer holds */
+    if((touch_write_count - reader->read_count) > TOUCH_EVENT_QUEUE_LENGTH)
+    {
+        reader->read_count = touch_write_count - TOUCH_EVENT_QUEUE_LENGTH;
+    }
+
+    available = touch_write_count - reader->read_count;
+    if(available > (uint32_t)(max_len / TOUCH_EVENT_RECORD_SIZE))
+    {
+        available = max_len / TOUCH_EVENT_RECORD_SIZE;
+    }
+
+    for(uint32_t i = 0; i < available; i++)
+    {
+        event = &touch_events[(reader->read_count + i) % TOUCH_EVENT_QUEUE_LENGTH];
+
+        delay = now - event->time;
+        if(delay > touch_latency_max)
+        {
+            touch_latency_max = delay;
+        }
+        if(delay > TOUCH_EVENT_DELAY_MAX)
+        {
+            delay = TOUCH_EVENT_DELAY_MAX;
+        }
+
+        buffer[len + TOUCH_EVENT_SEQ_LSB_IDX] = (uint8_t)(event->seq & LSB_MASK);
+        buffer[len + TOUCH_EVENT_SEQ_MSB_IDX] = (uint8_t)(event->seq >> BYTE_SHIFT);
+        buffer[len + TOUCH_EVENT_WIDGET_IDX] = event->widget;
+        buffer[len + TOUCH_EVENT_STATUS_IDX] = event->status;
+        buffer[len + TOUCH_EVENT_DELAY_LSB_IDX] = (uint8_t)(delay & LSB_MASK);
+        buffer[len + TOUCH_EVENT_DELAY_MSB_IDX] = (uint8_t)(delay >> BYTE_SHIFT);
+        len += TOUCH_EVENT_RECORD_SIZE;
+    }
+
+    reader->pending = (uint8_t)available;
+
+    return len;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_touch_events_sent
+********************************************************************************
+*
+* Summary:
+*   Called once the packet last built for a GATT client is accepted by the
+*   BLE stack; its events are released for that client.
+*
+* Parameters:
+*  uint8_t session : Session index
+*
+*******************************************************************************/
+void tuner_touch_events_sent(uint8_t session)
+{
+    touch_readers[session].read_count += touch_readers[session].pending;
+    touch_readers[session].pending = 0;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_touch_events_latency_max
+********************************************************************************
+*
+* Summary:
+*   Returns the longest time an event waited between the processing of its
+*   widget and the hand-off of its packet to the BLE stack since the last
+*   call, and starts a new measurement.
+*
+* Return:
+*   Latency in microseconds
+*
+*******************************************************************************/
+uint32_t tuner_touch_events_latency_max(void)
+{
+    uint32_t latency = touch_latency_max;
+
+    touch_latency_max = 0;
+
+    return latency;
+}
+
+
+/* [] END OF FILE */
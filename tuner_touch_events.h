@@ -0,0 +1,76 @@
+/******************************************************************************
+* File Name: tuner_touch_events.h
+*
+* Description: This file is public interface of tuner_touch_events.c
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include guard
+ *****************************************************************************/
+#ifndef TUNER_TOUCH_EVENTS_H_
+#define TUNER_TOUCH_EVENTS_H_
+
+/******************************************************************************
+ * Include header files
+ *****************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+/* Length of the Touch_Events characteristic in the GATT database; upper
+ * limit of the event packet size */
+#define TUNER_TOUCH_EVENT_PKT_MAX_SIZE   (244u)
+
+
+/******************************************************************************
+ * Function Prototypes
+ *****************************************************************************/
+void tuner_touch_events_subscribe(uint8_t session);
+void tuner_touch_events_unsubscribe(uint8_t session);
+bool tuner_touch_events_update(uint32_t widget);
+bool tuner_touch_events_pending(uint8_t session);
+uint16_t tuner_touch_events_build(uint8_t session, uint8_t *buffer,
+                                  uint16_t max_len);
+void tuner_touch_events_sent(uint8_t session);
+uint32_t tuner_touch_events_latency_max(void);
+
+
+#endif /* TUNER_TOUCH_EVENTS_H_ */
@@ -0,0 +1,1850 @@
+/******************************************************************************
+* File Name: tuner_transport.c
+*
+* Description: This file contains the tuner frame transport: change detection,
+*              encoding and packetization of the CapSense data structure, and
+*              the handling of Tuner commands. It does not call the BLE stack,
+*              so it can also be built for a host.
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <string.h>
+#include <stdio.h>
+#include "cycfg_capsense.h"
+#include "tuner_transport.h"
+#include "tuner_layout.h"
+#include "tuner_cmd_queue.h"
+#include "tuner_summary.h"
+
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define ENABLE                       (1u)
+#define DISABLE                      (0u)
+#define DEBUG_TRANSPORT_ENABLE       (DISABLE)
+
+/* Offer compression of the tuner frames to the GATT client */
+#define TUNER_COMPRESSION_ENABLE     (ENABLE)
+
+/* Refuse Tuner command writes that do not lie inside a single writable field
+ * of the layout map in tuner_layout.c */
+#define TUNER_WRITE_CHECK_ENABLE     (ENABLE)
+#if DEBUG_TRANSPORT_ENABLE
+#define DEBUG_PRINTF                 (printf)
+#else
+#define DEBUG_PRINTF(...)
+#endif
+
+/* Length of the CapSense_DS characteristic in the GATT database; upper limit
+ * of the notification packet size */
+#define MAX_NOTIFICATION_PKT_SIZE    (492u)
+
+/* Bytes added in front of the notification payload: ATT opcode and handle
+ * (3 bytes), L2CAP length and channel ID (4 bytes) */
+#define ATT_NTF_HEADER_SIZE          (3u)
+#define L2CAP_HEADER_SIZE            (4u)
+
+/* Tuner bridge initialization packet, TUNER_BRIDGE_INIT_NTF_SIZE bytes:
+ * Size of CapSense structure(2 bytes)
+ * No of notification packets required to send complete CapSense data(2 bytes)
+ * Size of a change detection block(1 byte)
+ * Size of a notification packet(2 bytes)
+ * Version of the frame protocol(1 byte)
+ * Size of the streamed image(2 bytes)
+ * Features the client can enable, TUNER_FEATURE_* flags(1 byte) */
+#define CAPSENSE_DS_SIZE_LSB_IDX     (0u)
+#define CAPSENSE_DS_SIZE_MSB_IDX     (1u)
+#define NOTIFICATION_COUNT_IDX       (2u)
+#define TUNER_BLOCK_SIZE_IDX         (3u)
+#define NOTIFICATION_SIZE_LSB_IDX    (4u)
+#define NOTIFICATION_SIZE_MSB_IDX    (5u)
+#define NOTIFICATION_COUNT_MSB_IDX   (6u)
+#define TUNER_PROTOCOL_VERSION_IDX   (7u)
+#define TUNER_IMAGE_SIZE_LSB_IDX     (8u)
+#define TUNER_IMAGE_SIZE_MSB_IDX     (9u)
+#define TUNER_FEATURE_FLAGS_IDX      (10u)
+
+/* Version 1 is the raw structure without headers */
+#define TUNER_PROTOCOL_VERSION       (3u)
+
+/* Features offered in the bridge-init packet */
+#define TUNER_FEATURE_COMPRESSION    (0x01u)
+#if (TUNER_COMPRESSION_ENABLE == ENABLE)
+#define TUNER_SUPPORTED_FEATURES     (TUNER_FEATURE_COMPRESSION)
+#else
+#define TUNER_SUPPORTED_FEATURES     (0x00u)
+#endif
+
+/* Header in front of every frame notification packet:
+ * Frame number(2 bytes)
+ * Chunk index within the frame, TUNER_LAST_CHUNK_FLAG set on the last(2 bytes)
+ * CRC-16/CCITT-FALSE over the frame number, chunk index and payload(2 bytes) */
+#define TUNER_FRAME_HDR_SIZE         (6u)
+#define TUNER_FRAME_NUM_LSB_IDX      (0u)
+#define TUNER_FRAME_NUM_MSB_IDX      (1u)
+#define TUNER_CHUNK_IDX_LSB_IDX      (2u)
+#define TUNER_CHUNK_IDX_MSB_IDX      (3u)
+#define TUNER_CRC_LSB_IDX            (4u)
+#define TUNER_CRC_MSB_IDX            (5u)
+#define TUNER_CRC_COVERED_HDR_SIZE   (4u)
+#define TUNER_LAST_CHUNK_FLAG        (0x8000u)
+#define CRC16_INIT                   (0xFFFFu)
+#define CRC16_NIBBLE_SHIFT           (4u)
+#define CRC16_TOP_NIBBLE_SHIFT       (12u)
+#define NIBBLE_MASK                  (0x0Fu)
+
+/* Every Nth frame carries every block so that a client that lost a frame
+ * catches up without re-subscribing */
+#define TUNER_KEY_FRAME_INTERVAL     (64u)
+
+/* Frame payload:
+ * Encoding of the block data, TUNER_ENCODING_* flags(1 byte)
+ * Changed-block bitmap
+ * Block data: the changed blocks, or their encoded form */
+#define TUNER_PAYLOAD_HDR_SIZE       (1u)
+#define TUNER_ENCODING_RAW           (0x00u)
+
+/* Every 16-bit word (LSB first) of a block is replaced by its difference to
+ * the previous frame; a trailing odd byte by its byte difference */
+#define TUNER_ENCODING_DELTA         (0x01u)
+
+/* A zero byte is followed by the length of the zero run (1 to 255 bytes) */
+#define TUNER_ENCODING_ZERO_RLE      (0x02u)
+#define ZERO_RUN_MAX                 (255u)
+
+/* The streamed image is split into blocks of TUNER_BLOCK_SIZE bytes. Each
+ * frame starts with a bitmap, one bit per block (LSB first), followed by the
+ * blocks that changed since the previous frame. TUNER_BLOCK_COUNT and
+ * TUNER_BITMAP_SIZE are the upper limits for a full-structure image */
+#define TUNER_BLOCK_SIZE             (16u)
+#define TUNER_BLOCK_COUNT            ((sizeof(cy_capsense_tuner) +\
+                                       TUNER_BLOCK_SIZE - 1u) / TUNER_BLOCK_SIZE)
+#define TUNER_BITMAP_SIZE            ((TUNER_BLOCK_COUNT + 7u) / 8u)
+#define BITS_PER_BYTE                (8u)
+
+/* Tuner_Regions characteristic: list of windows of the CapSense structure
+ * streamed instead of the whole structure, each one
+ * Offset(2 bytes, LSB first)
+ * Length(2 bytes, LSB first)
+ * An empty list selects the whole structure. A single TUNER_REGIONS_SUMMARY
+ * byte selects the summary image of tuner_summary.c instead */
+#define TUNER_MAX_REGIONS            (16u)
+#define TUNER_REGIONS_SUMMARY        (0x53u)
+#define TUNER_REGIONS_SUMMARY_SIZE   (1u)
+#define TUNER_REGION_RECORD_SIZE     (4u)
+#define TUNER_REGION_OFFS_LSB_IDX    (0u)
+#define TUNER_REGION_OFFS_MSB_IDX    (1u)
+#define TUNER_REGION_LEN_LSB_IDX     (2u)
+#define TUNER_REGION_LEN_MSB_IDX     (3u)
+
+/* Custom Tuner command packet received from GATT Client - 7 bytes */
+#define TUNER_COMMAND_SIZE_0_IDX     (0u)
+#define TUNER_COMMAND_OFFS_0_IDX     (1u)
+#define TUNER_COMMAND_OFFS_1_IDX     (2u)
+#define TUNER_COMMAND_DATA_0_IDX     (3u)
+#define TUNER_COMMAND_DATA_1_IDX     (4u)
+#define TUNER_COMMAND_DATA_2_IDX     (5u)
+#define TUNER_COMMAND_DATA_3_IDX     (6u)
+#define TUNER_COMMAND_PACKET_SIZE    (7u)
+#define MAX_DATA_LENGTH              (4u)
+#define MSB_SHIFT                    (8u)
+
+/* Batch command packet received from GATT Client:
+ * TUNER_BATCH_COMMAND_ID(1 byte) followed by records of
+ * Offset(2 bytes, MSB first as in the 7-byte packet)
+ * Size(1 byte)
+ * Data(Size bytes, in the byte order of the CapSense data structure)
+ * All records are checked against the structure bounds before any of them
+ * is written */
+#define TUNER_BATCH_COMMAND_ID       (0xB0u)
+#define TUNER_BATCH_HDR_SIZE         (1u)
+#define TUNER_BATCH_RECORD_HDR_SIZE  (3u)
+#define TUNER_BATCH_OFFS_0_IDX       (0u)
+#define TUNER_BATCH_OFFS_1_IDX       (1u)
+#define TUNER_BATCH_SIZE_IDX         (2u)
+
+/* Tuner command queue entries the writes leave free for the connection
+ * events: a connect and a disconnect of every session */
+#define TUNER_CMD_EVENT_RESERVE      (2u * TUNER_MAX_SESSIONS)
+
+/* Feature command packet received from GATT Client:
+ * TUNER_FEATURE_COMMAND_ID(1 byte)
+ * Features to use, TUNER_FEATURE_* flags(1 byte) */
+#define TUNER_FEATURE_COMMAND_ID     (0xF0u)
+#define TUNER_FEATURE_COMMAND_SIZE   (2u)
+#define TUNER_FEATURE_MASK_IDX       (1u)
+
+
+/*******************************************************************************
+ * Data Types
+ ******************************************************************************/
+/* Window of the CapSense structure streamed to the GATT client */
+typedef struct
+{
+    uint16_t offset;
+    uint16_t length;
+} tuner_region_t;
+
+
+/* State of one subscribed GATT client. The frame payload is shared by all
+ * sessions; each session only keeps its own position in it */
+typedef struct
+{
+    bool active;                /* Notifications enabled */
+    bool in_frame;              /* Takes part in the frame in flight */
+
+    /* ATT MTU and maximum LL transmit payload of the connection */
+    uint16_t mtu;
+    uint16_t ll_tx_octets;
+
+    /* Notification packet size advertised to the client */
+    uint16_t chunk_size;
+
+    /* Tuner bridge initialization parameters have to be (re)sent */
+    bool init_pending;
+
+    /* Number of notification packets of a frame carrying every block */
+    uint16_t frame_chunk_count;
+
+    /* Features enabled by the client for this subscription */
+    uint8_t features;
+
+    /* Number of payload bytes gathered and the position inside the
+     * changed-block list */
+    uint16_t payload_pos;
+    uint16_t dirty_index;
+    uint16_t block_offset;
+
+    /* Index of the next notification packet of the frame */
+    uint16_t chunk_index;
+
+    /* Notification packet being sent; chunk_len is 0 when none is pending */
+    uint8_t buffer[MAX_NOTIFICATION_PKT_SIZE];
+    uint16_t chunk_len;
+} tuner_session_t;
+
+
+/*******************************************************************************
+ * Global variables
+ ******************************************************************************/
+/* Size of the CapSense data structure */
+static uint16_t capsense_ds_size = 0;
+
+/* Sessions of the subscribed GATT clients */
+static tuner_session_t tuner_sessions[TUNER_MAX_SESSIONS];
+
+/* Windows streamed to the GATT client; the whole structure if count is 0 */
+static tuner_region_t tuner_regions[TUNER_MAX_REGIONS];
+static uint8_t tuner_region_count = 0;
+
+/* Stream the summary image instead of the CapSense structure */
+static bool tx_summary = false;
+
+/* Windows or summary written by the client, applied at the next frame
+ * boundary */
+static tuner_region_t pending_regions[TUNER_MAX_REGIONS];
+static uint8_t pending_region_count = 0;
+static bool pending_summary = false;
+static bool regions_pending = false;
+
+/* Sessions with a connected client, one bit each, as the main loop learned
+ * them from the Tuner command queue */
+static uint8_t tuner_clients = 0;
+
+/* Size of the streamed image and the number of blocks and bitmap bytes */
+static uint16_t tx_image_size = sizeof(cy_capsense_tuner);
+static uint16_t tx_block_count = TUNER_BLOCK_COUNT;
+static uint16_t tx_bitmap_size = TUNER_BITMAP_SIZE;
+
+/* Copies of the streamed source taken when a frame starts. Notification
+ * packets are gathered from the copy of the frame in flight while the next
+ * scan updates the live structure; the other copy is the previous frame,
+ * which the next frame is compared against */
+static uint8_t tuner_snapshot[2u][sizeof(cy_capsense_tuner)];
+static uint8_t tx_snapshot_idx = 0;
+
+/* Send every block in the next frame, e.g. after notifications are enabled */
+static bool tx_full_frame = true;
+
+/* Blocks of the streamed image made up of static fields only. They only
+ * change when the tuner writes them, so they are compared against the
+ * previous frame only after a write, a change of the image, or for a full
+ * frame */
+static bool tx_block_static[TUNER_BLOCK_COUNT];
+static bool tx_static_map_valid = false;
+static bool tx_static_check = true;
+
+/* Changed-block bitmap and list of changed blocks of the frame in flight */
+static uint8_t tx_bitmap[TUNER_BITMAP_SIZE];
+static uint16_t tx_dirty_blocks[TUNER_BLOCK_COUNT];
+static uint16_t tx_dirty_count = 0;
+
+/* Encoding and encoded block data of the frame in flight */
+static uint8_t tx_encoding = TUNER_ENCODING_RAW;
+static uint8_t tx_encoded[sizeof(cy_capsense_tuner)];
+
+/* Payload length of the frame in flight */
+static uint16_t tx_payload_len = 0;
+
+/* Number of the frame in flight; frame numbers are shared by all sessions
+ * and keep counting across subscriptions */
+static uint16_t tx_frame_number = 0;
+
+/* CRC-16/CCITT-FALSE (polynomial 0x1021) lookup table, one nibble at a time */
+static const uint16_t crc16_nibble_table[] =
+{
+    0x0000u, 0x1021u, 0x2042u, 0x3063u, 0x4084u, 0x50A5u, 0x60C6u, 0x70E7u,
+    0x8108u, 0x9129u, 0xA14Au, 0xB16Bu, 0xC18Cu, 0xD1ADu, 0xE1CEu, 0xF1EFu
+};
+
+
+/*******************************************************************************
+ * Function Prototypes
+*******************************************************************************/
+static uint16_t tuner_block_length(uint16_t block);
+static bool tuner_frame_encode(bool use_delta);
+static void tuner_frame_gather(tuner_session_t *session, uint8_t *dst,\
+                               uint16_t len);
+static uint16_t tuner_chunk_size(const tuner_session_t *session);
+static uint16_t tuner_crc16(uint16_t crc, const uint8_t *data, uint16_t len);
+static void tuner_build_chunk(tuner_session_t *session);
+static void tuner_regions_apply(void);
+static void tuner_image_copy(uint8_t *dst, const uint8_t *src,\
+                             uint16_t offset, uint16_t len);
+static bool tuner_batch_valid(const uint8_t *data, uint16_t len);
+static void tuner_write_apply(const tuner_cmd_t *cmd, bool *widget_reinit);
+static bool tuner_write_enqueue(const uint8_t *records, uint16_t len);
+static bool tuner_write_is_command(uint16_t offset);
+static bool tuner_write_allowed(uint16_t offset, uint16_t len);
+static void tuner_static_map_update(void);
+static bool tuner_image_is_static(uint16_t offset, uint16_t len);
+
+
+/*******************************************************************************
+* Function Name: tuner_transport_subscribe
+********************************************************************************
+*
+* Summary:
+*   Starts a session for a GATT client that enabled notifications, or
+*   restarts it when the client subscribes again. Applies the windows
+*   written by the clients if no frame is in flight and disables the
+*   optional features of the session. The tuner bridge initialization
+*   parameters have to be sent to the client before its first frame. The
+*   link of the session has to be set with tuner_transport_set_link() first.
+*
+* Parameters:
+*  uint8_t session : Session index, below TUNER_MAX_SESSIONS
+*
+*******************************************************************************/
+void tuner_transport_subscribe(uint8_t session)
+{
+    tuner_transport_frame_abort(session);
+
+    if((regions_pending == true) && (tuner_transport_frame_in_flight() == false))
+    {
+        tuner_regions_apply();
+    }
+
+    tuner_sessions[session].active = true;
+    tuner_sessions[session].init_pending = true;
+    tuner_sessions[session].features = 0;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_transport_unsubscribe
+********************************************************************************
+*
+* Summary:
+*   Ends the session of a GATT client that disabled notifications or
+*   disconnected. The rest of its frame is dropped; the other sessions are
+*   not affected.
+*
+* Parameters:
+*  uint8_t session : Session index
+*
+*******************************************************************************/
+void tuner_transport_unsubscribe(uint8_t session)
+{
+    tuner_transport_frame_abort(session);
+    tuner_sessions[session].active = false;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_transport_set_link
+********************************************************************************
+*
+* Summary:
+*   Updates the ATT MTU and the LL data length of the connection of a
+*   session. If this changes the notification packet size, the tuner bridge
+*   initialization parameters are sent again before the next frame.
+*
+* Parameters:
+*  uint8_t session    : Session index
+*  uint16_t mtu       : ATT MTU of the connection
+*  uint16_t tx_octets : Maximum LL transmit payload of the connection
+*
+*******************************************************************************/
+void tuner_transport_set_link(uint8_t session, uint16_t mtu, uint16_t tx_octets)
+{
+    tuner_session_t *ses = &tuner_sessions[session];
+
+    ses->mtu = mtu;
+    ses->ll_tx_octets = tx_octets;
+
+    if(tuner_chunk_size(ses) != ses->chunk_size)
+    {
+        ses->init_pending = true;
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_transport_init_pending
+********************************************************************************
+*
+* Summary:
+*   Called between frames. Applies the windows written by the clients, if
+*   any, and tells whether the tuner bridge initialization parameters have
+*   to be sent to a session before the next frame.
+*
+* Parameters:
+*  uint8_t session : Session index
+*
+* Return:
+*   true if tuner_transport_build_init() has to be sent first
+*
+*******************************************************************************/
+bool tuner_transport_init_pending(uint8_t session)
+{
+    if(regions_pending == true)
+    {
+        tuner_regions_apply();
+    }
+
+    return (tuner_sessions[session].active && tuner_sessions[session].init_pending);
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_transport_build_init
+********************************************************************************
+*
+* Summary:
+*   Builds the tuner bridge initialization packet of a session: the size of
+*   the CapSense data structure, the notification packet size, the number of
+*   notification packets of a full frame, the frame protocol version, the
+*   size of the streamed image and the features the client can enable. The
+*   packet size and count are recomputed from the current link parameters
+*   on every call.
+*
+* Parameters:
+*  uint8_t session : Session index
+*  uint8_t *buffer : Buffer of TUNER_BRIDGE_INIT_NTF_SIZE bytes
+*
+* Return:
+*   Length of the packet
+*
+*******************************************************************************/
+uint16_t tuner_transport_build_init(uint8_t session, uint8_t *buffer)
+{
+    tuner_session_t *ses = &tuner_sessions[session];
+
+    capsense_ds_size = sizeof(cy_capsense_tuner);
+    ses->chunk_size = tuner_chunk_size(ses);
+
+    /* A raw frame carrying every block is the largest frame */
+    ses->frame_chunk_count = (TUNER_PAYLOAD_HDR_SIZE + tx_image_size +\
+                              tx_bitmap_size + ses->chunk_size -\
+                              TUNER_FRAME_HDR_SIZE - 1u) /\
+                             (ses->chunk_size - TUNER_FRAME_HDR_SIZE);
+
+    buffer[CAPSENSE_DS_SIZE_LSB_IDX] = (uint8_t)(capsense_ds_size & 0x00FF);
+    buffer[CAPSENSE_DS_SIZE_MSB_IDX] = (uint8_t)(capsense_ds_size >> 8);
+    buffer[NOTIFICATION_COUNT_IDX] = (uint8_t)(ses->frame_chunk_count & 0x00FF);
+    buffer[TUNER_BLOCK_SIZE_IDX] = TUNER_BLOCK_SIZE;
+    buffer[NOTIFICATION_SIZE_LSB_IDX] = (uint8_t)(ses->chunk_size & 0x00FF);
+    buffer[NOTIFICATION_SIZE_MSB_IDX] = (uint8_t)(ses->chunk_size >> 8);
+    buffer[NOTIFICATION_COUNT_MSB_IDX] = (uint8_t)(ses->frame_chunk_count >> 8);
+    buffer[TUNER_PROTOCOL_VERSION_IDX] = TUNER_PROTOCOL_VERSION;
+    buffer[TUNER_IMAGE_SIZE_LSB_IDX] = (uint8_t)(tx_image_size & 0x00FF);
+    buffer[TUNER_IMAGE_SIZE_MSB_IDX] = (uint8_t)(tx_image_size >> 8);
+    buffer[TUNER_FEATURE_FLAGS_IDX] = TUNER_SUPPORTED_FEATURES;
+
+    return TUNER_BRIDGE_INIT_NTF_SIZE;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_transport_init_sent
+********************************************************************************
+*
+* Summary:
+*   Called once the tuner bridge initialization packet of a session is
+*   accepted by the BLE stack. The client has no copy of the structure yet,
+*   so the next frame carries every block; it is sent to every session.
+*
+* Parameters:
+*  uint8_t session : Session index
+*
+*******************************************************************************/
+void tuner_transport_init_sent(uint8_t session)
+{
+    tuner_session_t *ses = &tuner_sessions[session];
+
+    printf("\n\rSent Tuner bridge initialization parameters"\
+               " to GATT Client %u... \n\r", session);
+    printf("Size of CapSense Data Structure: %u\n\r", capsense_ds_size);
+    printf("Notification packet size: %u \n\r", ses->chunk_size);
+    printf("No of notifications to send complete data structure: "\
+                                    "%u\n\r", ses->frame_chunk_count);
+    printf("Change detection block size: %u\n\r", TUNER_BLOCK_SIZE);
+    printf("Streamed image size: %u (%u windows)\n\r", tx_image_size,\
+                                    tuner_region_count);
+
+    tx_full_frame = true;
+    ses->init_pending = false;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_transport_frame_abort
+********************************************************************************
+*
+* Summary:
+*   Drops the rest of the frame in flight for one session, e.g. when its
+*   client went away.
+*
+* Parameters:
+*  uint8_t session : Session index
+*
+*******************************************************************************/
+void tuner_transport_frame_abort(uint8_t session)
+{
+    tuner_sessions[session].in_frame = false;
+    tuner_sessions[session].chunk_len = 0;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_transport_frame_done
+********************************************************************************
+*
+* Summary:
+*   Returns true once every notification packet of the frame in flight has
+*   been accepted by the BLE stack for a session, or if the session does not
+*   take part in the frame.
+*
+* Parameters:
+*  uint8_t session : Session index
+*
+*******************************************************************************/
+bool tuner_transport_frame_done(uint8_t session)
+{
+    return (tuner_sessions[session].in_frame == false);
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_transport_frame_in_flight
+********************************************************************************
+*
+* Summary:
+*   Returns true while any session still has packets of the frame in
+*   flight. The snapshot of the frame may not change until then.
+*
+*******************************************************************************/
+bool tuner_transport_frame_in_flight(void)
+{
+    for(uint8_t i = 0; i < TUNER_MAX_SESSIONS; i++)
+    {
+        if(tuner_sessions[i].in_frame == true)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_transport_next_chunk
+********************************************************************************
+*
+* Summary:
+*   Returns the next notification packet of the frame in flight for a
+*   session. The same packet is returned until tuner_transport_chunk_sent()
+*   is called, so a packet the BLE stack did not accept is retried.
+*
+* Parameters:
+*  uint8_t session       : Session index
+*  const uint8_t **chunk : Set to the packet
+*
+* Return:
+*   Length of the packet, 0 if the session has no packet to send
+*
+*******************************************************************************/
+uint16_t tuner_transport_next_chunk(uint8_t session, const uint8_t **chunk)
+{
+    tuner_session_t *ses = &tuner_sessions[session];
+
+    if((ses->in_frame == true) && (ses->chunk_len == 0u))
+    {
+        tuner_build_chunk(ses);
+    }
+
+    *chunk = ses->buffer;
+
+    return (ses->in_frame == true) ? ses->chunk_len : 0u;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_transport_chunk_sent
+********************************************************************************
+*
+* Summary:
+*   Called when the BLE stack accepted the packet returned by
+*   tuner_transport_next_chunk(). The session leaves the frame after its
+*   last packet.
+*
+* Parameters:
+*  uint8_t session : Session index
+*
+*******************************************************************************/
+void tuner_transport_chunk_sent(uint8_t session)
+{
+    tuner_session_t *ses = &tuner_sessions[session];
+
+    ses->chunk_len = 0;
+
+    if(ses->payload_pos == tx_payload_len)
+    {
+        ses->in_frame = false;
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_transport_chunk_size
+********************************************************************************
+*
+* Summary:
+*   Returns the notification packet size sent to a session in its last
+*   tuner bridge initialization packet.
+*
+* Parameters:
+*  uint8_t session : Session index
+*
+*******************************************************************************/
+uint16_t tuner_transport_chunk_size(uint8_t session)
+{
+    return tuner_sessions[session].chunk_size;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_transport_image_size
+********************************************************************************
+*
+* Summary:
+*   Returns the size of the streamed image: the CapSense structure, or the
+*   total length of the windows written to Tuner_Regions.
+*
+*******************************************************************************/
+uint16_t tuner_transport_image_size(void)
+{
+    return tx_image_size;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_build_chunk
+********************************************************************************
+*
+* Summary:
+*   Builds the next notification packet of the frame in flight in the
+*   buffer of a session: the frame header followed by the next part of the
+*   frame payload.
+*
+* Parameters:
+*  tuner_session_t *session : Session to build the packet for
+*
+*******************************************************************************/
+static void tuner_build_chunk(tuner_session_t *session)
+{
+    uint16_t payload_len = tx_payload_len - session->payload_pos;
+    uint16_t chunk_index = session->chunk_index;
+    uint16_t crc = CRC16_INIT;
+
+    if(payload_len > (session->chunk_size - TUNER_FRAME_HDR_SIZE))
+    {
+        payload_len = session->chunk_size - TUNER_FRAME_HDR_SIZE;
+    }
+
+    tuner_frame_gather(session, &session->buffer[TUNER_FRAME_HDR_SIZE], payload_len);
+
+    if(session->payload_pos == tx_payload_len)
+    {
+        chunk_index |= TUNER_LAST_CHUNK_FLAG;
+    }
+
+    session->buffer[TUNER_FRAME_NUM_LSB_IDX] = (uint8_t)(tx_frame_number & 0x00FF);
+    session->buffer[TUNER_FRAME_NUM_MSB_IDX] = (uint8_t)(tx_frame_number >> 8);
+    session->buffer[TUNER_CHUNK_IDX_LSB_IDX] = (uint8_t)(chunk_index & 0x00FF);
+    session->buffer[TUNER_CHUNK_IDX_MSB_IDX] = (uint8_t)(chunk_index >> 8);
+
+    crc = tuner_crc16(crc, session->buffer, TUNER_CRC_COVERED_HDR_SIZE);
+    crc = tuner_crc16(crc, &session->buffer[TUNER_FRAME_HDR_SIZE], payload_len);
+    session->buffer[TUNER_CRC_LSB_IDX] = (uint8_t)(crc & 0x00FF);
+    session->buffer[TUNER_CRC_MSB_IDX] = (uint8_t)(crc >> 8);
+
+    session->chunk_len = payload_len + TUNER_FRAME_HDR_SIZE;
+    session->chunk_index++;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_crc16
+********************************************************************************
+*
+* Summary:
+*   Updates a CRC-16/CCITT-FALSE with len bytes of data.
+*
+* Parameters:
+*  uint16_t crc        : CRC of the preceding bytes, CRC16_INIT to start
+*  const uint8_t *data : Bytes to add
+*  uint16_t len        : Number of bytes
+*
+* Return:
+*   Updated CRC
+*
+*******************************************************************************/
+static uint16_t tuner_crc16(uint16_t crc, const uint8_t *data, uint16_t len)
+{
+    for(uint16_t i = 0; i < len; i++)
+    {
+        crc = (uint16_t)(crc << CRC16_NIBBLE_SHIFT) ^\
+              crc16_nibble_table[(crc >> CRC16_TOP_NIBBLE_SHIFT) ^\
+                                 (data[i] >> CRC16_NIBBLE_SHIFT)];
+        crc = (uint16_t)(crc << CRC16_NIBBLE_SHIFT) ^\
+              crc16_nibble_table[(crc >> CRC16_TOP_NIBBLE_SHIFT) ^\
+                                 (data[i] & NIBBLE_MASK)];
+    }
+
+    return crc;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_block_length
+********************************************************************************
+*
+* Summary:
+*   Returns the number of bytes in a block of the streamed image; the last
+*   block may be short.
+*
+*******************************************************************************/
+static uint16_t tuner_block_length(uint16_t block)
+{
+    uint16_t start = block * TUNER_BLOCK_SIZE;
+    uint16_t length = TUNER_BLOCK_SIZE;
+
+    if((start + length) > tx_image_size)
+    {
+        length = tx_image_size - start;
+    }
+
+    return length;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_transport_frame_start
+********************************************************************************
+*
+* Summary:
+*   Takes a snapshot of the CapSense structure, compares each block of the
+*   streamed image against the previous frame and builds the changed-block
+*   bitmap of a new frame. Called after the widgets are processed, so the
+*   snapshot holds the results of one scan. Called only when no session
+*   has a frame in flight; every subscribed session that is not waiting for
+*   its tuner bridge initialization packet takes part in the frame. The
+*   frame is compressed only if all of them enabled compression.
+*
+* Return:
+*   true if at least one session takes part and one block has to be sent
+*
+*******************************************************************************/
+bool tuner_transport_frame_start(void)
+{
+    uint8_t next_idx = tx_snapshot_idx ^ 1u;
+    uint8_t block_data[TUNER_BLOCK_SIZE];
+    uint8_t prev_data[TUNER_BLOCK_SIZE];
+    uint16_t length = 0;
+    bool use_delta = false;
+    bool compress = true;
+    uint8_t participants = 0;
+
+    for(uint8_t i = 0; i < TUNER_MAX_SESSIONS; i++)
+    {
+        if((tuner_sessions[i].active == true) &&\
+           (tuner_sessions[i].init_pending == false))
+        {
+            participants++;
+            if((tuner_sessions[i].features & TUNER_FEATURE_COMPRESSION) == 0u)
+            {
+                compress = false;
+            }
+        }
+    }
+
+    if(participants == 0u)
+    {
+        return false;
+    }
+
+    if(tx_summary == true)
+    {
+        memcpy(tuner_snapshot[next_idx], tuner_summary_image(), TUNER_SUMMARY_SIZE);
+    }
+    else
+    {
+        memcpy(tuner_snapshot[next_idx], &cy_capsense_tuner, sizeof(cy_capsense_tuner));
+    }
+
+    if(tx_static_map_valid == false)
+    {
+        tuner_static_map_update();
+    }
+
+    if(((uint16_t)(tx_frame_number + 1u) % TUNER_KEY_FRAME_INTERVAL) == 0u)
+    {
+        tx_full_frame = true;
+    }
+
+    /* The client may not hold the previous frame when all blocks are sent */
+    use_delta = !tx_full_frame;
+
+    memset(tx_bitmap, 0, sizeof(tx_bitmap));
+    tx_dirty_count = 0;
+    tx_payload_len = TUNER_PAYLOAD_HDR_SIZE + tx_bitmap_size;
+
+    for(uint16_t block = 0; block < tx_block_count; block++)
+    {
+        length = tuner_block_length(block);
+
+        /* Unchanged since the last compare; the live structure is only
+         * written through the Tuner commands */
+        if((tx_full_frame == false) && (tx_static_check == false) &&\
+           (tx_block_static[block] == true))
+        {
+            continue;
+        }
+
+        tuner_image_copy(block_data, tuner_snapshot[next_idx],\
+                         block * TUNER_BLOCK_SIZE, length);
+        tuner_image_copy(prev_data, tuner_snapshot[tx_snapshot_idx],\
+                         block * TUNER_BLOCK_SIZE, length);
+
+        if((tx_full_frame == true) ||\
+           (memcmp(block_data, prev_data, length) != 0))
+        {
+            tx_bitmap[block / BITS_PER_BYTE] |=\
+                    (uint8_t)(1u << (block % BITS_PER_BYTE));
+            tx_dirty_blocks[tx_dirty_count] = block;
+            tx_dirty_count++;
+            tx_payload_len += length;
+        }
+    }
+
+    tx_static_check = false;
+
+    if(tx_dirty_count > 0u)
+    {
+        /* The new snapshot becomes the frame in flight */
+        tx_snapshot_idx = next_idx;
+        tx_full_frame = false;
+        tx_frame_number++;
+
+        tx_encoding = TUNER_ENCODING_RAW;
+        if((compress == true) &&\
+           (tuner_frame_encode(use_delta) == true))
+        {
+            tx_encoding = TUNER_ENCODING_ZERO_RLE;
+            if(use_delta == true)
+            {
+                tx_encoding |= TUNER_ENCODING_DELTA;
+            }
+        }
+    }
+
+    for(uint8_t i = 0; (i < TUNER_MAX_SESSIONS) && (tx_dirty_count > 0u); i++)
+    {
+        if((tuner_sessions[i].active == true) &&\
+           (tuner_sessions[i].init_pending == false))
+        {
+            tuner_sessions[i].in_frame = true;
+            tuner_sessions[i].chunk_index = 0;
+            tuner_sessions[i].payload_pos = 0;
+            tuner_sessions[i].dirty_index = 0;
+            tuner_sessions[i].block_offset = 0;
+            tuner_sessions[i].chunk_len = 0;
+        }
+    }
+
+    return (tx_dirty_count > 0u);
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_frame_encode
+********************************************************************************
+*
+* Summary:
+*   Encodes the changed blocks of the frame in flight into tx_encoded. With
+*   use_delta, each 16-bit word is first replaced by its difference to the
+*   previous frame, which turns unchanged and slowly changing counters into
+*   zeros and small values. The result is then zero-run-length encoded.
+*   Gives up as soon as the encoded data would not be smaller than the raw
+*   blocks.
+*
+* Parameters:
+*  bool use_delta : Encode the difference to the previous frame
+*
+* Return:
+*   true if the frame was encoded; the payload length is updated
+*
+*******************************************************************************/
+static bool tuner_frame_encode(bool use_delta)
+{
+    const uint8_t *current = tuner_snapshot[tx_snapshot_idx];
+    const uint8_t *previous = tuner_snapshot[tx_snapshot_idx ^ 1u];
+    uint8_t block_data[TUNER_BLOCK_SIZE];
+    uint8_t prev_data[TUNER_BLOCK_SIZE];
+    uint16_t raw_len = tx_payload_len - TUNER_PAYLOAD_HDR_SIZE - tx_bitmap_size;
+    uint16_t out_len = 0;
+    uint16_t block = 0;
+    uint16_t length = 0;
+    uint16_t word = 0;
+    uint8_t zero_run = 0;
+
+    for(uint16_t i = 0; i < tx_dirty_count; i++)
+    {
+        block = tx_dirty_blocks[i];
+        length = tuner_block_length(block);
+        tuner_image_copy(block_data, current, block * TUNER_BLOCK_SIZE, length);
+
+        if(use_delta == true)
+        {
+            tuner_image_copy(prev_data, previous, block * TUNER_BLOCK_SIZE, length);
+
+            for(uint16_t j = 0; (j + 1u) < length; j += 2u)
+            {
+                word = (uint16_t)(((uint16_t)block_data[j] |\
+                                   ((uint16_t)block_data[j + 1u] << MSB_SHIFT)) -\
+                                  ((uint16_t)prev_data[j] |\
+                                   ((uint16_t)prev_data[j + 1u] << MSB_SHIFT)));
+                block_data[j] = (uint8_t)(word & 0x00FF);
+                block_data[j + 1u] = (uint8_t)(word >> 8);
+            }
+
+            if((length % 2u) != 0u)
+            {
+                block_data[length - 1u] -= prev_data[length - 1u];
+            }
+        }
+
+        for(uint16_t j = 0; j < length; j++)
+        {
+            if(block_data[j] == 0u)
+            {
+                zero_run++;
+                if(zero_run < ZERO_RUN_MAX)
+                {
+                    continue;
+                }
+            }
+
+            /* Flush the zero run, then store the literal byte */
+            if(zero_run > 0u)
+            {
+                if((out_len + 2u) >= raw_len)
+                {
+                    return false;
+                }
+                tx_encoded[out_len++] = 0u;
+                tx_encoded[out_len++] = zero_run;
+                zero_run = 0;
+            }
+
+            if(block_data[j] != 0u)
+            {
+                if((out_len + 1u) >= raw_len)
+                {
+                    return false;
+                }
+                tx_encoded[out_len++] = block_data[j];
+            }
+        }
+    }
+
+    if(zero_run > 0u)
+    {
+        if((out_len + 2u) >= raw_len)
+        {
+            return false;
+        }
+        tx_encoded[out_len++] = 0u;
+        tx_encoded[out_len++] = zero_run;
+    }
+
+    tx_payload_len = TUNER_PAYLOAD_HDR_SIZE + tx_bitmap_size + out_len;
+
+    return true;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_frame_gather
+********************************************************************************
+*
+* Summary:
+*   Copies the next len bytes of the frame payload (encoding, bitmap and
+*   block data) of a session to dst. Raw block data is copied from the
+*   snapshot of the frame in flight.
+*
+* Parameters:
+*  tuner_session_t *session : Session whose payload cursor is advanced
+*  uint8_t *dst : Destination buffer
+*  uint16_t len : Number of bytes to copy
+*
+*******************************************************************************/
+static void tuner_frame_gather(tuner_session_t *session, uint8_t *dst,\
+                               uint16_t len)
+{
+    uint16_t block = 0;
+    uint16_t block_len = 0;
+    uint16_t copy_len = 0;
+
+    while(len > 0u)
+    {
+        if(session->payload_pos < TUNER_PAYLOAD_HDR_SIZE)
+        {
+            *dst++ = tx_encoding;
+            session->payload_pos++;
+            len--;
+            continue;
+        }
+
+        if(session->payload_pos < (TUNER_PAYLOAD_HDR_SIZE + tx_bitmap_size))
+        {
+            *dst++ = tx_bitmap[session->payload_pos - TUNER_PAYLOAD_HDR_SIZE];
+            session->payload_pos++;
+            len--;
+            continue;
+        }
+
+        if(tx_encoding != TUNER_ENCODING_RAW)
+        {
+            /* Encoded block data is already in tx_encoded */
+            memcpy(dst, &tx_encoded[session->payload_pos - TUNER_PAYLOAD_HDR_SIZE -\
+                                    tx_bitmap_size], len);
+            session->payload_pos += len;
+            break;
+        }
+
+        block = tx_dirty_blocks[session->dirty_index];
+        block_len = tuner_block_length(block);
+        copy_len = block_len - session->block_offset;
+        if(copy_len > len)
+        {
+            copy_len = len;
+        }
+
+        tuner_image_copy(dst, tuner_snapshot[tx_snapshot_idx],\
+                         (block * TUNER_BLOCK_SIZE) + session->block_offset, copy_len);
+
+        dst += copy_len;
+        len -= copy_len;
+        session->payload_pos += copy_len;
+        session->block_offset += copy_len;
+
+        if(session->block_offset == block_len)
+        {
+            session->dirty_index++;
+            session->block_offset = 0;
+        }
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_chunk_size
+********************************************************************************
+*
+* Summary:
+*   Derives the notification packet size of a session from the ATT MTU and
+*   the LL data length of its connection. The packet is as large as the
+*   MTU and the CapSense_DS characteristic allow, but is trimmed when that
+*   would leave only a short trailing LL fragment for each notification.
+*
+* Parameters:
+*  const tuner_session_t *session : Session to size the packets for
+*
+* Return:
+*   Notification packet size in bytes
+*
+*******************************************************************************/
+static uint16_t tuner_chunk_size(const tuner_session_t *session)
+{
+    uint16_t ll_tx_octets = session->ll_tx_octets;
+    uint16_t chunk_size = session->mtu - ATT_NTF_HEADER_SIZE;
+    uint16_t pdu_size = 0;
+    uint16_t fragments = 0;
+    uint16_t last_fragment = 0;
+
+    if(chunk_size > MAX_NOTIFICATION_PKT_SIZE)
+    {
+        chunk_size = MAX_NOTIFICATION_PKT_SIZE;
+    }
+
+    /* L2CAP PDU carrying one notification */
+    pdu_size = chunk_size + ATT_NTF_HEADER_SIZE + L2CAP_HEADER_SIZE;
+    fragments = (pdu_size + ll_tx_octets - 1u) / ll_tx_octets;
+    last_fragment = pdu_size - ((fragments - 1u) * ll_tx_octets);
+
+    if((fragments > 1u) && (last_fragment < (ll_tx_octets / 2u)))
+    {
+        /* Fill the previous fragments completely instead */
+        chunk_size = ((fragments - 1u) * ll_tx_octets) -\
+                     ATT_NTF_HEADER_SIZE - L2CAP_HEADER_SIZE;
+    }
+
+    return chunk_size;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_transport_regions_write
+********************************************************************************
+*
+* Summary:
+*   Validates a list of windows written to the Tuner_Regions characteristic
+*   and stages it to be applied at the next frame boundary. Every window has
+*   to lie inside the CapSense structure and the windows together may not be
+*   larger than the structure. The summary selection is staged the same way.
+*
+* Parameters:
+*  const uint8_t *data : Written value
+*  uint16_t len        : Length of the written value
+*
+* Return:
+*   true if the list is valid
+*
+*******************************************************************************/
+bool tuner_transport_regions_write(const uint8_t *data, uint16_t len)
+{
+    tuner_region_t regions[TUNER_MAX_REGIONS];
+    uint8_t region_count = 0;
+    uint32_t total_length = 0;
+
+    if((len == TUNER_REGIONS_SUMMARY_SIZE) &&\
+       (data[0] == TUNER_REGIONS_SUMMARY))
+    {
+        pending_region_count = 0;
+        pending_summary = true;
+        regions_pending = true;
+        return true;
+    }
+
+    if(((len % TUNER_REGION_RECORD_SIZE) != 0u) ||\
+       (len > (TUNER_MAX_REGIONS * TUNER_REGION_RECORD_SIZE)))
+    {
+        return false;
+    }
+
+    for(uint16_t i = 0; i < len; i += TUNER_REGION_RECORD_SIZE)
+    {
+        regions[region_count].offset =\
+            (uint16_t)data[i + TUNER_REGION_OFFS_LSB_IDX] |\
+            ((uint16_t)data[i + TUNER_REGION_OFFS_MSB_IDX] << MSB_SHIFT);
+        regions[region_count].length =\
+            (uint16_t)data[i + TUNER_REGION_LEN_LSB_IDX] |\
+            ((uint16_t)data[i + TUNER_REGION_LEN_MSB_IDX] << MSB_SHIFT);
+
+        if((regions[region_count].length == 0u) ||\
+           (((uint32_t)regions[region_count].offset +\
+             regions[region_count].length) > sizeof(cy_capsense_tuner)))
+        {
+            return false;
+        }
+
+        total_length += regions[region_count].length;
+        region_count++;
+    }
+
+    if(total_length > sizeof(cy_capsense_tuner))
+    {
+        return false;
+    }
+
+    memcpy(pending_regions, regions, sizeof(regions));
+    pending_region_count = region_count;
+    pending_summary = false;
+    regions_pending = true;
+
+    return true;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_regions_apply
+********************************************************************************
+*
+* Summary:
+*   Switches to the windows or the summary staged by
+*   tuner_transport_regions_write(). Called between frames; the client is
+*   sent new bridge initialization parameters and a full frame of the new
+*   image.
+*
+*******************************************************************************/
+static void tuner_regions_apply(void)
+{
+    memcpy(tuner_regions, pending_regions, sizeof(tuner_regions));
+    tuner_region_count = pending_region_count;
+    tx_summary = pending_summary;
+    regions_pending = false;
+
+    if(tx_summary == true)
+    {
+        tx_image_size = TUNER_SUMMARY_SIZE;
+    }
+    else if(tuner_region_count == 0u)
+    {
+        tx_image_size = sizeof(cy_capsense_tuner);
+    }
+    else
+    {
+        tx_image_size = 0;
+        for(uint8_t i = 0; i < tuner_region_count; i++)
+        {
+            tx_image_size += tuner_regions[i].length;
+        }
+    }
+
+    tx_block_count = (tx_image_size + TUNER_BLOCK_SIZE - 1u) / TUNER_BLOCK_SIZE;
+    tx_bitmap_size = (tx_block_count + BITS_PER_BYTE - 1u) / BITS_PER_BYTE;
+
+    /* Every client has to learn the new image size */
+    for(uint8_t i = 0; i < TUNER_MAX_SESSIONS; i++)
+    {
+        tuner_sessions[i].init_pending = true;
+    }
+
+    tx_static_map_valid = false;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_image_copy
+********************************************************************************
+*
+* Summary:
+*   Copies bytes of the streamed image to dst. The image is the CapSense
+*   structure, the subscribed windows of it placed back to back, or the
+*   summary image.
+*
+* Parameters:
+*  uint8_t *dst       : Destination buffer
+*  const uint8_t *src : Snapshot of the streamed source
+*  uint16_t offset    : Offset in the streamed image
+*  uint16_t len       : Number of bytes to copy
+*
+*******************************************************************************/
+static void tuner_image_copy(uint8_t *dst, const uint8_t *src,\
+                             uint16_t offset, uint16_t len)
+{
+    uint16_t copy_len = 0;
+
+    if(tuner_region_count == 0u)
+    {
+        memcpy(dst, src + offset, len);
+        return;
+    }
+
+    for(uint8_t i = 0; (i < tuner_region_count) && (len > 0u); i++)
+    {
+        if(offset >= tuner_regions[i].length)
+        {
+            offset -= tuner_regions[i].length;
+            continue;
+        }
+
+        copy_len = tuner_regions[i].length - offset;
+        if(copy_len > len)
+        {
+            copy_len = len;
+        }
+
+        memcpy(dst, src + tuner_regions[i].offset + offset, copy_len);
+        dst += copy_len;
+        len -= copy_len;
+        offset = 0;
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_transport_command_write
+********************************************************************************
+*
+* Summary:
+*   Queues the writes of a Tuner command packet for the CapSense data
+*   structure. Accepts the 7-byte packet carrying up to MAX_DATA_LENGTH bytes
+*   for one offset and the batch packet carrying any number of records. A
+*   packet with a write that is not allowed is dropped. A write of the tuner
+*   command is applied at once, see tuner_write_enqueue(). The feature command
+*   packet selects the features offered in the bridge-init packet for the
+*   session of the sender only.
+*
+* Parameters:
+*  uint8_t session     : Session index of the client that wrote the packet
+*  const uint8_t *data : Received command packet
+*  uint16_t len        : Length of the command packet
+*
+*******************************************************************************/
+void tuner_transport_command_write(uint8_t session, const uint8_t *data,\
+                                   uint16_t len)
+{
+    uint16_t offset_address= 0;
+    uint8_t length = 0;
+    uint8_t record[TUNER_BATCH_RECORD_HDR_SIZE + MAX_DATA_LENGTH];
+
+    /* Check if length of received packet is equal to
+     * TUNER_COMMAND_PACKET_SIZE; its size field is never larger than
+     * MAX_DATA_LENGTH, which tells it apart from a batch packet */
+    if((len == TUNER_COMMAND_PACKET_SIZE) &&\
+       (data[TUNER_COMMAND_SIZE_0_IDX] <= MAX_DATA_LENGTH))
+    {
+        offset_address =\
+        ((uint16_t)data[TUNER_COMMAND_OFFS_0_IDX] << MSB_SHIFT)\
+         | (uint16_t)data[TUNER_COMMAND_OFFS_1_IDX];
+
+        length = data[TUNER_COMMAND_SIZE_0_IDX];
+
+        if(tuner_write_allowed(offset_address, length) == true)
+        {
+            /* Turn it into a batch record; the data comes last byte first */
+            record[TUNER_BATCH_OFFS_0_IDX] = data[TUNER_COMMAND_OFFS_0_IDX];
+            record[TUNER_BATCH_OFFS_1_IDX] = data[TUNER_COMMAND_OFFS_1_IDX];
+            record[TUNER_BATCH_SIZE_IDX] = length;
+            for (uint8_t i = 0 , j = MAX_DATA_LENGTH - 1; i < length; i++, j--)
+            {
+                record[TUNER_BATCH_RECORD_HDR_SIZE + i] =\
+                    data[TUNER_COMMAND_DATA_0_IDX + j];
+            }
+
+            (void)tuner_write_enqueue(record, TUNER_BATCH_RECORD_HDR_SIZE + length);
+        }
+    }
+    else if((len == TUNER_FEATURE_COMMAND_SIZE) &&\
+            (data[0] == TUNER_FEATURE_COMMAND_ID))
+    {
+        /* Takes effect with the next frame; each frame names its encoding */
+        tuner_sessions[session].features =\
+                data[TUNER_FEATURE_MASK_IDX] & TUNER_SUPPORTED_FEATURES;
+    }
+    else if((len > TUNER_BATCH_HDR_SIZE) &&\
+            (data[0] == TUNER_BATCH_COMMAND_ID))
+    {
+        /* Validate every record first so that a bad packet changes nothing */
+        if(tuner_batch_valid(data, len) == true)
+        {
+            (void)tuner_write_enqueue(&data[TUNER_BATCH_HDR_SIZE],\
+                                      len - TUNER_BATCH_HDR_SIZE);
+        }
+    }
+    else
+    {
+        DEBUG_PRINTF("Unknown Tuner command packet, length %u\r\n", len);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_batch_valid
+********************************************************************************
+*
+* Summary:
+*   Walks the records of a batch command packet and checks that every record
+*   is complete and may be written.
+*
+* Parameters:
+*  const uint8_t *data : Batch command packet
+*  uint16_t len        : Length of the batch command packet
+*
+* Return:
+*   true if every record is valid
+*
+*******************************************************************************/
+static bool tuner_batch_valid(const uint8_t *data, uint16_t len)
+{
+    uint16_t pos = TUNER_BATCH_HDR_SIZE;
+    uint16_t offset_address = 0;
+    uint8_t length = 0;
+
+    while(pos < len)
+    {
+        if((uint16_t)(len - pos) < TUNER_BATCH_RECORD_HDR_SIZE)
+        {
+            return false;
+        }
+
+        offset_address =\
+        ((uint16_t)data[pos + TUNER_BATCH_OFFS_0_IDX] << MSB_SHIFT)\
+         | (uint16_t)data[pos + TUNER_BATCH_OFFS_1_IDX];
+        length = data[pos + TUNER_BATCH_SIZE_IDX];
+        pos += TUNER_BATCH_RECORD_HDR_SIZE;
+
+        if(((uint16_t)(len - pos) < length) ||\
+           (tuner_write_allowed(offset_address, length) == false))
+        {
+            return false;
+        }
+
+        pos += length;
+    }
+
+    return true;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_transport_writes_apply
+********************************************************************************
+*
+* Summary:
+*   Drains the Tuner command queue into the CapSense data structure in the
+*   order the writes arrived. Called between scans, after the results of the
+*   last widget are processed and before the first widget is scanned again,
+*   so every write takes effect with the next scan as a whole. The widgets
+*   whose raw counts change are judged by the field each write starts in; a
+*   common field such as a modulator clock changes those of all widgets. An
+*   applied write also makes the next frame compare the static blocks. The
+*   connection events in the queue update the clients connected, see
+*   tuner_transport_client_connected().
+*
+* Parameters:
+*  bool *widget_reinit : One flag per widget, set for the widgets whose
+*                        baseline has to be initialized again
+*
+* Return:
+*   true if any write was applied
+*
+*******************************************************************************/
+bool tuner_transport_writes_apply(bool *widget_reinit)
+{
+    const tuner_cmd_t *cmd = tuner_cmd_queue_peek();
+    bool applied = false;
+
+    memset(widget_reinit, 0, CY_CAPSENSE_WIDGET_COUNT * sizeof(bool));
+
+    while(cmd != NULL)
+    {
+        switch(cmd->type)
+        {
+        case TUNER_CMD_CONNECT:
+            tuner_clients |= (uint8_t)(1u << cmd->session);
+            break;
+
+        case TUNER_CMD_DISCONNECT:
+            tuner_clients &= (uint8_t)~(1u << cmd->session);
+            break;
+
+        default:
+            tuner_write_apply(cmd, widget_reinit);
+            applied = true;
+            break;
+        }
+
+        tuner_cmd_queue_pop();
+        cmd = tuner_cmd_queue_peek();
+    }
+
+    if(applied == true)
+    {
+        tx_static_check = true;
+    }
+
+    return applied;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_write_apply
+********************************************************************************
+*
+* Summary:
+*   Writes a queued Tuner write into the CapSense data structure and marks
+*   the widgets whose baseline it invalidates.
+*
+* Parameters:
+*  const tuner_cmd_t *cmd : Queued write
+*  bool *widget_reinit    : One flag per widget
+*
+*******************************************************************************/
+static void tuner_write_apply(const tuner_cmd_t *cmd, bool *widget_reinit)
+{
+    uint16_t field_start = 0;
+    uint16_t field_size = 0;
+    uint32_t widget = 0;
+
+    memcpy(((uint8_t *)&cy_capsense_tuner) + cmd->offset, cmd->data,\
+           cmd->size);
+
+    if((tuner_layout_class(cmd->offset, &field_start, &field_size) &\
+        TUNER_LAYOUT_REINIT) != 0u)
+    {
+        widget = tuner_layout_widget(cmd->offset);
+        if(widget != TUNER_LAYOUT_NO_WIDGET)
+        {
+            widget_reinit[widget] = true;
+        }
+        else
+        {
+            /* A common setting such as a modulator clock */
+            for(widget = 0; widget < CY_CAPSENSE_WIDGET_COUNT; widget++)
+            {
+                widget_reinit[widget] = true;
+            }
+        }
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_transport_connection_event
+********************************************************************************
+*
+* Summary:
+*   Puts a connection event in the Tuner command queue, behind the writes the
+*   client sent before it. Called by the BLE stack event handler when a GATT
+*   client connects or disconnects. The event is only lost if the clients
+*   connect and disconnect more often than TUNER_CMD_EVENT_RESERVE allows
+*   between two frames; the next event of the session sets its bit right.
+*
+* Parameters:
+*  uint8_t session : Session index of the client
+*  bool connected  : true if the client connected, false if it disconnected
+*
+*******************************************************************************/
+void tuner_transport_connection_event(uint8_t session, bool connected)
+{
+    tuner_cmd_t *cmd = NULL;
+
+    if(tuner_cmd_queue_space() == 0u)
+    {
+        DEBUG_PRINTF("Tuner command queue full, connection event dropped\r\n");
+        return;
+    }
+
+    cmd = tuner_cmd_queue_slot(0u);
+    cmd->type = (connected == true) ? TUNER_CMD_CONNECT : TUNER_CMD_DISCONNECT;
+    cmd->session = session;
+    cmd->size = 0;
+    tuner_cmd_queue_publish(1u);
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_transport_client_connected
+********************************************************************************
+*
+* Summary:
+*   Returns true if a GATT client is connected, as of the connection events
+*   drained by the last tuner_transport_writes_apply(). Called by the main
+*   loop, which owns this state; the BLE stack event handler keeps its own.
+*
+* Return:
+*   true if a GATT client is connected
+*
+*******************************************************************************/
+bool tuner_transport_client_connected(void)
+{
+    return (tuner_clients != 0u);
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_write_enqueue
+********************************************************************************
+*
+* Summary:
+*   Puts validated batch records in the Tuner command queue, split into
+*   entries of up to TUNER_CMD_DATA_SIZE bytes. The records are published
+*   together, so the main loop never applies part of a packet. If the queue
+*   cannot take all of them and still hold TUNER_CMD_EVENT_RESERVE
+*   connection events, none is queued. A record that starts in the
+*   tuner command field is written at once instead: Cy_CapSense_RunTuner()
+*   waits for the resume command while the tuner is suspended, and the
+*   queue is not drained before it returns.
+*
+* Parameters:
+*  const uint8_t *records : Batch records
+*  uint16_t len           : Length of the records
+*
+* Return:
+*   true if the records were queued, false if the queue is full
+*
+*******************************************************************************/
+static bool tuner_write_enqueue(const uint8_t *records, uint16_t len)
+{
+    uint16_t pos = 0;
+    uint32_t count = 0;
+    uint16_t offset_address = 0;
+    uint8_t length = 0;
+    uint8_t part = 0;
+    tuner_cmd_t *cmd = NULL;
+
+    for(pos = 0; pos < len;\
+        pos += TUNER_BATCH_RECORD_HDR_SIZE + records[pos + TUNER_BATCH_SIZE_IDX])
+    {
+        offset_address =\
+        ((uint16_t)records[pos + TUNER_BATCH_OFFS_0_IDX] << MSB_SHIFT)\
+         | (uint16_t)records[pos + TUNER_BATCH_OFFS_1_IDX];
+
+        if(tuner_write_is_command(offset_address) == false)
+        {
+            count += ((uint32_t)records[pos + TUNER_BATCH_SIZE_IDX] +\
+                      TUNER_CMD_DATA_SIZE - 1u) / TUNER_CMD_DATA_SIZE;
+        }
+    }
+
+    if((count + TUNER_CMD_EVENT_RESERVE) > tuner_cmd_queue_space())
+    {
+        DEBUG_PRINTF("Tuner command queue full, %lu writes dropped\r\n",\
+                     (unsigned long)count);
+        return false;
+    }
+
+    count = 0;
+    pos = 0;
+    while(pos < len)
+    {
+        offset_address =\
+        ((uint16_t)records[pos + TUNER_BATCH_OFFS_0_IDX] << MSB_SHIFT)\
+         | (uint16_t)records[pos + TUNER_BATCH_OFFS_1_IDX];
+        length = records[pos + TUNER_BATCH_SIZE_IDX];
+        pos += TUNER_BATCH_RECORD_HDR_SIZE;
+
+        if(tuner_write_is_command(offset_address) == true)
+        {
+            memcpy(((uint8_t *)&cy_capsense_tuner) + offset_address,\
+                   &records[pos], length);
+            pos += length;
+            continue;
+        }
+
+        while(length > 0u)
+        {
+            part = (length > TUNER_CMD_DATA_SIZE) ? TUNER_CMD_DATA_SIZE : length;
+
+            cmd = tuner_cmd_queue_slot(count);
+            cmd->type = TUNER_CMD_WRITE;
+            cmd->offset = offset_address;
+            cmd->size = part;
+            memcpy(cmd->data, &records[pos], part);
+            count++;
+
+            offset_address += part;
+            pos += part;
+            length -= part;
+        }
+    }
+
+    tuner_cmd_queue_publish(count);
+
+    return true;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_write_is_command
+********************************************************************************
+*
+* Summary:
+*   Checks if a Tuner command write starts in the tuner command field.
+*
+* Parameters:
+*  uint16_t offset : Offset of the write in the CapSense structure
+*
+* Return:
+*   true if the write has to be applied on arrival
+*
+*******************************************************************************/
+static bool tuner_write_is_command(uint16_t offset)
+{
+    uint16_t field_start = 0;
+    uint16_t field_size = 0;
+
+    return ((tuner_layout_class(offset, &field_start, &field_size) &\
+             TUNER_LAYOUT_COMMAND) != 0u);
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_write_allowed
+********************************************************************************
+*
+* Summary:
+*   Checks a Tuner command write. With TUNER_WRITE_CHECK_ENABLE, the write
+*   has to lie inside a single writable field of the layout map; otherwise
+*   it only has to lie inside the CapSense structure.
+*
+* Parameters:
+*  uint16_t offset : Offset of the write in the CapSense structure
+*  uint16_t len    : Number of bytes written
+*
+* Return:
+*   true if the write may be applied
+*
+*******************************************************************************/
+static bool tuner_write_allowed(uint16_t offset, uint16_t len)
+{
+    bool allowed = false;
+
+#if (TUNER_WRITE_CHECK_ENABLE == ENABLE)
+    allowed = tuner_layout_write_allowed(offset, len);
+#else
+    allowed = (((uint32_t)offset + len) <= sizeof(cy_capsense_tuner));
+#endif
+
+    if(allowed == false)
+    {
+        DEBUG_PRINTF("Tuner write refused, offset %u length %u\r\n",\
+                     offset, len);
+    }
+
+    return allowed;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_static_map_update
+********************************************************************************
+*
+* Summary:
+*   Finds the blocks of the streamed image that hold static fields only.
+*   Called before the first frame of an image; the next frame compares
+*   every block.
+*
+*******************************************************************************/
+static void tuner_static_map_update(void)
+{
+    for(uint16_t block = 0; block < tx_block_count; block++)
+    {
+        tx_block_static[block] = tuner_image_is_static(block * TUNER_BLOCK_SIZE,\
+                                                       tuner_block_length(block));
+    }
+
+    tx_static_map_valid = true;
+    tx_static_check = true;
+}
+
+
+/*******************************************************************************
+* Function Name: tuner_image_is_static
+********************************************************************************
+*
+* Summary:
+*   Returns true if a range of the streamed image maps to static fields of
+*   the CapSense structure only. The summary image changes with every scan.
+*
+* Parameters:
+*  uint16_t offset : Offset in the streamed image
+*  uint16_t len    : Length of the range
+*
+*******************************************************************************/
+static bool tuner_image_is_static(uint16_t offset, uint16_t len)
+{
+    uint16_t part_len = 0;
+
+    if(tx_summary == true)
+    {
+        return false;
+    }
+
+    if(tuner_region_count == 0u)
+    {
+        return tuner_layout_is_static(offset, len);
+    }
+
+    for(uint8_t i = 0; (i < tuner_region_count) && (len > 0u); i++)
+    {
+        if(offset >= tuner_regions[i].length)
+        {
+            offset -= tuner_regions[i].length;
+            continue;
+        }
+
+        part_len = tuner_regions[i].length - offset;
+        if(part_len > len)
+        {
+            part_len = len;
+        }
+
+        if(tuner_layout_is_static(tuner_regions[i].offset + offset,\
+                                  part_len) == false)
+        {
+            return false;
+        }
+
+        len -= part_len;
+        offset = 0;
+    }
+
+    return true;
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,95 @@
+/******************************************************************************
+* File Name: tuner_transport.h
+*
+* Description: This file is public interface of tuner_transport.c
+*
+* Related Document: Readme.md
+*
+*******************************************************************************
+* Copyright 2020-2021, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/******************************************************************************
+ * Include guard
+ *****************************************************************************/
+#ifndef TUNER_TRANSPORT_H_
+#define TUNER_TRANSPORT_H_
+
+/******************************************************************************
+ * Include header files
+ *****************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+/* Link defaults before the MTU exchange and the data length update */
+#define DEFAULT_ATT_MTU              (23u)
+#define DEFAULT_LL_TX_OCTETS         (27u)
+
+/* Length of the tuner bridge initialization packet */
+#define TUNER_BRIDGE_INIT_NTF_SIZE   (11u)
+
+/* Number of GATT clients the frames can be streamed to at the same time */
+#define TUNER_MAX_SESSIONS           (2u)
+
+
+/******************************************************************************
+ * Function Prototypes
+ *****************************************************************************/
+void tuner_transport_subscribe(uint8_t session);
+void tuner_transport_unsubscribe(uint8_t session);
+void tuner_transport_set_link(uint8_t session, uint16_t mtu,
+                              uint16_t ll_tx_octets);
+bool tuner_transport_init_pending(uint8_t session);
+uint16_t tuner_transport_build_init(uint8_t session, uint8_t *buffer);
+void tuner_transport_init_sent(uint8_t session);
+bool tuner_transport_frame_start(void);
+void tuner_transport_frame_abort(uint8_t session);
+bool tuner_transport_frame_done(uint8_t session);
+bool tuner_transport_frame_in_flight(void);
+uint16_t tuner_transport_next_chunk(uint8_t session, const uint8_t **chunk);
+void tuner_transport_chunk_sent(uint8_t session);
+bool tuner_transport_regions_write(const uint8_t *data, uint16_t len);
+void tuner_transport_command_write(uint8_t session, const uint8_t *data,
+                                   uint16_t len);
+bool tuner_transport_writes_apply(bool *widget_reinit);
+void tuner_transport_connection_event(uint8_t session, bool connected);
+bool tuner_transport_client_connected(void);
+uint16_t tuner_transport_chunk_size(uint8_t session);
+uint16_t tuner_transport_image_size(void);
+
+
+#endif /* TUNER_TRANSPORT_H_ */